@@ -4,8 +4,26 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// AUX capture: ADC continuous mode, 48 kHz mono
+// A capture task woken by each DMA conversion frame parses the results into a
+// ring and reports them to the frame scheduler (FRAME_CLOCK_ADC), so the audio
+// task is only woken once a whole frame is readable.
+
+typedef struct {
+    uint32_t samples;          // Samples delivered into the ring
+    uint32_t frames;           // Whole frames handed to the audio task
+    uint32_t short_reads;      // Reads refused because less than a frame was buffered
+    uint32_t overruns;         // Blocks dropped because the ring was full (reader behind)
+    uint32_t dropped_samples;  // Samples lost to those overruns
+    uint32_t driver_overruns;  // ADC driver pool overflows (capture task behind)
+} adc_audio_stats_t;
+
 esp_err_t adc_audio_init(void);
 esp_err_t adc_audio_deinit(void);
-esp_err_t adc_audio_start(void);
-esp_err_t adc_audio_stop(void);
-esp_err_t adc_audio_read_stereo(int16_t *stereo_buffer, size_t num_samples, size_t *samples_read);
+esp_err_t adc_audio_start(void);   // Route samples to the ring (flushes stale ones)
+esp_err_t adc_audio_stop(void);    // Discard samples; the ADC keeps converting
+
+// Exactly num_samples 16-bit mono samples or nothing: ESP_ERR_NOT_FOUND if fewer are buffered
+esp_err_t adc_audio_read_frame(int16_t *mono_buffer, size_t num_samples);
+
+void adc_audio_get_stats(adc_audio_stats_t *stats);
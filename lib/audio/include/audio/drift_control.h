@@ -0,0 +1,22 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Clock drift correction (elastic buffer + ASRC) between the jitter buffer and I2S
+// A fixed-point polyphase resampler consumes input slightly faster or slower than
+// the local I2S clock, steered by a PI loop on the buffer fill error.
+
+// Supplies one AUDIO_FRAME_SAMPLES frame of mono S24 samples (in int32).
+// Any non-ESP_OK return means the stream is not running; the resampler resets.
+typedef esp_err_t (*drift_control_source_t)(int32_t *samples, void *ctx);
+
+esp_err_t drift_control_init(drift_control_source_t source, void *ctx);
+void drift_control_reset(void);
+
+// Produce num_samples resampled output samples (mono S24 in int32)
+// fill_error_samples = samples buffered upstream minus the target (positive = too full)
+esp_err_t drift_control_process(int32_t *out, size_t num_samples, int32_t fill_error_samples);
+
+float drift_control_get_ppm_error(void);  // Current rate correction (TX clock vs RX clock)
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Cascaded fixed-point biquads for block processing (one 240-sample frame per call)
+// Coefficients are designed in float when a stage is added or retuned (RBJ
+// cookbook, bilinear first-order sections) and run as Q31 values scaled by 1/16
+// (Q5.27: boosting shelves need |b1| up to twice their linear gain, so up to
+// +18 dB fits) with a 64-bit accumulator. Direct form I with error feedback: the bits dropped when
+// narrowing the accumulator are added back on the next sample, so low-corner
+// filters (DC blocker, 20 Hz HPF) don't leave a truncation offset or limit cycles. Samples are int32 holding up to 24 bits
+// (i24 working format); processing is in place.
+// A chain is not locked: add/set/reset from the task that calls process.
+
+typedef enum {
+    DSP_FILTER_DC_BLOCK,    // 1st order, freq = corner (~5-20 Hz), unity at Nyquist
+    DSP_FILTER_LOWPASS1,    // 1st order
+    DSP_FILTER_HIGHPASS1,   // 1st order
+    DSP_FILTER_LOWPASS,     // 2nd order, q = 0.7071 for Butterworth
+    DSP_FILTER_HIGHPASS,    // 2nd order
+    DSP_FILTER_PEAKING,     // EQ bell: gain_db at freq, bandwidth from q
+    DSP_FILTER_LOW_SHELF,   // gain_db below freq, q = 0.7071 for no overshoot
+    DSP_FILTER_HIGH_SHELF,  // gain_db above freq
+} dsp_filter_type_t;
+
+// Linkwitz-Riley 4th-order crossover leg: add the same Butterworth LOWPASS or
+// HIGHPASS (q DSP_Q_BUTTERWORTH) twice
+#define DSP_Q_BUTTERWORTH  0.70710678f
+
+typedef struct dsp_chain_t dsp_chain_t;
+
+dsp_chain_t* dsp_chain_create(size_t max_stages);
+void dsp_chain_destroy(dsp_chain_t *chain);
+
+// Append a stage; q and gain_db are ignored by types that don't use them.
+// ESP_ERR_INVALID_ARG for freq outside (0, Nyquist) or a design whose coefficients
+// don't fit Q5.27 (|c| >= 16, e.g. a shelf above +18 dB), ESP_ERR_NO_MEM when full.
+esp_err_t dsp_chain_add(dsp_chain_t *chain, dsp_filter_type_t type, float freq_hz, float q, float gain_db);
+// Retune stage index in place; its state is kept so there is no click
+esp_err_t dsp_chain_set(dsp_chain_t *chain, size_t index, dsp_filter_type_t type, float freq_hz, float q, float gain_db);
+size_t dsp_chain_stages(const dsp_chain_t *chain);
+void dsp_chain_reset(dsp_chain_t *chain);  // Clear filter state (stream restart)
+
+// Run every stage over samples in place; an empty chain is a no-op
+void dsp_chain_process(dsp_chain_t *chain, int32_t *samples, size_t num_samples);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "config/build.h"
+
+// Statically allocated pool of refcounted audio frame buffers
+// A frame is received once (e.g. straight from esp_mesh_recv) and handed on by
+// reference: every holder takes a ref and drops it when done, and the buffer
+// returns to the pool with the last unref. Nothing is ever malloc'd; when the
+// pool is empty frame_pool_alloc returns NULL and counts an exhaustion.
+// With FEC enabled the decoder still copies each received payload into its own
+// window (see network/fec.h), and frames it rebuilds are copied into new pool frames.
+
+typedef struct audio_frame_t {
+    uint8_t *data;             // First valid byte (buf + headroom, moves as headers are stripped/added)
+    size_t len;                // Valid bytes from data
+    _Atomic uint32_t refs;     // Owned by frame_pool - use frame_pool_ref/unref
+    uint8_t buf[FRAME_POOL_BUF_BYTES] __attribute__((aligned(4)));  // Payload after a 16-byte header stays word-aligned
+} audio_frame_t;
+
+typedef struct {
+    uint32_t total;            // Frames in the pool
+    uint32_t in_use;           // Frames currently referenced
+    uint32_t high_water;       // Most frames ever in use at once
+    uint32_t exhausted;        // Allocations refused because the pool was empty
+    uint32_t bad_unrefs;       // Unrefs of a frame already back in the pool (a holder's bug)
+} frame_pool_stats_t;
+
+// Idempotent; every user calls it before its first alloc
+esp_err_t frame_pool_init(void);
+
+// One reference held by the caller; data = buf + headroom leaves room to prepend
+// headers in place. NULL if the pool is empty or headroom doesn't fit.
+audio_frame_t* frame_pool_alloc(size_t headroom);
+void frame_pool_ref(audio_frame_t *frame);
+void frame_pool_unref(audio_frame_t *frame);  // NULL is ignored, as is (with an error) a free frame
+
+void frame_pool_get_stats(frame_pool_stats_t *stats);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Wakes the audio task once per 5ms frame, paced by the clock of whichever
+// source is feeding it: the ADC DMA (samples reported from on_conv_done), USB
+// SOFs, or a high-resolution periodic esp_timer whose deadlines advance by a
+// fixed period (no accumulated drift) when there is no hardware clock.
+// Sources report samples; each AUDIO_FRAME_SAMPLES accumulated makes one frame due.
+
+typedef enum {
+    FRAME_CLOCK_TIMER = 0,   // esp_timer, AUDIO_FRAME_MS period (tone generator)
+    FRAME_CLOCK_ADC,         // ADC continuous conversions
+    FRAME_CLOCK_USB,         // USB SOF count (1 ms of audio per SOF at full speed)
+} frame_clock_t;
+
+typedef struct {
+    uint32_t frames;         // Frames made due by the active clock
+    uint32_t late;           // Waits that returned more than one due frame (task fell behind)
+    uint32_t timeouts;       // Waits that expired with no frame due (clock stalled)
+} frame_scheduler_stats_t;
+
+// task is the audio task to wake (task notifications, default index)
+esp_err_t frame_scheduler_init(TaskHandle_t task, frame_clock_t clock);
+esp_err_t frame_scheduler_set_clock(frame_clock_t clock);
+frame_clock_t frame_scheduler_get_clock(void);
+
+// Clock hooks: samples produced by a source. Ignored unless it is the active clock.
+void frame_scheduler_samples_from_isr(frame_clock_t clock, uint32_t samples, BaseType_t *woken);
+void frame_scheduler_samples(frame_clock_t clock, uint32_t samples);
+
+// Blocks until a frame is due and consumes it; returns how many were due
+// (>1: the task is behind and the next call returns at once, 0: timeout)
+uint32_t frame_scheduler_wait(TickType_t timeout);
+
+void frame_scheduler_get_stats(frame_scheduler_stats_t *stats);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Fixed-point gain/mute stage for playout paths (local monitor, RX, mixer)
+// Gain is a Q2.30 multiplier (Q31 halved), so the
+// range is mute .. +6 dB. Gain and mute changes never jump: each process call
+// ramps linearly from the current gain to the target across that buffer (one
+// 5 ms frame), which removes zipper noise from knob and USB volume steps. At a
+// settled gain the call is a plain multiply loop, unity is a no-op and a
+// settled mute is a memset. With soft clip enabled, samples past -2.5 dBFS are
+// bent smoothly toward full scale instead of being hard-limited there.
+// Setters may be called from any task (USB callbacks, control); process from one.
+
+#define GAIN_STAGE_MAX_DB       6.0f
+#define GAIN_STAGE_UAC_RANGE_DB 60.0f  // USB volume 1% = -60 dB .. 100% = 0 dB, 0% mutes
+
+typedef struct gain_stage_t gain_stage_t;
+
+gain_stage_t* gain_stage_create(void);   // Unity gain, unmuted, hard clip
+void gain_stage_destroy(gain_stage_t *stage);
+
+void gain_stage_set_gain(gain_stage_t *stage, float linear);   // Clamped to [0, +6 dB]
+void gain_stage_set_gain_db(gain_stage_t *stage, float db);
+void gain_stage_set_mute(gain_stage_t *stage, bool mute);
+void gain_stage_set_soft_clip(gain_stage_t *stage, bool enable);
+float gain_stage_get_gain_db(const gain_stage_t *stage);        // Target gain, -INFINITY when 0
+
+// In place. s16: interleaved, num_frames x channels samples, one ramp per
+// frame so all channels move together. i24: mono int32 working format.
+void gain_stage_process_s16(gain_stage_t *stage, int16_t *samples, size_t num_frames, size_t channels);
+void gain_stage_process_i24(gain_stage_t *stage, int32_t *samples, size_t num_samples);
+
+// Drop-in uac_set_volume_cb_t / uac_set_mute_cb_t: pass the stage as cb_ctx
+void gain_stage_uac_set_volume(uint32_t volume, void *cb_ctx);
+void gain_stage_uac_set_mute(uint32_t mute, void *cb_ctx);
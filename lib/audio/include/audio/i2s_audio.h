@@ -3,7 +3,30 @@
 #include <esp_err.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Output slot width is fixed at build time by I2S_OUTPUT_24BIT (config/build.h);
+// every writer formats for it, so 16-bit sources keep working in 24-bit mode.
+// Writers never block: they queue whole frames for the DMA-driven output engine
+// and return ESP_ERR_NO_MEM (counted as an overflow) when the queue is full.
+
+typedef struct {
+    uint32_t underruns;       // DMA buffers that found the queue short (padded with silence)
+    uint32_t silence_frames;  // Frames of silence inserted by those underruns
+    uint32_t overflows;       // Writes dropped because the queue was full
+    uint32_t queued_frames;   // Frames waiting for DMA - with a steady producer this tracks clock drift
+    uint32_t dma_frames;      // Frames already in DMA buffers ahead of the one playing (fixed)
+} i2s_audio_stats_t;
 
 esp_err_t i2s_audio_init(void);
-esp_err_t i2s_audio_write_samples(const int16_t *samples, size_t num_samples);
+esp_err_t i2s_audio_write_samples(const int16_t *samples, size_t num_samples);  // Interleaved stereo
 esp_err_t i2s_audio_write_mono_as_stereo(const int16_t *mono_samples, size_t num_mono_samples);
+// Sign-extended 24-bit mono (DSP working format) to both channels at full resolution
+esp_err_t i2s_audio_write_i24_mono(const int32_t *mono_samples, size_t num_mono_samples);
+
+// Frames that can be written without overflowing the playout queue
+size_t i2s_audio_get_free_frames(void);
+// Task to notify (xTaskNotifyGive) whenever a DMA buffer has been refilled
+void i2s_audio_set_refill_task(TaskHandle_t task);
+void i2s_audio_get_stats(i2s_audio_stats_t *stats);
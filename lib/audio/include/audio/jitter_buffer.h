@@ -0,0 +1,73 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "audio/frame_pool.h"
+
+// Sequence-indexed jitter buffer for fixed-size audio frames
+// Slots hold references to pool frames rather than copies, so a received buffer
+// is played out in place. Frames are slotted by seq (O(1) insert), reordered on playout, and missing
+// frames are reported as explicit gaps so the caller can conceal them.
+// Optionally the playout depth adapts to the RFC 3550 interarrival jitter
+// estimated from sender timestamps and local arrival times.
+
+typedef struct jitter_buffer_t jitter_buffer_t;
+
+typedef struct {
+    uint32_t received;    // Frames accepted into a slot
+    uint32_t played;      // Frames returned by jitter_buffer_get
+    uint32_t missing;     // Gaps reported to playout (lost or not yet arrived)
+    uint32_t late;        // Frames discarded because their playout slot had passed
+    uint32_t duplicates;  // Frames discarded because the slot already held that seq
+    uint32_t overflows;   // Frames skipped because the buffer was full
+    uint32_t underruns;   // Playout requests with nothing buffered
+    uint32_t drops;       // Frames dropped to shrink depth toward target
+    uint32_t holds;       // Playout requests held on a missing frame to grow depth
+    uint32_t depth;       // Frames currently buffered (head to newest)
+    uint32_t target_depth; // Current playout depth target (frames)
+    uint32_t jitter_us;   // Interarrival jitter estimate
+} jitter_buffer_stats_t;
+
+// capacity_frames is rounded up to a power of two; prefill_frames is the
+// depth that must be buffered before playout starts (the initial target)
+jitter_buffer_t* jitter_buffer_create(size_t capacity_frames, size_t frame_bytes, size_t prefill_frames);
+void jitter_buffer_destroy(jitter_buffer_t *jb);
+void jitter_buffer_reset(jitter_buffer_t *jb);
+
+// Let the target depth follow measured jitter within [min_frames, max_frames]
+// frame_us is the frame duration used to convert jitter into frames
+esp_err_t jitter_buffer_set_adaptive(jitter_buffer_t *jb, size_t min_frames, size_t max_frames, uint32_t frame_us);
+
+// Adaptive shrink drops the head frame once the smoothed depth stays margin_frames
+// over the target (default 2). Every drop is a 5 ms discontinuity: when a drift
+// loop (ASRC) already steers depth to the target, raise the margin so drops are
+// only a last resort, or pass 0 to never drop.
+esp_err_t jitter_buffer_set_drop_margin(jitter_buffer_t *jb, size_t margin_frames);
+
+// timestamp is the sender's ms timestamp, arrival_us the local receive time
+// The buffer takes its own reference to frame (frame->len must be frame_bytes)
+// Returns ESP_OK when stored, ESP_ERR_TIMEOUT if late, ESP_ERR_INVALID_STATE if duplicate
+esp_err_t jitter_buffer_put(jitter_buffer_t *jb, uint16_t seq, uint32_t timestamp, int64_t arrival_us,
+                            audio_frame_t *frame);
+
+// One frame of a batch put (the jitter_buffer_put arguments)
+typedef struct {
+    audio_frame_t *frame;
+    uint16_t seq;
+    uint32_t timestamp;
+    int64_t arrival_us;
+} jitter_buffer_entry_t;
+
+// Put a receive batch under one lock; results (optional, count entries) gets each
+// frame's jitter_buffer_put return. Returns the number of frames stored.
+size_t jitter_buffer_put_batch(jitter_buffer_t *jb, const jitter_buffer_entry_t *entries, size_t count,
+                               esp_err_t *results);
+
+// Returns ESP_OK with the next frame in seq order (the buffer's reference passes to
+// the caller, who must frame_pool_unref it), ESP_ERR_NOT_FOUND for a gap (caller
+// conceals), or ESP_ERR_INVALID_STATE while prefilling
+esp_err_t jitter_buffer_get(jitter_buffer_t *jb, audio_frame_t **frame);
+
+size_t jitter_buffer_depth(jitter_buffer_t *jb);  // Frames from playout head to newest
+void jitter_buffer_get_stats(jitter_buffer_t *jb, jitter_buffer_stats_t *stats);
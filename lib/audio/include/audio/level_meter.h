@@ -0,0 +1,39 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Per-frame level meter and signal gate for 16-bit input
+// One integer pass per frame collects sum, sum of squares, min and max; DC, AC
+// RMS and AC peak fall out of those. The gate opens when the RMS reaches
+// on_rms, and only closes after hangover_frames consecutive frames below
+// off_rms, so speech pauses and a signal hovering at the threshold don't
+// toggle it every frame.
+
+typedef struct {
+    int32_t on_rms;              // Open at or above this AC RMS
+    int32_t off_rms;             // Count toward closing below this (<= on_rms)
+    uint32_t hangover_frames;    // Quiet frames before the gate closes
+} level_meter_config_t;
+
+typedef struct {
+    int32_t dc;                  // Frame mean
+    int32_t rms;                 // AC RMS (DC removed)
+    int32_t peak;                // Largest |sample - dc|
+    int32_t rms_dbfs;            // 20*log10(rms / 32768), -96 for silence
+    bool active;                 // Gate state after this frame
+    uint32_t gate_changes;       // Open/close transitions since create/reset
+} level_meter_reading_t;
+
+typedef struct level_meter_t level_meter_t;
+
+level_meter_t* level_meter_create(const level_meter_config_t *config);
+void level_meter_destroy(level_meter_t *meter);
+void level_meter_reset(level_meter_t *meter);  // Gate closed, counters cleared
+
+// Measure one frame and update the gate; returns the gate state
+bool level_meter_process(level_meter_t *meter, const int16_t *samples, size_t num_samples);
+
+void level_meter_get_reading(const level_meter_t *meter, level_meter_reading_t *reading);
@@ -3,6 +3,11 @@
 #include <esp_err.h>
 #include <stdint.h>
 
-esp_err_t opus_codec_init(void);
+// Low-delay Opus (CELT) codec for 5ms mono frames
+// opus_data must hold OPUS_MAX_FRAME_BYTES, pcm_data must hold AUDIO_FRAME_SAMPLES
+// Each side is created on the nodes that use it: the encoder on TX/COMBO, the
+// decoder on RX. Encode/decode return ESP_ERR_INVALID_STATE before their init.
+esp_err_t opus_codec_encoder_init(void);
+esp_err_t opus_codec_decoder_init(void);
 esp_err_t opus_codec_encode(const int16_t *pcm_data, int pcm_samples, uint8_t *opus_data, int *opus_len);
 esp_err_t opus_codec_decode(const uint8_t *opus_data, int opus_len, int16_t *pcm_data, int *pcm_samples);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// PCM sample format conversions shared by TX, RX and COMBO
+// Formats:
+//   s16  int16_t
+//   s24  24-bit little-endian packed, 3 bytes per sample (network payload)
+//   s32  int32_t with the 24-bit sample left-justified (I2S 32-bit slot)
+//   i24  int32_t holding the 24-bit sample sign-extended (DSP working format)
+//   f32  float, full scale [-1.0, 1.0); conversions to integers saturate
+// All functions take (in, samples, out) where samples counts per-channel frames
+// for the mono/stereo variants. Narrowing conversions truncate (drop LSBs).
+// On ESP32-S3 the packed-24 kernels move 4 samples per 3 aligned 32-bit words;
+// the scalar versions are the bit-exact reference (define PCM_CONVERT_SCALAR to force them).
+
+void pcm_s16_to_s24(const int16_t *in, size_t samples, uint8_t *out);
+void pcm_s24_to_s16(const uint8_t *in, size_t samples, int16_t *out);
+void pcm_s24_to_i24(const uint8_t *in, size_t samples, int32_t *out);
+void pcm_i24_to_s24(const int32_t *in, size_t samples, uint8_t *out);
+void pcm_s24_to_s32(const uint8_t *in, size_t samples, int32_t *out);
+void pcm_s32_to_s24(const int32_t *in, size_t samples, uint8_t *out);
+
+void pcm_s16_to_f32(const int16_t *in, size_t samples, float *out);
+void pcm_f32_to_s16(const float *in, size_t samples, int16_t *out);
+void pcm_i24_to_f32(const int32_t *in, size_t samples, float *out);
+void pcm_f32_to_i24(const float *in, size_t samples, int32_t *out);
+
+// Channel mixing: downmix averages L and R, upmix duplicates
+void pcm_s16_stereo_to_mono(const int16_t *in_lr, size_t frames, int16_t *out);
+void pcm_s16_mono_to_stereo(const int16_t *in, size_t frames, int16_t *out_lr);
+
+// Fused capture/playout paths
+void pcm_s16_stereo_to_s24_mono(const int16_t *in_lr, size_t frames, uint8_t *out);
+void pcm_i24_mono_to_s16_stereo(const int32_t *in, size_t frames, int16_t *out_lr);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Packet loss concealment for AUDIO_FRAME_SAMPLES mono S24 frames (in int32)
+// Lost frames are synthesized by repeating the best-matching pitch period of
+// recent history, faded out over consecutive losses, and cross-faded back into
+// real audio when frames resume.
+
+typedef struct {
+    uint32_t concealed;      // Frames synthesized
+    uint32_t resumed;        // Concealment runs ended by a real frame
+    uint32_t max_conceal_us; // Worst-case CPU time of one concealed frame
+} plc_stats_t;
+
+esp_err_t plc_init(void);
+void plc_reset(void);
+
+// Real frame: cross-fades in place after a concealment run, then records history
+void plc_good_frame(int32_t *samples);
+
+// Lost frame: fills samples with the concealment signal
+void plc_conceal(int32_t *samples);
+
+void plc_get_stats(plc_stats_t *stats);
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Fixed-ratio polyphase sample-rate converter for 16-bit interleaved PCM
+// (USB host streams at 44.1/32/96 kHz into the 48 kHz pipeline). The ratio is
+// reduced to L/M (44.1k -> 48k = 160/147) and a Kaiser-windowed sinc prototype
+// is split into L phases of T taps, designed once at create (Q15 table; each
+// phase normalized to unity DC gain). One output costs T multiply-adds per
+// channel. Passband ends at min(20 kHz, 0.45 x the lower rate) with under
+// 0.01 dB ripple; images and aliases that would land below that edge are about
+// 80 dB down (the Q15 coefficient table sets that floor).
+// Drift between host and device clocks is not handled here (see drift_control).
+
+#define RESAMPLER_MAX_PHASES  256
+
+typedef struct resampler_t resampler_t;
+
+// NULL if the reduced ratio needs more than RESAMPLER_MAX_PHASES phases.
+// in_rate == out_rate gives a pass-through converter.
+resampler_t* resampler_create(uint32_t in_rate, uint32_t out_rate, size_t channels, size_t max_out_frames);
+void resampler_destroy(resampler_t *rs);
+void resampler_reset(resampler_t *rs);  // Clear history and phase (stream restart)
+
+uint32_t resampler_in_rate(const resampler_t *rs);
+size_t resampler_taps(const resampler_t *rs);   // Per phase (per output, per channel)
+
+// Input frames the next process call consumes to produce out_frames
+// (for 44.1k -> 48k and a 240-frame output, 220 or 221)
+size_t resampler_input_needed(const resampler_t *rs, size_t out_frames);
+
+// Produce out_frames (<= max_out_frames) from exactly
+// resampler_input_needed(out_frames) input frames. Returns out_frames, or 0 if
+// in_frames is not that count.
+size_t resampler_process(resampler_t *rs, const int16_t *in, size_t in_frames,
+                         int16_t *out, size_t out_frames);
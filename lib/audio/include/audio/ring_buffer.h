@@ -4,10 +4,27 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// Lock-free single-producer/single-consumer byte ring (C11 atomics)
+// Exactly one task/ISR may write and exactly one may read; neither side ever
+// blocks or takes a lock. When the capacity is a multiple of the item size and
+// items are written whole, reserve/peek always return whole items in place.
+
 typedef struct ring_buffer_t ring_buffer_t;
 
 ring_buffer_t* ring_buffer_create(size_t size);
 void ring_buffer_destroy(ring_buffer_t *rb);
+
+// Copying API: all-or-nothing, ESP_ERR_NO_MEM if full / ESP_ERR_NOT_FOUND if short
 esp_err_t ring_buffer_write(ring_buffer_t *rb, const uint8_t *data, size_t len);
 esp_err_t ring_buffer_read(ring_buffer_t *rb, uint8_t *data, size_t len);
-size_t ring_buffer_available(ring_buffer_t *rb);
+size_t ring_buffer_available(ring_buffer_t *rb);  // Bytes readable
+size_t ring_buffer_free(ring_buffer_t *rb);       // Bytes writable
+
+// Zero-copy producer: contiguous writable region of up to len bytes (may be
+// shorter at the wrap point, NULL if full), then publish what was written
+uint8_t* ring_buffer_reserve(ring_buffer_t *rb, size_t len, size_t *granted);
+void ring_buffer_commit(ring_buffer_t *rb, size_t len);
+
+// Zero-copy consumer: contiguous readable region (NULL if empty), then free it
+const uint8_t* ring_buffer_peek(ring_buffer_t *rb, size_t *len);
+void ring_buffer_release(ring_buffer_t *rb, size_t len);
@@ -4,6 +4,36 @@
 #include <stdint.h>
 #include <stddef.h>
 
-esp_err_t tone_gen_init(uint32_t freq_hz);
+// Test-tone source: 32-bit phase-accumulator NCO over a 1024-point sine table
+// with linear interpolation (under 1.5 LSB from the exact sine after output
+// rounding, ~87 dB SNR), no per-sample libm calls. Frequency changes only swap
+// the phase increment, so knob moves are click-free.
+// Besides the sine there are measurement signals:
+//   multitone  up to TONE_GEN_MAX_TONES sines at once, Schroeder phases (low crest factor)
+//   sweep      exponential (log) sweep start -> end over a period, then repeats
+//   impulse    one full-scale sample every period, silence in between
+
+#define TONE_GEN_MAX_TONES  8
+
+typedef enum {
+    TONE_GEN_SINE = 0,
+    TONE_GEN_MULTITONE,
+    TONE_GEN_SWEEP,
+    TONE_GEN_IMPULSE,
+} tone_gen_mode_t;
+
+esp_err_t tone_gen_init(uint32_t freq_hz);   // Sine mode at freq_hz
+
+// Sine frequency (phase-continuous); takes effect in sine mode
 void tone_gen_set_frequency(uint32_t freq_hz);
+
+// Configure and switch to a measurement mode
+esp_err_t tone_gen_set_multitone(const uint32_t *freqs_hz, size_t count);
+esp_err_t tone_gen_set_sweep(uint32_t start_hz, uint32_t end_hz, uint32_t period_ms);
+esp_err_t tone_gen_set_impulse(uint32_t period_ms);
+
+// Switch between already-configured modes (sine is always configured)
+esp_err_t tone_gen_set_mode(tone_gen_mode_t mode);
+tone_gen_mode_t tone_gen_get_mode(void);
+
 void tone_gen_fill_buffer(int16_t *buffer, size_t num_samples);
@@ -5,6 +5,31 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+// USB audio input: asynchronous UAC2 speaker sink on usb_device_uac (TX/COMBO)
+// The host streams 16-bit stereo; the UAC output callback lands each packet in
+// an SPSC ring (no lock, never blocks). The audio task reads 5 ms frames paced
+// by the device clock, and after each read the ring fill drives a PI loop whose
+// output is the explicit feedback value (samples per USB frame, 16.16): the
+// host follows the device clock instead of drifting against it. The loop's
+// integrator is the host/device clock-rate estimate. Hosts running at another
+// rate (CONFIG_UAC_SAMPLE_RATE) go through the polyphase resampler, and host
+// volume/mute requests drive a gain stage on the stream.
+
+typedef struct {
+    uint32_t packets;          // Output callbacks (host packets)
+    uint32_t overruns;         // Packets dropped because the ring was full (host ahead)
+    uint32_t underruns;        // Reads refused because less than a frame was buffered
+    uint32_t fill_frames;      // Host-rate frames buffered after the last read
+    uint32_t feedback;         // Last feedback value, 16.16 samples per USB frame
+    uint32_t fb_errors;        // Feedback updates the stack refused (no feedback endpoint open)
+    int32_t rate_ppm;          // Device clock vs host clock estimate (+ = device faster)
+} usb_audio_stats_t;
+
 esp_err_t usb_audio_init(void);
+
+// One whole frame or nothing: frames_read is frame_count, or 0 while the ring
+// is priming or has run short (frames are zeroed then)
 esp_err_t usb_audio_read_frames(int16_t *frames, size_t frame_count, size_t *frames_read);
-bool usb_audio_is_active(void);
+bool usb_audio_is_active(void);    // Host is streaming (packets within the last 50 ms)
+
+void usb_audio_get_stats(usb_audio_stats_t *stats);
@@ -5,28 +5,127 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <string.h>
+#include <stdbool.h>
 #include "config/pins.h"
 #include "config/build.h"
+#include "audio/frame_scheduler.h"
+#include "audio/ring_buffer.h"
+#include "audio/dsp_chain.h"
 
 static const char *TAG = "adc_audio";
 
-// DMA buffer size - enough for multiple frames
-#define ADC_READ_LEN           1024
-#define ADC_CONV_FRAME_SIZE    1024
+// One DMA conversion frame = one 5ms audio frame of TYPE2 results, so every
+// conv-done event carries exactly AUDIO_FRAME_SAMPLES samples
+#define ADC_CONV_FRAME_SIZE    (AUDIO_FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES)
+#define ADC_DRIVER_FRAMES      4    // Driver pool: conversion frames buffered before it overflows
+#define ADC_RING_FRAMES        4    // Parsed audio frames buffered for the audio task
+
+#define ADC_CAPTURE_TASK_PRIO  6    // Above the audio task so a frame is parsed before it is due
+#define ADC_CAPTURE_STACK      3072
 
 // ADC continuous handle
 static adc_continuous_handle_t adc_handle = NULL;
-
-// Static buffers to avoid stack overflow
-static int16_t mono_samples[ADC_READ_LEN / 4];
+static TaskHandle_t capture_task = NULL;
+static ring_buffer_t *sample_ring = NULL;      // int16 mono samples, capture task -> audio task
+static volatile bool capturing = false;        // AUX selected: samples go to the ring
+static volatile bool flush_pending = false;    // Reader drops stale samples on its next read
+static adc_audio_stats_t adc_stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Capture-task buffers (static, off the audio task's stack)
+static uint8_t adc_raw_data[ADC_CONV_FRAME_SIZE] __attribute__((aligned(4)));
+static int32_t capture_i24[AUDIO_FRAME_SAMPLES];   // Parsed, filtered in place
+static int16_t capture_samples[AUDIO_FRAME_SAMPLES];
+static dsp_chain_t *capture_chain = NULL;
 
 // ADC mid-point with preamp biasing circuit (1.65V bias, ~2048 with DB_11 attenuation)
 // Measure actual value with no input signal and adjust if needed
 #define ADC_MID_CODE           2048
 
-// Simple low-pass filter to reduce high-frequency noise
-#define LPF_ALPHA              0.1f  // 1.0 = no filtering
-static int16_t lpf_prev = 0;
+// Capture filtering (fixed-point dsp_chain): a DC blocker takes out whatever bias
+// ADC_MID_CODE misses, and a one-pole low-pass reduces high-frequency noise
+// (the corner of the former float filter, alpha 0.1)
+#define ADC_DC_BLOCK_HZ        10.0f
+#define ADC_LPF_HZ             800.0f
+
+// Conversion-done: wake the capture task, which parses and then reports the samples
+static bool adc_on_conv_done(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data) {
+    BaseType_t woken = pdFALSE;
+    if (capture_task) {
+        vTaskNotifyGiveFromISR(capture_task, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+// Driver pool full: conversion frames are being lost before we read them
+static bool adc_on_pool_ovf(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data) {
+    portENTER_CRITICAL_ISR(&stats_lock);
+    adc_stats.driver_overruns++;
+    portEXIT_CRITICAL_ISR(&stats_lock);
+    return false;
+}
+
+// TYPE2 results -> i24 mono, bias removed; returns samples produced
+static size_t parse_results(const uint8_t *raw, uint32_t bytes, int32_t *out) {
+    size_t codes = 0;
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= bytes; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)&raw[i];
+
+        // Only process the configured channel (left)
+        if (p->type2.channel == ADC_LEFT_CHANNEL) {
+            // Remove DC bias and scale 12-bit to 24-bit
+            out[codes++] = ((int32_t)p->type2.data - ADC_MID_CODE) << 12;
+        }
+    }
+    return codes;
+}
+
+// i24 -> 16-bit with rounding; the filters can overshoot full scale slightly
+static void narrow_to_s16(const int32_t *in, size_t count, int16_t *out) {
+    for (size_t i = 0; i < count; i++) {
+        int32_t v = (in[i] + 0x80) >> 8;
+        if (v > INT16_MAX) v = INT16_MAX;
+        if (v < INT16_MIN) v = INT16_MIN;
+        out[i] = (int16_t)v;
+    }
+}
+
+static void adc_capture_task(void *arg) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Drain everything the driver holds; events can coalesce while we run
+        uint32_t bytes_read = 0;
+        while (adc_handle && adc_continuous_read(adc_handle, adc_raw_data, ADC_CONV_FRAME_SIZE, &bytes_read, 0) == ESP_OK) {
+            size_t count = parse_results(adc_raw_data, bytes_read, capture_i24);
+            if (count == 0) {
+                continue;
+            }
+            // Filter even while discarding so the state is settled when AUX is selected
+            dsp_chain_process(capture_chain, capture_i24, count);
+            if (!capturing) {
+                continue;
+            }
+            narrow_to_s16(capture_i24, count, capture_samples);
+
+            size_t bytes = count * sizeof(int16_t);
+            if (ring_buffer_write(sample_ring, (const uint8_t *)capture_samples, bytes) != ESP_OK) {
+                // Audio task fell behind: drop the newest block, keep the ring frame-aligned
+                portENTER_CRITICAL(&stats_lock);
+                adc_stats.overruns++;
+                adc_stats.dropped_samples += count;
+                portEXIT_CRITICAL(&stats_lock);
+                continue;
+            }
+            portENTER_CRITICAL(&stats_lock);
+            adc_stats.samples += count;
+            portEXIT_CRITICAL(&stats_lock);
+
+            // Samples are readable now, so a frame made due here is always complete
+            frame_scheduler_samples(FRAME_CLOCK_ADC, count);
+        }
+    }
+}
 
 esp_err_t adc_audio_init(void) {
     if (adc_handle != NULL) {
@@ -34,9 +133,33 @@ esp_err_t adc_audio_init(void) {
         return ESP_OK;
     }
 
+    if (!sample_ring) {
+        sample_ring = ring_buffer_create(ADC_RING_FRAMES * AUDIO_FRAME_SAMPLES * sizeof(int16_t));
+        if (!sample_ring) {
+            ESP_LOGE(TAG, "Failed to create ADC sample ring");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (!capture_chain) {
+        capture_chain = dsp_chain_create(2);
+        if (!capture_chain) {
+            ESP_LOGE(TAG, "Failed to create capture filter chain");
+            return ESP_ERR_NO_MEM;
+        }
+        dsp_chain_add(capture_chain, DSP_FILTER_DC_BLOCK, ADC_DC_BLOCK_HZ, 0.0f, 0.0f);
+        dsp_chain_add(capture_chain, DSP_FILTER_LOWPASS1, ADC_LPF_HZ, 0.0f, 0.0f);
+    }
+    if (!capture_task) {
+        if (xTaskCreate(adc_capture_task, "adc_capture", ADC_CAPTURE_STACK, NULL,
+                        ADC_CAPTURE_TASK_PRIO, &capture_task) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create ADC capture task");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
     // Configure ADC continuous mode for stereo capture
     adc_continuous_handle_cfg_t adc_config = {
-        .max_store_buf_size = ADC_CONV_FRAME_SIZE * 2,
+        .max_store_buf_size = ADC_CONV_FRAME_SIZE * ADC_DRIVER_FRAMES,
         .conv_frame_size = ADC_CONV_FRAME_SIZE,
     };
 
@@ -56,11 +179,13 @@ esp_err_t adc_audio_init(void) {
         }
     };
 
-    // Update to 48 kHz mono for v0.1 spec compliance
+    // Update to 48 kHz mono for v0.1 spec compliance. No oversampling: the
+    // digital controller tops out at SOC_ADC_SAMPLE_FREQ_THRES_HIGH (83.3 kHz
+    // on the ESP32-S3), below even 2x the output rate
     adc_continuous_config_t dig_cfg = {
         .pattern_num = 1,  // Mono input
         .adc_pattern = adc_pattern,
-        .sample_freq_hz = 48000,  // 48 kHz mono
+        .sample_freq_hz = AUDIO_SAMPLE_RATE,  // 48 kHz mono
         .conv_mode = ADC_CONV_SINGLE_UNIT_1,
         .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
     };
@@ -73,6 +198,18 @@ esp_err_t adc_audio_init(void) {
         return ret;
     }
 
+    adc_continuous_evt_cbs_t cbs = {
+        .on_conv_done = adc_on_conv_done,
+        .on_pool_ovf = adc_on_pool_ovf,
+    };
+    ret = adc_continuous_register_event_callbacks(adc_handle, &cbs, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register ADC callbacks: %s", esp_err_to_name(ret));
+        adc_continuous_deinit(adc_handle);
+        adc_handle = NULL;
+        return ret;
+    }
+
     ret = adc_continuous_start(adc_handle);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start ADC continuous: %s", esp_err_to_name(ret));
@@ -102,81 +239,48 @@ esp_err_t adc_audio_deinit(void) {
 }
 
 esp_err_t adc_audio_start(void) {
-    // ADC is always started
+    // The ADC itself always runs; start routing samples, minus whatever was
+    // left over from the last AUX session (flushed by the reader, which owns that side)
+    flush_pending = true;
+    capturing = true;
     return ESP_OK;
 }
 
 esp_err_t adc_audio_stop(void) {
-    // ADC is always running
+    // ADC keeps running; the capture task discards samples until the next start
+    capturing = false;
     return ESP_OK;
 }
 
-esp_err_t adc_audio_read_stereo(int16_t *stereo_buffer, size_t num_samples, size_t *samples_read) {
+esp_err_t adc_audio_read_frame(int16_t *mono_buffer, size_t num_samples) {
     if (adc_handle == NULL) {
         ESP_LOGE(TAG, "ADC not initialized");
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (!stereo_buffer || !samples_read) {
+    if (!mono_buffer || num_samples == 0) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    *samples_read = 0;
-
-    // Read raw ADC data
-    uint8_t adc_raw_data[ADC_READ_LEN];
-    uint32_t bytes_read = 0;
-    
-    esp_err_t ret = adc_continuous_read(adc_handle, adc_raw_data, ADC_READ_LEN, &bytes_read, 0);
-    
-    if (ret == ESP_ERR_TIMEOUT) {
-        // No data available yet
-        return ESP_OK;
-    }
-    
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "ADC read failed: %s", esp_err_to_name(ret));
-        return ret;
+    if (flush_pending) {
+        flush_pending = false;
+        ring_buffer_release(sample_ring, ring_buffer_available(sample_ring));
     }
 
-    // Parse ADC data (mono channel)
-    size_t mono_count = 0;
-
-    for (uint32_t i = 0; i < bytes_read; i += SOC_ADC_DIGI_RESULT_BYTES) {
-        adc_digi_output_data_t *p = (adc_digi_output_data_t *)&adc_raw_data[i];
-
-    // Check if valid data (TYPE2 format for ESP32-S3)
-    uint32_t chan_num = p->type2.channel;
-    uint32_t data = p->type2.data;
-
-        // Only process the configured channel (left)
-        if (chan_num == ADC_LEFT_CHANNEL) {
-            // Remove DC bias and scale 12-bit to 16-bit (left-shift by 4)
-            int16_t sample = (int16_t)((data - ADC_MID_CODE) << 4);
-
-            // Apply low-pass filter to reduce high-frequency noise
-            int16_t filtered_sample = (int16_t)(LPF_ALPHA * sample + (1.0f - LPF_ALPHA) * lpf_prev);
-            lpf_prev = filtered_sample;
-
-            mono_samples[mono_count++] = filtered_sample;
-        }
-    }
-
-    // Duplicate mono to stereo (no upsampling needed, direct 48 kHz)
-    size_t out_samples = mono_count;
-    if (out_samples > num_samples) out_samples = num_samples;
-
-    for (size_t i = 0; i < out_samples; i++) {
-        stereo_buffer[i * 2] = mono_samples[i];     // Left
-        stereo_buffer[i * 2 + 1] = mono_samples[i]; // Right
-    }
-
-    *samples_read = out_samples;
-
-    if (mono_count > 0) {
-    ESP_LOGD(TAG, "Read %zu mono samples (duplicated to stereo) from %lu bytes",
-    mono_count, bytes_read);
+    esp_err_t ret = ring_buffer_read(sample_ring, (uint8_t *)mono_buffer, num_samples * sizeof(int16_t));
+    portENTER_CRITICAL(&stats_lock);
+    if (ret == ESP_OK) {
+        adc_stats.frames++;
+    } else {
+        adc_stats.short_reads++;
     }
+    portEXIT_CRITICAL(&stats_lock);
+    return ret;
+}
 
-    return ESP_OK;
+void adc_audio_get_stats(adc_audio_stats_t *stats) {
+    if (!stats) return;
+    portENTER_CRITICAL(&stats_lock);
+    *stats = adc_stats;
+    portEXIT_CRITICAL(&stats_lock);
 }
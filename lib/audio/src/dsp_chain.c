@@ -0,0 +1,211 @@
+#include "audio/dsp_chain.h"
+#include "config/build.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+
+static const char *TAG = "dsp_chain";
+
+#define DSP_COEF_SHIFT   27                       // Q5.27: Q31 coefficients / 16
+#define DSP_COEF_ONE     (1 << DSP_COEF_SHIFT)
+#define DSP_COEF_LIMIT   16.0                     // Exclusive bound on |coefficient|
+#define DSP_ERR_MASK     ((int64_t)DSP_COEF_ONE - 1)
+
+// y = b0*x + b1*x1 + b2*x2 + a1*y1 + a2*y2 (feedback terms pre-negated, so all adds)
+typedef struct {
+    int32_t b0, b1, b2, a1, a2;
+    int32_t x1, x2, y1, y2;
+    int64_t err;                                  // Fraction dropped from the last output
+} dsp_biquad_t;
+
+struct dsp_chain_t {
+    dsp_biquad_t *stages;
+    size_t count;
+    size_t capacity;
+};
+
+static bool coef_fits(double v) {
+    return fabs(v) < DSP_COEF_LIMIT - 1.0 / DSP_COEF_ONE;  // Still in range once rounded
+}
+
+// Normalized by a0; feedback negated for the all-add form. ESP_ERR_INVALID_ARG,
+// leaving bq untouched, when a coefficient doesn't fit Q5.27 rather than
+// letting it wrap (a high shelf's b1 is about -2x its linear gain).
+static esp_err_t set_coefs(dsp_biquad_t *bq, double b0, double b1, double b2, double a0, double a1, double a2) {
+    const double c[5] = { b0 / a0, b1 / a0, b2 / a0, -a1 / a0, -a2 / a0 };
+    for (int i = 0; i < 5; i++) {
+        if (!coef_fits(c[i])) return ESP_ERR_INVALID_ARG;
+    }
+    bq->b0 = (int32_t)lrint(c[0] * DSP_COEF_ONE);
+    bq->b1 = (int32_t)lrint(c[1] * DSP_COEF_ONE);
+    bq->b2 = (int32_t)lrint(c[2] * DSP_COEF_ONE);
+    bq->a1 = (int32_t)lrint(c[3] * DSP_COEF_ONE);
+    bq->a2 = (int32_t)lrint(c[4] * DSP_COEF_ONE);
+    return ESP_OK;
+}
+
+static esp_err_t design(dsp_biquad_t *bq, dsp_filter_type_t type, float freq_hz, float q, float gain_db) {
+    const double fs = AUDIO_SAMPLE_RATE;
+    if (!(freq_hz > 0.0f && freq_hz < fs / 2)) return ESP_ERR_INVALID_ARG;
+    if (q <= 0.0f) q = DSP_Q_BUTTERWORTH;
+
+    const double w0 = 2.0 * M_PI * freq_hz / fs;
+    const double cw = cos(w0);
+    const double alpha = sin(w0) / (2.0 * q);
+    const double k = tan(w0 / 2.0);               // Bilinear first-order prewarp
+    const double A = pow(10.0, gain_db / 40.0);   // Shelf/peak amplitude (sqrt of gain)
+    esp_err_t ret;
+
+    switch (type) {
+    case DSP_FILTER_DC_BLOCK: {
+        // y = g*(x - x1) + R*y1, g = (1 + R)/2 for unity gain at Nyquist
+        double R = 1.0 - w0;
+        ret = set_coefs(bq, (1.0 + R) / 2.0, -(1.0 + R) / 2.0, 0.0, 1.0, -R, 0.0);
+        break;
+    }
+    case DSP_FILTER_LOWPASS1:
+        ret = set_coefs(bq, k, k, 0.0, 1.0 + k, k - 1.0, 0.0);
+        break;
+    case DSP_FILTER_HIGHPASS1:
+        ret = set_coefs(bq, 1.0, -1.0, 0.0, 1.0 + k, k - 1.0, 0.0);
+        break;
+    case DSP_FILTER_LOWPASS:
+        ret = set_coefs(bq, (1.0 - cw) / 2.0, 1.0 - cw, (1.0 - cw) / 2.0,
+                        1.0 + alpha, -2.0 * cw, 1.0 - alpha);
+        break;
+    case DSP_FILTER_HIGHPASS:
+        ret = set_coefs(bq, (1.0 + cw) / 2.0, -(1.0 + cw), (1.0 + cw) / 2.0,
+                        1.0 + alpha, -2.0 * cw, 1.0 - alpha);
+        break;
+    case DSP_FILTER_PEAKING:
+        ret = set_coefs(bq, 1.0 + alpha * A, -2.0 * cw, 1.0 - alpha * A,
+                        1.0 + alpha / A, -2.0 * cw, 1.0 - alpha / A);
+        break;
+    case DSP_FILTER_LOW_SHELF: {
+        double sa = 2.0 * sqrt(A) * alpha;
+        ret = set_coefs(bq, A * ((A + 1) - (A - 1) * cw + sa),
+                        2.0 * A * ((A - 1) - (A + 1) * cw),
+                        A * ((A + 1) - (A - 1) * cw - sa),
+                        (A + 1) + (A - 1) * cw + sa,
+                        -2.0 * ((A - 1) + (A + 1) * cw),
+                        (A + 1) + (A - 1) * cw - sa);
+        break;
+    }
+    case DSP_FILTER_HIGH_SHELF: {
+        double sa = 2.0 * sqrt(A) * alpha;
+        ret = set_coefs(bq, A * ((A + 1) + (A - 1) * cw + sa),
+                        -2.0 * A * ((A - 1) + (A + 1) * cw),
+                        A * ((A + 1) + (A - 1) * cw - sa),
+                        (A + 1) - (A - 1) * cw + sa,
+                        2.0 * ((A - 1) - (A + 1) * cw),
+                        (A + 1) - (A - 1) * cw - sa);
+        break;
+    }
+    default:
+        ret = ESP_ERR_INVALID_ARG;
+        break;
+    }
+    return ret;
+}
+
+dsp_chain_t* dsp_chain_create(size_t max_stages) {
+    if (max_stages == 0) return NULL;
+
+    dsp_chain_t *chain = calloc(1, sizeof(dsp_chain_t));
+    if (!chain) return NULL;
+
+    chain->stages = calloc(max_stages, sizeof(dsp_biquad_t));
+    if (!chain->stages) {
+        free(chain);
+        return NULL;
+    }
+    chain->capacity = max_stages;
+    return chain;
+}
+
+void dsp_chain_destroy(dsp_chain_t *chain) {
+    if (chain) {
+        free(chain->stages);
+        free(chain);
+    }
+}
+
+esp_err_t dsp_chain_add(dsp_chain_t *chain, dsp_filter_type_t type, float freq_hz, float q, float gain_db) {
+    if (!chain) return ESP_ERR_INVALID_ARG;
+    if (chain->count >= chain->capacity) return ESP_ERR_NO_MEM;
+
+    dsp_biquad_t *bq = &chain->stages[chain->count];
+    memset(bq, 0, sizeof(*bq));
+    esp_err_t ret = design(bq, type, freq_hz, q, gain_db);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Invalid stage: type %d at %.1f Hz, q %.2f, %.1f dB", (int)type, freq_hz, q, gain_db);
+        return ret;
+    }
+    chain->count++;
+    return ESP_OK;
+}
+
+esp_err_t dsp_chain_set(dsp_chain_t *chain, size_t index, dsp_filter_type_t type, float freq_hz, float q, float gain_db) {
+    if (!chain || index >= chain->count) return ESP_ERR_INVALID_ARG;
+
+    dsp_biquad_t tmp = chain->stages[index];
+    esp_err_t ret = design(&tmp, type, freq_hz, q, gain_db);
+    if (ret == ESP_OK) {
+        chain->stages[index] = tmp;
+    }
+    return ret;
+}
+
+size_t dsp_chain_stages(const dsp_chain_t *chain) {
+    return chain ? chain->count : 0;
+}
+
+void dsp_chain_reset(dsp_chain_t *chain) {
+    if (!chain) return;
+    for (size_t s = 0; s < chain->count; s++) {
+        dsp_biquad_t *bq = &chain->stages[s];
+        bq->x1 = bq->x2 = bq->y1 = bq->y2 = 0;
+        bq->err = 0;
+    }
+}
+
+// One stage over the whole block: coefficients and state stay in registers and
+// the recursion runs back to back (the LX7 pipelines MULL/MULSH pairs)
+static void process_stage(dsp_biquad_t *bq, int32_t *samples, size_t n) {
+    const int32_t b0 = bq->b0, b1 = bq->b1, b2 = bq->b2, a1 = bq->a1, a2 = bq->a2;
+    int32_t x1 = bq->x1, x2 = bq->x2, y1 = bq->y1, y2 = bq->y2;
+    int64_t err = bq->err;
+
+    for (size_t i = 0; i < n; i++) {
+        int32_t x0 = samples[i];
+        int64_t acc = err;
+        acc += (int64_t)b0 * x0;
+        acc += (int64_t)b1 * x1;
+        acc += (int64_t)b2 * x2;
+        acc += (int64_t)a1 * y1;
+        acc += (int64_t)a2 * y2;
+        int32_t y0 = (int32_t)(acc >> DSP_COEF_SHIFT);
+        err = acc & DSP_ERR_MASK;
+
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+        samples[i] = y0;
+    }
+
+    bq->x1 = x1;
+    bq->x2 = x2;
+    bq->y1 = y1;
+    bq->y2 = y2;
+    bq->err = err;
+}
+
+void dsp_chain_process(dsp_chain_t *chain, int32_t *samples, size_t num_samples) {
+    if (!chain || !samples) return;
+    for (size_t s = 0; s < chain->count; s++) {
+        process_stage(&chain->stages[s], samples, num_samples);
+    }
+}
@@ -0,0 +1,90 @@
+#include "audio/frame_pool.h"
+#include <freertos/FreeRTOS.h>
+#include <esp_log.h>
+#include <stdbool.h>
+
+static const char *TAG = "frame_pool";
+
+static audio_frame_t pool_frames[FRAME_POOL_FRAMES];
+static audio_frame_t *free_stack[FRAME_POOL_FRAMES];  // LIFO keeps recently used frames cache-warm
+static size_t free_count = 0;
+static bool pool_ready = false;
+static frame_pool_stats_t pool_stats;
+static portMUX_TYPE pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t frame_pool_init(void) {
+    portENTER_CRITICAL(&pool_lock);
+    if (pool_ready) {
+        portEXIT_CRITICAL(&pool_lock);
+        return ESP_OK;
+    }
+    for (size_t i = 0; i < FRAME_POOL_FRAMES; i++) {
+        atomic_init(&pool_frames[i].refs, 0);
+        free_stack[i] = &pool_frames[i];
+    }
+    free_count = FRAME_POOL_FRAMES;
+    pool_stats.total = FRAME_POOL_FRAMES;
+    pool_ready = true;
+    portEXIT_CRITICAL(&pool_lock);
+
+    ESP_LOGI(TAG, "Frame pool ready: %u frames x %u bytes", FRAME_POOL_FRAMES, FRAME_POOL_BUF_BYTES);
+    return ESP_OK;
+}
+
+audio_frame_t* frame_pool_alloc(size_t headroom) {
+    if (headroom > FRAME_POOL_BUF_BYTES) return NULL;
+
+    audio_frame_t *frame = NULL;
+    portENTER_CRITICAL(&pool_lock);
+    if (free_count > 0) {
+        frame = free_stack[--free_count];
+        pool_stats.in_use++;
+        if (pool_stats.in_use > pool_stats.high_water) {
+            pool_stats.high_water = pool_stats.in_use;
+        }
+    } else {
+        pool_stats.exhausted++;
+    }
+    portEXIT_CRITICAL(&pool_lock);
+
+    if (frame) {
+        frame->data = frame->buf + headroom;
+        frame->len = 0;
+        atomic_store_explicit(&frame->refs, 1, memory_order_relaxed);
+    }
+    return frame;
+}
+
+void frame_pool_ref(audio_frame_t *frame) {
+    if (frame) {
+        atomic_fetch_add_explicit(&frame->refs, 1, memory_order_relaxed);
+    }
+}
+
+void frame_pool_unref(audio_frame_t *frame) {
+    if (!frame) return;
+    // acq_rel: the last holder must see every other holder's writes before reuse
+    uint32_t refs = atomic_fetch_sub_explicit(&frame->refs, 1, memory_order_acq_rel);
+    if (refs == 0) {
+        // Already free: pushing it again would hand it to two owners
+        atomic_fetch_add_explicit(&frame->refs, 1, memory_order_relaxed);
+        portENTER_CRITICAL(&pool_lock);
+        pool_stats.bad_unrefs++;
+        portEXIT_CRITICAL(&pool_lock);
+        ESP_LOGE(TAG, "Unref of free frame %p", (void *)frame);
+        return;
+    }
+    if (refs != 1) return;
+
+    portENTER_CRITICAL(&pool_lock);
+    free_stack[free_count++] = frame;
+    pool_stats.in_use--;
+    portEXIT_CRITICAL(&pool_lock);
+}
+
+void frame_pool_get_stats(frame_pool_stats_t *stats) {
+    if (!stats) return;
+    portENTER_CRITICAL(&pool_lock);
+    *stats = pool_stats;
+    portEXIT_CRITICAL(&pool_lock);
+}
@@ -0,0 +1,114 @@
+#include "audio/frame_scheduler.h"
+#include "config/build.h"
+#include <esp_timer.h>
+#include <esp_log.h>
+
+static const char *TAG = "frame_scheduler";
+
+static TaskHandle_t audio_task = NULL;
+static esp_timer_handle_t frame_timer = NULL;
+static volatile frame_clock_t active_clock = FRAME_CLOCK_TIMER;
+static uint32_t pending_samples = 0;  // Samples toward the next frame (active clock only)
+static frame_scheduler_stats_t stats;
+static portMUX_TYPE sched_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Accumulate under the lock; returns frames completed by these samples
+static uint32_t accumulate(frame_clock_t clock, uint32_t samples) {
+    uint32_t due = 0;
+    if (clock == active_clock) {
+        pending_samples += samples;
+        while (pending_samples >= AUDIO_FRAME_SAMPLES) {
+            pending_samples -= AUDIO_FRAME_SAMPLES;
+            due++;
+        }
+        stats.frames += due;
+    }
+    return due;
+}
+
+void frame_scheduler_samples_from_isr(frame_clock_t clock, uint32_t samples, BaseType_t *woken) {
+    portENTER_CRITICAL_ISR(&sched_lock);
+    uint32_t due = accumulate(clock, samples);
+    portEXIT_CRITICAL_ISR(&sched_lock);
+
+    while (due-- > 0 && audio_task) {
+        vTaskNotifyGiveFromISR(audio_task, woken);
+    }
+}
+
+void frame_scheduler_samples(frame_clock_t clock, uint32_t samples) {
+    portENTER_CRITICAL(&sched_lock);
+    uint32_t due = accumulate(clock, samples);
+    portEXIT_CRITICAL(&sched_lock);
+
+    while (due-- > 0 && audio_task) {
+        xTaskNotifyGive(audio_task);
+    }
+}
+
+static void frame_timer_callback(void *arg) {
+    frame_scheduler_samples(FRAME_CLOCK_TIMER, AUDIO_FRAME_SAMPLES);
+}
+
+esp_err_t frame_scheduler_init(TaskHandle_t task, frame_clock_t clock) {
+    if (!task) return ESP_ERR_INVALID_ARG;
+    audio_task = task;
+
+    if (!frame_timer) {
+        // Periodic esp_timer alarms are scheduled from the previous alarm, not from
+        // when the callback ran, so callback latency never accumulates
+        const esp_timer_create_args_t timer_args = {
+            .callback = &frame_timer_callback,
+            .name = "frame_clock",
+            .dispatch_method = ESP_TIMER_TASK,
+        };
+        esp_err_t ret = esp_timer_create(&timer_args, &frame_timer);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create frame timer: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    return frame_scheduler_set_clock(clock);
+}
+
+esp_err_t frame_scheduler_set_clock(frame_clock_t clock) {
+    if (!frame_timer) return ESP_ERR_INVALID_STATE;
+
+    portENTER_CRITICAL(&sched_lock);
+    active_clock = clock;
+    pending_samples = 0;
+    portEXIT_CRITICAL(&sched_lock);
+
+    esp_timer_stop(frame_timer);  // ESP_ERR_INVALID_STATE if not running - fine
+    if (clock == FRAME_CLOCK_TIMER) {
+        esp_err_t ret = esp_timer_start_periodic(frame_timer, AUDIO_FRAME_MS * 1000);
+        if (ret != ESP_OK) return ret;
+    }
+
+    ESP_LOGI(TAG, "Frame clock: %s", clock == FRAME_CLOCK_ADC ? "ADC" :
+             clock == FRAME_CLOCK_USB ? "USB SOF" : "timer");
+    return ESP_OK;
+}
+
+frame_clock_t frame_scheduler_get_clock(void) {
+    return active_clock;
+}
+
+uint32_t frame_scheduler_wait(TickType_t timeout) {
+    uint32_t due = ulTaskNotifyTake(pdFALSE, timeout);  // Take one frame, leave the rest pending
+    portENTER_CRITICAL(&sched_lock);
+    if (due == 0) {
+        stats.timeouts++;
+    } else if (due > 1) {
+        stats.late++;
+    }
+    portEXIT_CRITICAL(&sched_lock);
+    return due;
+}
+
+void frame_scheduler_get_stats(frame_scheduler_stats_t *out) {
+    if (!out) return;
+    portENTER_CRITICAL(&sched_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&sched_lock);
+}
@@ -0,0 +1,176 @@
+#include "audio/gain_stage.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GAIN_SHIFT        30                      // Q2.30
+#define GAIN_ONE          (1 << GAIN_SHIFT)
+#define GAIN_MAX          INT32_MAX               // Just under 2.0 (+6.02 dB)
+
+#define S16_FULL          32767
+#define I24_FULL          8388607
+#define KNEE(full)        ((full) - ((full) >> 2))  // Soft clip starts at 3/4 FS (-2.5 dBFS)
+
+struct gain_stage_t {
+    volatile int32_t target;     // Q2.30, written by setters
+    volatile bool mute;
+    volatile bool soft_clip;
+    int32_t current;             // Q2.30, where the last buffer ended (process side)
+};
+
+gain_stage_t* gain_stage_create(void) {
+    gain_stage_t *stage = calloc(1, sizeof(gain_stage_t));
+    if (!stage) return NULL;
+    stage->target = GAIN_ONE;
+    stage->current = GAIN_ONE;
+    return stage;
+}
+
+void gain_stage_destroy(gain_stage_t *stage) {
+    free(stage);
+}
+
+void gain_stage_set_gain(gain_stage_t *stage, float linear) {
+    if (!stage) return;
+    if (!(linear > 0.0f)) {
+        stage->target = 0;
+        return;
+    }
+    double q = (double)linear * GAIN_ONE;
+    stage->target = (q >= (double)GAIN_MAX) ? GAIN_MAX : (int32_t)lrint(q);
+}
+
+void gain_stage_set_gain_db(gain_stage_t *stage, float db) {
+    if (db > GAIN_STAGE_MAX_DB) db = GAIN_STAGE_MAX_DB;
+    gain_stage_set_gain(stage, powf(10.0f, db / 20.0f));
+}
+
+void gain_stage_set_mute(gain_stage_t *stage, bool mute) {
+    if (stage) stage->mute = mute;
+}
+
+void gain_stage_set_soft_clip(gain_stage_t *stage, bool enable) {
+    if (stage) stage->soft_clip = enable;
+}
+
+float gain_stage_get_gain_db(const gain_stage_t *stage) {
+    if (!stage || stage->target == 0) return -INFINITY;
+    return 20.0f * log10f((float)stage->target / GAIN_ONE);
+}
+
+// Above the knee the excess e maps to knee + e*room/(e + room): slope 1 at the
+// knee, approaching full scale asymptotically. Only reached on loud samples.
+static int32_t soft_limit(int64_t y, int32_t full) {
+    const int64_t knee = KNEE(full);
+    const int64_t room = full - knee;
+    int64_t a = y < 0 ? -y : y;
+    if (a <= knee) return (int32_t)y;
+    int64_t e = a - knee;
+    a = knee + e * room / (e + room);
+    return (int32_t)(y < 0 ? -a : a);
+}
+
+static inline int32_t apply_gain(int32_t x, int32_t g, int32_t full, bool soft) {
+    int64_t y = ((int64_t)x * g + (1 << (GAIN_SHIFT - 1))) >> GAIN_SHIFT;
+    if (soft) return soft_limit(y, full);
+    if (y > full) return full;
+    if (y < -full) return -full;
+    return (int32_t)y;
+}
+
+// Gain for this buffer: settled (step 0) or a linear ramp that lands exactly
+// on the target after num_frames. Returns false when the buffer is untouched.
+static bool begin_buffer(gain_stage_t *stage, size_t num_frames, int32_t *gain, int32_t *step) {
+    int32_t target = stage->mute ? 0 : stage->target;
+    *gain = stage->current;
+    *step = 0;
+    if (*gain != target) {
+        *step = (int32_t)(((int64_t)target - *gain) / (int64_t)num_frames);
+    }
+    stage->current = target;
+    return !(*step == 0 && *gain == GAIN_ONE && !stage->soft_clip);
+}
+
+// 16-bit samples use the top 16 bits of the gain (Q15, < 2^16): x * g15 stays
+// inside int32 even at -32768 x max gain, so the common no-soft-clip case is a
+// 32-bit multiply, shift and clamp per sample with no 64-bit math
+static inline int16_t apply_gain_q15(int32_t x, int32_t g15) {
+    int32_t y = (x * g15 + (1 << 14)) >> 15;
+    y = y > S16_FULL ? S16_FULL : y;
+    y = y < -S16_FULL ? -S16_FULL : y;
+    return (int16_t)y;
+}
+
+void gain_stage_process_s16(gain_stage_t *stage, int16_t *samples, size_t num_frames, size_t channels) {
+    if (!stage || !samples || num_frames == 0 || channels == 0) return;
+
+    int32_t g, step;
+    if (!begin_buffer(stage, num_frames, &g, &step)) return;
+    const size_t total = num_frames * channels;
+    if (step == 0 && g == 0) {
+        memset(samples, 0, total * sizeof(int16_t));
+        return;
+    }
+
+    if (stage->soft_clip) {
+        for (size_t f = 0; f < num_frames; f++, g += step) {
+            for (size_t c = 0; c < channels; c++, samples++) {
+                *samples = (int16_t)apply_gain(*samples, g, S16_FULL, true);
+            }
+        }
+    } else if (step == 0 && (g >> 15) <= (1 << 15)) {
+        // Settled at or below unity: cannot overflow, so no clamp either
+        const int32_t g15 = g >> 15;
+        for (size_t i = 0; i < total; i++) {
+            samples[i] = (int16_t)((samples[i] * g15 + (1 << 14)) >> 15);
+        }
+    } else if (step == 0) {
+        const int32_t g15 = g >> 15;
+        for (size_t i = 0; i < total; i++) {
+            samples[i] = apply_gain_q15(samples[i], g15);
+        }
+    } else {
+        for (size_t f = 0; f < num_frames; f++, g += step) {
+            const int32_t g15 = g >> 15;
+            for (size_t c = 0; c < channels; c++, samples++) {
+                *samples = apply_gain_q15(*samples, g15);
+            }
+        }
+    }
+}
+
+void gain_stage_process_i24(gain_stage_t *stage, int32_t *samples, size_t num_samples) {
+    if (!stage || !samples || num_samples == 0) return;
+
+    int32_t g, step;
+    if (!begin_buffer(stage, num_samples, &g, &step)) return;
+    if (step == 0 && g == 0) {
+        memset(samples, 0, num_samples * sizeof(int32_t));
+        return;
+    }
+
+    const bool soft = stage->soft_clip;
+    if (step == 0) {
+        for (size_t i = 0; i < num_samples; i++) {
+            samples[i] = apply_gain(samples[i], g, I24_FULL, soft);
+        }
+    } else {
+        for (size_t i = 0; i < num_samples; i++, g += step) {
+            samples[i] = apply_gain(samples[i], g, I24_FULL, soft);
+        }
+    }
+}
+
+void gain_stage_uac_set_volume(uint32_t volume, void *cb_ctx) {
+    gain_stage_t *stage = (gain_stage_t *)cb_ctx;
+    if (volume == 0) {
+        gain_stage_set_gain(stage, 0.0f);
+        return;
+    }
+    if (volume > 100) volume = 100;
+    gain_stage_set_gain_db(stage, ((float)volume - 100.0f) * (GAIN_STAGE_UAC_RANGE_DB / 100.0f));
+}
+
+void gain_stage_uac_set_mute(uint32_t mute, void *cb_ctx) {
+    gain_stage_set_mute((gain_stage_t *)cb_ctx, mute != 0);
+}
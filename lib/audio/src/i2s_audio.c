@@ -4,16 +4,102 @@
 #include <driver/i2s_std.h>
 #include <esp_log.h>
 #include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <string.h>
+#include "audio/ring_buffer.h"
 
 static const char *TAG = "i2s_audio";
 static i2s_chan_handle_t tx_handle = NULL;
 
+// Output engine: writers format slots into a lock-free playout queue and return
+// at once; the on_sent DMA event refills each DMA buffer from the queue as soon
+// as it has been played (auto_clear off, so the buffer is ours until it comes
+// round again). A short queue is padded with silence and counted as an underrun.
+#define I2S_DMA_DESC_NUM   4                    // 5ms DMA buffers: 15ms queued ahead of the one playing
+#define I2S_DMA_FRAME_NUM  AUDIO_FRAME_SAMPLES
+#define I2S_QUEUE_FRAMES   (AUDIO_FRAME_SAMPLES * 2)  // Playout queue: 10ms
+
+#if I2S_OUTPUT_24BIT
+typedef int32_t i2s_slot_t;
+#define I2S_SLOT_BIT_WIDTH I2S_DATA_BIT_WIDTH_32BIT
+#define I2S_FROM_I24(s) ((int32_t)((uint32_t)(s) << 8))   // Left-justify 24 bits
+#define I2S_FROM_S16(s) ((int32_t)((uint32_t)(s) << 16))
+#else
+typedef int16_t i2s_slot_t;
+#define I2S_SLOT_BIT_WIDTH I2S_DATA_BIT_WIDTH_16BIT
+#define I2S_FROM_I24(s) ((int16_t)((s) >> 8))             // Drop 8 LSBs
+#define I2S_FROM_S16(s) (s)
+#endif
+#define I2S_FRAME_BYTES (2 * sizeof(i2s_slot_t))  // One stereo slot pair
+
+static ring_buffer_t *playout_queue = NULL;  // Producer: writers, consumer: on_sent
+static TaskHandle_t refill_task = NULL;
+static volatile uint32_t stat_underruns = 0;
+static volatile uint32_t stat_silence_frames = 0;
+static volatile uint32_t stat_overflows = 0;
+
+static bool i2s_on_sent(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx) {
+    // IDF 5.2: event->data points at the finished descriptor's buffer pointer
+    uint8_t *dma_buf = *(uint8_t **)event->data;
+    size_t want = event->size;
+    size_t filled = 0;
+
+    while (filled < want) {
+        size_t avail = 0;
+        const uint8_t *src = ring_buffer_peek(playout_queue, &avail);
+        if (!src) break;
+        size_t n = (avail < want - filled) ? avail : want - filled;
+        memcpy(dma_buf + filled, src, n);
+        ring_buffer_release(playout_queue, n);
+        filled += n;
+    }
+    if (filled < want) {
+        memset(dma_buf + filled, 0, want - filled);
+        stat_underruns++;
+        stat_silence_frames += (want - filled) / I2S_FRAME_BYTES;
+    }
+
+    BaseType_t woken = pdFALSE;
+    if (refill_task) {
+        vTaskNotifyGiveFromISR(refill_task, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+// Contiguous slots for up to frames stereo frames (the queue holds whole frames,
+// so a reservation splits at most once, at the wrap)
+static i2s_slot_t* reserve_slots(size_t frames, size_t *granted) {
+    size_t bytes = 0;
+    uint8_t *dst = ring_buffer_reserve(playout_queue, frames * I2S_FRAME_BYTES, &bytes);
+    *granted = bytes / I2S_FRAME_BYTES;
+    return (i2s_slot_t *)dst;
+}
+
+// All-or-nothing so a late writer drops whole frames instead of tearing one
+static esp_err_t check_room(size_t frames) {
+    if (!tx_handle || !playout_queue) return ESP_ERR_INVALID_STATE;
+    if (ring_buffer_free(playout_queue) < frames * I2S_FRAME_BYTES) {
+        stat_overflows++;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
 esp_err_t i2s_audio_init(void) {
+    playout_queue = ring_buffer_create(I2S_QUEUE_FRAMES * I2S_FRAME_BYTES);
+    if (!playout_queue) {
+        ESP_LOGE(TAG, "Failed to create playout queue");
+        return ESP_ERR_NO_MEM;
+    }
+
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_PORT, I2S_ROLE_MASTER);
+    chan_cfg.dma_desc_num = I2S_DMA_DESC_NUM;
+    chan_cfg.dma_frame_num = I2S_DMA_FRAME_NUM;
+    chan_cfg.auto_clear = false;  // on_sent owns the buffer contents
     ESP_ERROR_CHECK(i2s_new_channel(&chan_cfg, &tx_handle, NULL));
     i2s_std_config_t std_cfg = {
         .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(AUDIO_SAMPLE_RATE),
-        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_SLOT_BIT_WIDTH, I2S_SLOT_MODE_STEREO),
         .gpio_cfg = {
             .mclk = I2S_GPIO_UNUSED,
             .bclk = I2S_BCK_IO,
@@ -29,47 +115,90 @@ esp_err_t i2s_audio_init(void) {
     };
     
     ESP_ERROR_CHECK(i2s_channel_init_std_mode(tx_handle, &std_cfg));
+    i2s_event_callbacks_t cbs = {
+        .on_sent = i2s_on_sent,
+    };
+    ESP_ERROR_CHECK(i2s_channel_register_event_callback(tx_handle, &cbs, NULL));
     ESP_ERROR_CHECK(i2s_channel_enable(tx_handle));
     
+#if I2S_OUTPUT_24BIT
+    ESP_LOGI(TAG, "I2S initialized: %dHz, 24-bit in 32-bit slots, stereo", AUDIO_SAMPLE_RATE);
+#else
     ESP_LOGI(TAG, "I2S initialized: %dHz, 16-bit, stereo", AUDIO_SAMPLE_RATE);
+#endif
     return ESP_OK;
 }
 
 esp_err_t i2s_audio_write_samples(const int16_t *samples, size_t num_samples) {
-    if (!tx_handle) return ESP_ERR_INVALID_STATE;
-    
-    size_t bytes_written;
-    esp_err_t ret = i2s_channel_write(tx_handle, samples,
-    num_samples * sizeof(int16_t),
-    &bytes_written, portMAX_DELAY);
-    
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "I2S write failed");
-        return ret;
+    size_t frames = num_samples / 2;
+    esp_err_t ret = check_room(frames);
+    if (ret != ESP_OK) return ret;
+
+    while (frames > 0) {
+        size_t n;
+        i2s_slot_t *dst = reserve_slots(frames, &n);
+        for (size_t i = 0; i < n * 2; i++) {
+            dst[i] = I2S_FROM_S16(samples[i]);
+        }
+        ring_buffer_commit(playout_queue, n * I2S_FRAME_BYTES);
+        samples += n * 2;
+        frames -= n;
     }
-    
     return ESP_OK;
 }
 
 esp_err_t i2s_audio_write_mono_as_stereo(const int16_t *mono_samples, size_t num_mono_samples) {
-    if (!tx_handle) return ESP_ERR_INVALID_STATE;
+    esp_err_t ret = check_room(num_mono_samples);
+    if (ret != ESP_OK) return ret;
 
-    static int16_t stereo_buffer[AUDIO_FRAME_SAMPLES * 2];
-    
-    for (size_t i = 0; i < num_mono_samples; i++) {
-        stereo_buffer[i * 2] = mono_samples[i];
-        stereo_buffer[i * 2 + 1] = mono_samples[i];
-    }
-    
-    size_t bytes_written;
-    esp_err_t ret = i2s_channel_write(tx_handle, stereo_buffer,
-    num_mono_samples * 2 * sizeof(int16_t),
-    &bytes_written, portMAX_DELAY);
-    
-    if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "I2S stereo write failed");
-    return ret;
+    while (num_mono_samples > 0) {
+        size_t n;
+        i2s_slot_t *dst = reserve_slots(num_mono_samples, &n);
+        for (size_t i = 0; i < n; i++) {
+            i2s_slot_t s = I2S_FROM_S16(mono_samples[i]);
+            dst[i * 2] = s;
+            dst[i * 2 + 1] = s;
+        }
+        ring_buffer_commit(playout_queue, n * I2S_FRAME_BYTES);
+        mono_samples += n;
+        num_mono_samples -= n;
     }
+    return ESP_OK;
+}
+
+esp_err_t i2s_audio_write_i24_mono(const int32_t *mono_samples, size_t num_mono_samples) {
+    esp_err_t ret = check_room(num_mono_samples);
+    if (ret != ESP_OK) return ret;
 
+    // Fused mono->stereo and slot formatting: one pass from the DSP buffer into the queue
+    while (num_mono_samples > 0) {
+        size_t n;
+        i2s_slot_t *dst = reserve_slots(num_mono_samples, &n);
+        for (size_t i = 0; i < n; i++) {
+            i2s_slot_t s = I2S_FROM_I24(mono_samples[i]);
+            dst[i * 2] = s;
+            dst[i * 2 + 1] = s;
+        }
+        ring_buffer_commit(playout_queue, n * I2S_FRAME_BYTES);
+        mono_samples += n;
+        num_mono_samples -= n;
+    }
     return ESP_OK;
 }
+
+size_t i2s_audio_get_free_frames(void) {
+    return playout_queue ? ring_buffer_free(playout_queue) / I2S_FRAME_BYTES : 0;
+}
+
+void i2s_audio_set_refill_task(TaskHandle_t task) {
+    refill_task = task;
+}
+
+void i2s_audio_get_stats(i2s_audio_stats_t *stats) {
+    if (!stats) return;
+    stats->underruns = stat_underruns;
+    stats->silence_frames = stat_silence_frames;
+    stats->overflows = stat_overflows;
+    stats->queued_frames = playout_queue ? ring_buffer_available(playout_queue) / I2S_FRAME_BYTES : 0;
+    stats->dma_frames = (I2S_DMA_DESC_NUM - 1) * I2S_DMA_FRAME_NUM;
+}
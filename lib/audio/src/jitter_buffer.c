@@ -0,0 +1,377 @@
+#include "audio/jitter_buffer.h"
+#include <freertos/FreeRTOS.h>
+#include <esp_log.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+static const char *TAG = "jitter_buffer";
+
+// A seq this far from the playout head is a new stream (TX restart), not jitter
+#define JITTER_RESYNC_FACTOR 4
+
+// Adaptive depth tuning
+#define JITTER_DEPTH_K            4        // Target covers 4x the jitter estimate plus one frame
+#define JITTER_MAX_SAMPLE_US      200000   // Clamp transit jumps (stream restarts) in the estimator
+#define JITTER_SHRINK_HOLD_FRAMES 400      // Desired depth must stay lower for 2s @ 5ms before shrinking
+#define JITTER_DROP_INTERVAL      20       // At most one shrink drop per 100ms @ 5ms
+#define JITTER_DROP_MARGIN        2        // Default: drop once 2 frames deeper than the target
+
+typedef struct {
+    uint16_t seq;
+    bool valid;
+    uint32_t timestamp;
+    audio_frame_t *frame;      // Reference held while valid
+} jitter_slot_t;
+
+struct jitter_buffer_t {
+    portMUX_TYPE lock;
+    jitter_slot_t *slots;
+    size_t capacity;           // Power of two so seq & mask stays stable across 16-bit wrap
+    size_t mask;
+    size_t frame_bytes;
+    size_t target;             // Playout depth target (prefill threshold), frames
+    bool started;              // head_seq/newest_seq are valid
+    bool playing;              // Prefill reached, playout advancing
+    uint16_t head_seq;         // Next seq to play
+    uint16_t newest_seq;       // Highest seq stored so far
+    uint32_t empty_run;        // Consecutive playout requests with nothing buffered
+
+    // Adaptive depth (frame_us == 0 disables)
+    uint32_t frame_us;
+    size_t min_target;
+    size_t max_target;
+    bool have_transit;
+    int64_t last_transit_us;   // Arrival time minus sender timestamp of the previous frame
+    int32_t jitter_us;         // RFC 3550 interarrival jitter, J += (|D| - J) / 16
+    uint32_t avg_depth_q8;     // Smoothed buffered depth, Q8 frames
+    uint32_t shrink_votes;     // Consecutive playout requests wanting a shallower target
+    uint32_t gets_since_drop;
+    size_t drop_margin;        // Frames over target before the head is dropped (0 = never)
+
+    jitter_buffer_stats_t stats;
+};
+
+static size_t depth_locked(const jitter_buffer_t *jb) {
+    if (!jb->started) return 0;
+    int16_t span = (int16_t)(jb->newest_seq - jb->head_seq);
+    return (span < 0) ? 0 : (size_t)span + 1;
+}
+
+static void clear_slot_locked(jitter_slot_t *slot) {
+    if (slot->valid) {
+        frame_pool_unref(slot->frame);
+        slot->frame = NULL;
+        slot->valid = false;
+    }
+}
+
+static void restart_locked(jitter_buffer_t *jb) {
+    jb->started = false;
+    jb->playing = false;
+    jb->empty_run = 0;
+    jb->have_transit = false;
+    jb->avg_depth_q8 = 0;
+    for (size_t i = 0; i < jb->capacity; i++) {
+        clear_slot_locked(&jb->slots[i]);
+    }
+}
+
+static void grow_target_locked(jitter_buffer_t *jb) {
+    if (jb->frame_us && jb->target < jb->max_target) {
+        jb->target++;
+        jb->shrink_votes = 0;
+    }
+}
+
+static void update_jitter_locked(jitter_buffer_t *jb, uint32_t timestamp, int64_t arrival_us) {
+    int64_t transit = arrival_us - (int64_t)timestamp * 1000;
+    if (jb->have_transit) {
+        int64_t d = transit - jb->last_transit_us;
+        if (d < 0) d = -d;
+        if (d > JITTER_MAX_SAMPLE_US) d = JITTER_MAX_SAMPLE_US;
+        jb->jitter_us += ((int32_t)d - jb->jitter_us) / 16;
+    }
+    jb->last_transit_us = transit;
+    jb->have_transit = true;
+}
+
+// Depth that covers the current jitter estimate, clamped to the configured bounds
+static size_t desired_depth_locked(const jitter_buffer_t *jb) {
+    uint32_t cover_us = JITTER_DEPTH_K * (uint32_t)jb->jitter_us + jb->frame_us;
+    size_t frames = (cover_us + jb->frame_us - 1) / jb->frame_us;
+    if (frames < jb->min_target) frames = jb->min_target;
+    if (frames > jb->max_target) frames = jb->max_target;
+    return frames;
+}
+
+static void adapt_target_locked(jitter_buffer_t *jb, size_t depth) {
+    jb->avg_depth_q8 += ((int32_t)(depth << 8) - (int32_t)jb->avg_depth_q8) / 16;
+    if (jb->gets_since_drop < JITTER_DROP_INTERVAL) jb->gets_since_drop++;
+
+    // Grow immediately, shrink only after the estimate has stayed low for a while
+    size_t desired = desired_depth_locked(jb);
+    if (desired > jb->target) {
+        jb->target = desired;
+        jb->shrink_votes = 0;
+    } else if (desired < jb->target) {
+        if (++jb->shrink_votes >= JITTER_SHRINK_HOLD_FRAMES) {
+            jb->target--;
+            jb->shrink_votes = 0;
+        }
+    } else {
+        jb->shrink_votes = 0;
+    }
+}
+
+jitter_buffer_t* jitter_buffer_create(size_t capacity_frames, size_t frame_bytes, size_t prefill_frames) {
+    if (capacity_frames == 0 || frame_bytes == 0) return NULL;
+
+    size_t capacity = 1;
+    while (capacity < capacity_frames) capacity <<= 1;
+
+    jitter_buffer_t *jb = calloc(1, sizeof(jitter_buffer_t));
+    if (!jb) return NULL;
+
+    jb->slots = calloc(capacity, sizeof(jitter_slot_t));
+    if (!jb->slots) {
+        free(jb);
+        return NULL;
+    }
+
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    jb->lock = lock;
+    jb->capacity = capacity;
+    jb->mask = capacity - 1;
+    jb->frame_bytes = frame_bytes;
+    jb->target = (prefill_frames > capacity) ? capacity : prefill_frames;
+    jb->min_target = jb->target;
+    jb->max_target = jb->target;
+    jb->drop_margin = JITTER_DROP_MARGIN;
+
+    ESP_LOGI(TAG, "Jitter buffer created: %u slots x %u bytes, prefill %u",
+             capacity, frame_bytes, jb->target);
+    return jb;
+}
+
+void jitter_buffer_destroy(jitter_buffer_t *jb) {
+    if (jb) {
+        restart_locked(jb);  // Return held frames to the pool
+        free(jb->slots);
+        free(jb);
+    }
+}
+
+void jitter_buffer_reset(jitter_buffer_t *jb) {
+    if (!jb) return;
+    portENTER_CRITICAL(&jb->lock);
+    restart_locked(jb);
+    portEXIT_CRITICAL(&jb->lock);
+}
+
+esp_err_t jitter_buffer_set_adaptive(jitter_buffer_t *jb, size_t min_frames, size_t max_frames, uint32_t frame_us) {
+    if (!jb || frame_us == 0 || min_frames == 0 || min_frames > max_frames) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (max_frames > jb->capacity) max_frames = jb->capacity;
+    if (min_frames > max_frames) min_frames = max_frames;
+
+    portENTER_CRITICAL(&jb->lock);
+    jb->frame_us = frame_us;
+    jb->min_target = min_frames;
+    jb->max_target = max_frames;
+    if (jb->target < min_frames) jb->target = min_frames;
+    if (jb->target > max_frames) jb->target = max_frames;
+    portEXIT_CRITICAL(&jb->lock);
+
+    ESP_LOGI(TAG, "Adaptive depth enabled: %u-%u frames", min_frames, max_frames);
+    return ESP_OK;
+}
+
+esp_err_t jitter_buffer_set_drop_margin(jitter_buffer_t *jb, size_t margin_frames) {
+    if (!jb) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&jb->lock);
+    jb->drop_margin = margin_frames;
+    portEXIT_CRITICAL(&jb->lock);
+    return ESP_OK;
+}
+
+static esp_err_t put_locked(jitter_buffer_t *jb, uint16_t seq, uint32_t timestamp, int64_t arrival_us,
+                             audio_frame_t *frame) {
+    if (!frame) return ESP_ERR_INVALID_ARG;
+    if (frame->len != jb->frame_bytes) return ESP_ERR_INVALID_SIZE;
+
+    int32_t offset = jb->started ? (int16_t)(seq - jb->head_seq) : 0;
+    int32_t resync = (int32_t)(jb->capacity * JITTER_RESYNC_FACTOR);
+    if (offset <= -resync || offset >= resync) {
+        restart_locked(jb);
+    }
+
+    if (jb->frame_us) {
+        update_jitter_locked(jb, timestamp, arrival_us);
+    }
+
+    if (!jb->started) {
+        jb->head_seq = seq;
+        jb->newest_seq = seq;
+        jb->started = true;
+        offset = 0;
+    }
+
+    if (offset < 0) {
+        if (!jb->playing && (int16_t)(jb->newest_seq - seq) < (int32_t)jb->capacity) {
+            // Reordered ahead of the first frame during prefill - move the head back
+            jb->head_seq = seq;
+        } else {
+            // Arrived after its playout slot: the buffer is too shallow
+            jb->stats.late++;
+            grow_target_locked(jb);
+            return ESP_ERR_TIMEOUT;
+        }
+    } else if (offset >= (int32_t)jb->capacity) {
+        // Too far ahead: skip the head forward, dropping the oldest frames
+        uint16_t new_head = (uint16_t)(seq - jb->capacity + 1);
+        jb->stats.overflows += (uint16_t)(new_head - jb->head_seq);
+        jb->head_seq = new_head;
+    }
+
+    size_t index = seq & jb->mask;
+    jitter_slot_t *slot = &jb->slots[index];
+    if (slot->valid && slot->seq == seq) {
+        jb->stats.duplicates++;
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    clear_slot_locked(slot);  // Stale frame left behind by a head skip
+    frame_pool_ref(frame);
+    slot->frame = frame;
+    slot->seq = seq;
+    slot->timestamp = timestamp;
+    slot->valid = true;
+
+    if ((int16_t)(seq - jb->newest_seq) > 0) {
+        jb->newest_seq = seq;
+    }
+    jb->stats.received++;
+    return ESP_OK;
+}
+
+esp_err_t jitter_buffer_put(jitter_buffer_t *jb, uint16_t seq, uint32_t timestamp, int64_t arrival_us,
+                            audio_frame_t *frame) {
+    if (!jb) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&jb->lock);
+    esp_err_t ret = put_locked(jb, seq, timestamp, arrival_us, frame);
+    portEXIT_CRITICAL(&jb->lock);
+    return ret;
+}
+
+size_t jitter_buffer_put_batch(jitter_buffer_t *jb, const jitter_buffer_entry_t *entries, size_t count,
+                               esp_err_t *results) {
+    if (!jb || !entries) return 0;
+    size_t stored = 0;
+    portENTER_CRITICAL(&jb->lock);
+    for (size_t i = 0; i < count; i++) {
+        esp_err_t ret = put_locked(jb, entries[i].seq, entries[i].timestamp, entries[i].arrival_us,
+                                   entries[i].frame);
+        if (ret == ESP_OK) stored++;
+        if (results) results[i] = ret;
+    }
+    portEXIT_CRITICAL(&jb->lock);
+    return stored;
+}
+
+esp_err_t jitter_buffer_get(jitter_buffer_t *jb, audio_frame_t **frame) {
+    if (!jb || !frame) return ESP_ERR_INVALID_ARG;
+    *frame = NULL;
+
+    esp_err_t ret;
+    bool started_playing = false;
+    size_t started_depth = 0;
+    portENTER_CRITICAL(&jb->lock);
+
+    size_t depth = depth_locked(jb);
+    if (jb->frame_us) {
+        adapt_target_locked(jb, depth);
+    }
+
+    if (!jb->playing) {
+        if (!jb->started || depth < jb->target) {
+            portEXIT_CRITICAL(&jb->lock);
+            return ESP_ERR_INVALID_STATE;
+        }
+        jb->playing = true;
+        started_playing = true;
+        started_depth = depth;
+        jb->avg_depth_q8 = depth << 8;
+    }
+
+    if (depth == 0) {
+        // Nothing buffered - keep the playout clock running so late frames are discarded,
+        // and give up on the stream after a full buffer's worth of empty slots
+        jb->stats.underruns++;
+        if (jb->empty_run == 0) {
+            grow_target_locked(jb);
+        }
+        jb->head_seq++;
+        if (++jb->empty_run >= jb->capacity) {
+            restart_locked(jb);
+        }
+        ret = ESP_ERR_NOT_FOUND;
+        goto out;
+    }
+    jb->empty_run = 0;
+
+    // Shrink: buffer consistently drop_margin+ frames deeper than needed - drop the head frame
+    if (jb->frame_us && jb->drop_margin && depth > 1 &&
+        jb->avg_depth_q8 > ((jb->target + jb->drop_margin) << 8) &&
+        jb->gets_since_drop >= JITTER_DROP_INTERVAL) {
+        clear_slot_locked(&jb->slots[jb->head_seq & jb->mask]);
+        jb->head_seq++;
+        jb->gets_since_drop = 0;
+        jb->stats.drops++;
+    }
+
+    size_t index = jb->head_seq & jb->mask;
+    jitter_slot_t *slot = &jb->slots[index];
+    if (slot->valid && slot->seq == jb->head_seq) {
+        *frame = slot->frame;  // Hand the slot's reference to the caller
+        slot->frame = NULL;
+        slot->valid = false;
+        jb->head_seq++;
+        jb->stats.played++;
+        ret = ESP_OK;
+    } else if (jb->frame_us && depth < jb->target) {
+        // Grow: hold the head on the missing frame so it can still arrive
+        jb->stats.holds++;
+        ret = ESP_ERR_NOT_FOUND;
+    } else {
+        jb->head_seq++;
+        jb->stats.missing++;
+        ret = ESP_ERR_NOT_FOUND;
+    }
+
+out:
+    portEXIT_CRITICAL(&jb->lock);
+
+    if (started_playing) {
+        ESP_LOGI(TAG, "Prefilled (%u frames), starting playout", started_depth);
+    }
+    return ret;
+}
+
+size_t jitter_buffer_depth(jitter_buffer_t *jb) {
+    if (!jb) return 0;
+    portENTER_CRITICAL(&jb->lock);
+    size_t depth = depth_locked(jb);
+    portEXIT_CRITICAL(&jb->lock);
+    return depth;
+}
+
+void jitter_buffer_get_stats(jitter_buffer_t *jb, jitter_buffer_stats_t *stats) {
+    if (!jb || !stats) return;
+    portENTER_CRITICAL(&jb->lock);
+    *stats = jb->stats;
+    stats->depth = depth_locked(jb);
+    stats->target_depth = jb->target;
+    stats->jitter_us = (uint32_t)jb->jitter_us;
+    portEXIT_CRITICAL(&jb->lock);
+}
@@ -0,0 +1,124 @@
+#include "audio/level_meter.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct level_meter_t {
+    level_meter_config_t config;
+    level_meter_reading_t reading;
+    uint32_t quiet_frames;       // Consecutive frames below off_rms while open
+};
+
+// floor(sqrt(v)), bit by bit: once per frame, no float
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+// 20*log10(rms / 32768) in whole dB: 6.02 dB per octave plus a 16-step
+// table for the mantissa (enough for a meter, avoids log10f per frame)
+static int32_t rms_to_dbfs(int32_t rms) {
+    static const uint8_t mantissa_tenths_db[16] = {
+        0, 5, 10, 15, 19, 24, 28, 32, 35, 39, 42, 45, 49, 52, 55, 57
+    };
+    if (rms <= 0) return -96;
+
+    int msb = 31 - __builtin_clz((uint32_t)rms);         // rms in [2^msb, 2^(msb+1))
+    int frac = (msb >= 4) ? ((rms >> (msb - 4)) & 0xF) : ((rms << (4 - msb)) & 0xF);
+    int32_t centi_db = (msb - 15) * 602 + mantissa_tenths_db[frac] * 10;
+    int32_t db = (centi_db - 50) / 100;                  // Round toward -inf for negatives
+    return db < -96 ? -96 : db;
+}
+
+level_meter_t* level_meter_create(const level_meter_config_t *config) {
+    if (!config || config->off_rms > config->on_rms) return NULL;
+
+    level_meter_t *meter = calloc(1, sizeof(level_meter_t));
+    if (!meter) return NULL;
+
+    meter->config = *config;
+    level_meter_reset(meter);
+    return meter;
+}
+
+void level_meter_destroy(level_meter_t *meter) {
+    free(meter);
+}
+
+void level_meter_reset(level_meter_t *meter) {
+    if (!meter) return;
+    memset(&meter->reading, 0, sizeof(meter->reading));
+    meter->reading.rms_dbfs = -96;
+    meter->quiet_frames = 0;
+}
+
+bool level_meter_process(level_meter_t *meter, const int16_t *samples, size_t num_samples) {
+    if (!meter || !samples || num_samples == 0) return false;
+
+    // Single pass; |x| <= 2^15 so x*x fits 32 bits, and the 32-bit sum holds a
+    // frame of any practical length (2^16 samples)
+    int32_t sum = 0;
+    uint64_t sum_sq = 0;
+    int32_t min = INT16_MAX, max = INT16_MIN;
+    size_t i = 0;
+    for (; i + 2 <= num_samples; i += 2) {
+        int32_t x0 = samples[i], x1 = samples[i + 1];
+        sum += x0 + x1;
+        sum_sq += (uint32_t)(x0 * x0) + (uint64_t)(uint32_t)(x1 * x1);
+        int32_t lo = x0 < x1 ? x0 : x1, hi = x0 < x1 ? x1 : x0;
+        min = lo < min ? lo : min;
+        max = hi > max ? hi : max;
+    }
+    for (; i < num_samples; i++) {
+        int32_t x = samples[i];
+        sum += x;
+        sum_sq += (uint32_t)(x * x);
+        min = x < min ? x : min;
+        max = x > max ? x : max;
+    }
+
+    // Variance = E[x^2] - E[x]^2, exact in integers: (n*sum_sq - sum^2) / n^2
+    int64_t n = (int64_t)num_samples;
+    int64_t var_n2 = n * (int64_t)sum_sq - (int64_t)sum * sum;
+    if (var_n2 < 0) var_n2 = 0;
+    int32_t dc = (int32_t)(sum / (int32_t)num_samples);
+    int32_t rms = (int32_t)(isqrt64((uint64_t)var_n2) / (uint32_t)num_samples);
+
+    level_meter_reading_t *r = &meter->reading;
+    r->dc = dc;
+    r->rms = rms;
+    r->peak = (max - dc > dc - min) ? (max - dc) : (dc - min);
+    r->rms_dbfs = rms_to_dbfs(rms);
+
+    // Hysteresis gate with hangover
+    if (!r->active) {
+        if (rms >= meter->config.on_rms) {
+            r->active = true;
+            r->gate_changes++;
+            meter->quiet_frames = 0;
+        }
+    } else if (rms < meter->config.off_rms) {
+        if (++meter->quiet_frames >= meter->config.hangover_frames) {
+            r->active = false;
+            r->gate_changes++;
+        }
+    } else {
+        meter->quiet_frames = 0;
+    }
+    return r->active;
+}
+
+void level_meter_get_reading(const level_meter_t *meter, level_meter_reading_t *reading) {
+    if (!meter || !reading) return;
+    *reading = meter->reading;
+}
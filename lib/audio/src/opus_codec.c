@@ -1,20 +1,89 @@
-// Placeholder - Opus codec removed for now to focus on improving raw PCM quality
 #include "audio/opus_codec.h"
+#include "config/build.h"
+#include <opus.h>
 #include <esp_log.h>
 
 static const char *TAG = "opus_codec";
 
-esp_err_t opus_codec_init(void) {
-    ESP_LOGI(TAG, "Opus codec placeholder - using raw PCM for now");
+// One encoder (TX/COMBO) and one decoder (RX) per node - mono, 48 kHz, 5ms frames
+static OpusEncoder *encoder = NULL;
+static OpusDecoder *decoder = NULL;
+
+esp_err_t opus_codec_encoder_init(void) {
+    if (encoder != NULL) {
+        ESP_LOGW(TAG, "Opus encoder already initialized");
+        return ESP_OK;
+    }
+
+    int err = OPUS_OK;
+
+    // RESTRICTED_LOWDELAY = CELT only, the only mode that supports 5ms frames
+    // and keeps algorithmic delay at 2.5ms
+    encoder = opus_encoder_create(AUDIO_SAMPLE_RATE, AUDIO_CHANNELS,
+                                  OPUS_APPLICATION_RESTRICTED_LOWDELAY, &err);
+    if (err != OPUS_OK || encoder == NULL) {
+        ESP_LOGE(TAG, "Failed to create Opus encoder: %s", opus_strerror(err));
+        encoder = NULL;
+        return ESP_FAIL;
+    }
+
+    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(OPUS_BITRATE_BPS));
+    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(OPUS_COMPLEXITY));
+    opus_encoder_ctl(encoder, OPUS_SET_SIGNAL(OPUS_SIGNAL_MUSIC));
+    // Constant bitrate keeps per-frame airtime predictable on the mesh
+    opus_encoder_ctl(encoder, OPUS_SET_VBR(0));
+
+    ESP_LOGI(TAG, "Opus encoder initialized: %d Hz, %d ms frames, %d bps, complexity %d (%d bytes)",
+             AUDIO_SAMPLE_RATE, AUDIO_FRAME_MS, OPUS_BITRATE_BPS, OPUS_COMPLEXITY,
+             opus_encoder_get_size(AUDIO_CHANNELS));
+    return ESP_OK;
+}
+
+esp_err_t opus_codec_decoder_init(void) {
+    if (decoder != NULL) {
+        ESP_LOGW(TAG, "Opus decoder already initialized");
+        return ESP_OK;
+    }
+
+    int err = OPUS_OK;
+    decoder = opus_decoder_create(AUDIO_SAMPLE_RATE, AUDIO_CHANNELS, &err);
+    if (err != OPUS_OK || decoder == NULL) {
+        ESP_LOGE(TAG, "Failed to create Opus decoder: %s", opus_strerror(err));
+        decoder = NULL;
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Opus decoder initialized: %d Hz, %d ms frames (%d bytes)",
+             AUDIO_SAMPLE_RATE, AUDIO_FRAME_MS, opus_decoder_get_size(AUDIO_CHANNELS));
     return ESP_OK;
 }
 
 esp_err_t opus_codec_encode(const int16_t *pcm_data, int pcm_samples, uint8_t *opus_data, int *opus_len) {
-    // Placeholder - just return error to use raw PCM
-    return ESP_FAIL;
+    if (encoder == NULL) return ESP_ERR_INVALID_STATE;
+    if (!pcm_data || !opus_data || !opus_len) return ESP_ERR_INVALID_ARG;
+
+    opus_int32 ret = opus_encode(encoder, pcm_data, pcm_samples, opus_data, OPUS_MAX_FRAME_BYTES);
+    if (ret < 0) {
+        ESP_LOGW(TAG, "Opus encode failed: %s", opus_strerror(ret));
+        *opus_len = 0;
+        return ESP_FAIL;
+    }
+
+    *opus_len = (int)ret;
+    return ESP_OK;
 }
 
 esp_err_t opus_codec_decode(const uint8_t *opus_data, int opus_len, int16_t *pcm_data, int *pcm_samples) {
-    // Placeholder - just return error to use raw PCM
-    return ESP_FAIL;
+    if (decoder == NULL) return ESP_ERR_INVALID_STATE;
+    if (!opus_data || !pcm_data || !pcm_samples) return ESP_ERR_INVALID_ARG;
+
+    int ret = opus_decode(decoder, opus_data, opus_len, pcm_data, AUDIO_FRAME_SAMPLES, 0);
+    if (ret < 0) {
+        ESP_LOGW(TAG, "Opus decode failed: %s", opus_strerror(ret));
+        *pcm_samples = 0;
+        return ESP_FAIL;
+    }
+
+    *pcm_samples = ret;
+    return ESP_OK;
 }
@@ -0,0 +1,225 @@
+#include "audio/pcm_convert.h"
+#include <sdkconfig.h>
+#include <stdint.h>
+
+// Word-wise packed-24 kernels: 4 samples <-> 3 little-endian 32-bit words.
+// The LX7 has no unaligned word access, so they only run when the packed
+// buffer is 4-byte aligned (frame payloads are); the scalar loop handles
+// misaligned buffers and the tail.
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && !defined(PCM_CONVERT_SCALAR)
+#define PCM_CONVERT_WORDWISE 1
+#else
+#define PCM_CONVERT_WORDWISE 0
+#endif
+
+#if PCM_CONVERT_WORDWISE
+typedef uint32_t __attribute__((may_alias)) pcm_word_t;
+
+#define PCM_ALIGNED4(p) ((((uintptr_t)(p)) & 3) == 0)
+
+static inline void store_words(uint8_t *p, uint32_t w0, uint32_t w1, uint32_t w2) {
+    pcm_word_t *w = (pcm_word_t *)p;
+    w[0] = w0;
+    w[1] = w1;
+    w[2] = w2;
+}
+
+// Packs four 24-bit values (upper byte ignored)
+static inline void pack4(uint8_t *p, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    store_words(p, (a & 0xFFFFFF) | (b << 24),
+                   ((b >> 8) & 0xFFFF) | (c << 16),
+                   ((c >> 16) & 0xFF) | (d << 8));
+}
+
+// Unpacks four samples left-justified (low byte zero); >> 8 sign-extends to i24
+static inline void unpack4_s32(const uint8_t *p, int32_t *q) {
+    const pcm_word_t *w = (const pcm_word_t *)p;
+    uint32_t w0 = w[0], w1 = w[1], w2 = w[2];
+    q[0] = (int32_t)(w0 << 8);
+    q[1] = (int32_t)(((w1 << 16) | (w0 >> 16)) & 0xFFFFFF00u);
+    q[2] = (int32_t)(((w2 << 24) | (w1 >> 8)) & 0xFFFFFF00u);
+    q[3] = (int32_t)(w2 & 0xFFFFFF00u);
+}
+#endif
+
+static inline void s24_store(int32_t s24, uint8_t *out) {
+    out[0] = (uint8_t)(s24 & 0xFF);
+    out[1] = (uint8_t)((s24 >> 8) & 0xFF);
+    out[2] = (uint8_t)((s24 >> 16) & 0xFF);
+}
+
+static inline int32_t s24_load(const uint8_t *in) {
+    int32_t s24 = (int32_t)in[0] | ((int32_t)in[1] << 8) | ((int32_t)in[2] << 16);
+    return (int32_t)((uint32_t)s24 << 8) >> 8;  // Sign-extend from bit 23
+}
+
+static inline int32_t saturate(float v, float max) {
+    if (v >= max) return (int32_t)max - 1;
+    if (v < -max) return -(int32_t)max;
+    return (int32_t)(v + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+void pcm_s16_to_s24(const int16_t *in, size_t samples, uint8_t *out) {
+    size_t i = 0;
+#if PCM_CONVERT_WORDWISE
+    if (PCM_ALIGNED4(out)) {
+        for (; i + 4 <= samples; i += 4) {
+            // Low byte of every sample is zero, so each word is two shifted inputs
+            uint32_t a = (uint16_t)in[i], b = (uint16_t)in[i + 1];
+            uint32_t c = (uint16_t)in[i + 2], d = (uint16_t)in[i + 3];
+            store_words(out + i * 3, a << 8, b | (c << 24), (c >> 8) | (d << 16));
+        }
+    }
+#endif
+    for (; i < samples; i++) {
+        s24_store((int32_t)in[i] << 8, out + i * 3);  // 16→24 bit zero-pad LSBs
+    }
+}
+
+void pcm_s24_to_s16(const uint8_t *in, size_t samples, int16_t *out) {
+    size_t i = 0;
+#if PCM_CONVERT_WORDWISE
+    if (PCM_ALIGNED4(in)) {
+        for (; i + 4 <= samples; i += 4) {
+            const pcm_word_t *w = (const pcm_word_t *)(in + i * 3);
+            uint32_t w0 = w[0], w1 = w[1], w2 = w[2];
+            out[i] = (int16_t)(w0 >> 8);
+            out[i + 1] = (int16_t)w1;
+            out[i + 2] = (int16_t)((w1 >> 24) | (w2 << 8));
+            out[i + 3] = (int16_t)(w2 >> 16);
+        }
+    }
+#endif
+    for (; i < samples; i++) {
+        out[i] = (int16_t)(in[i * 3 + 1] | (in[i * 3 + 2] << 8));  // Drop 8 LSBs
+    }
+}
+
+void pcm_s24_to_i24(const uint8_t *in, size_t samples, int32_t *out) {
+    size_t i = 0;
+#if PCM_CONVERT_WORDWISE
+    if (PCM_ALIGNED4(in)) {
+        for (; i + 4 <= samples; i += 4) {
+            unpack4_s32(in + i * 3, out + i);
+            out[i] >>= 8;
+            out[i + 1] >>= 8;
+            out[i + 2] >>= 8;
+            out[i + 3] >>= 8;
+        }
+    }
+#endif
+    for (; i < samples; i++) {
+        out[i] = s24_load(in + i * 3);
+    }
+}
+
+void pcm_i24_to_s24(const int32_t *in, size_t samples, uint8_t *out) {
+    size_t i = 0;
+#if PCM_CONVERT_WORDWISE
+    if (PCM_ALIGNED4(out)) {
+        for (; i + 4 <= samples; i += 4) {
+            pack4(out + i * 3, (uint32_t)in[i], (uint32_t)in[i + 1], (uint32_t)in[i + 2], (uint32_t)in[i + 3]);
+        }
+    }
+#endif
+    for (; i < samples; i++) {
+        s24_store(in[i], out + i * 3);
+    }
+}
+
+void pcm_s24_to_s32(const uint8_t *in, size_t samples, int32_t *out) {
+    size_t i = 0;
+#if PCM_CONVERT_WORDWISE
+    if (PCM_ALIGNED4(in)) {
+        for (; i + 4 <= samples; i += 4) {
+            unpack4_s32(in + i * 3, out + i);
+        }
+    }
+#endif
+    for (; i < samples; i++) {
+        out[i] = (int32_t)((uint32_t)s24_load(in + i * 3) << 8);
+    }
+}
+
+void pcm_s32_to_s24(const int32_t *in, size_t samples, uint8_t *out) {
+    size_t i = 0;
+#if PCM_CONVERT_WORDWISE
+    if (PCM_ALIGNED4(out)) {
+        for (; i + 4 <= samples; i += 4) {
+            pack4(out + i * 3, (uint32_t)in[i] >> 8, (uint32_t)in[i + 1] >> 8,
+                  (uint32_t)in[i + 2] >> 8, (uint32_t)in[i + 3] >> 8);
+        }
+    }
+#endif
+    for (; i < samples; i++) {
+        s24_store(in[i] >> 8, out + i * 3);
+    }
+}
+
+void pcm_s16_to_f32(const int16_t *in, size_t samples, float *out) {
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = (float)in[i] * (1.0f / 32768.0f);
+    }
+}
+
+void pcm_f32_to_s16(const float *in, size_t samples, int16_t *out) {
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = (int16_t)saturate(in[i] * 32768.0f, 32768.0f);
+    }
+}
+
+void pcm_i24_to_f32(const int32_t *in, size_t samples, float *out) {
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = (float)in[i] * (1.0f / 8388608.0f);
+    }
+}
+
+void pcm_f32_to_i24(const float *in, size_t samples, int32_t *out) {
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = saturate(in[i] * 8388608.0f, 8388608.0f);
+    }
+}
+
+void pcm_s16_stereo_to_mono(const int16_t *in_lr, size_t frames, int16_t *out) {
+    for (size_t i = 0; i < frames; i++) {
+        out[i] = (int16_t)(((int32_t)in_lr[i * 2] + (int32_t)in_lr[i * 2 + 1]) >> 1);
+    }
+}
+
+void pcm_s16_mono_to_stereo(const int16_t *in, size_t frames, int16_t *out_lr) {
+    // Backwards so in and out_lr may share a buffer
+    for (size_t i = frames; i-- > 0;) {
+        int16_t s = in[i];
+        out_lr[i * 2] = s;
+        out_lr[i * 2 + 1] = s;
+    }
+}
+
+void pcm_s16_stereo_to_s24_mono(const int16_t *in_lr, size_t frames, uint8_t *out) {
+    size_t i = 0;
+#if PCM_CONVERT_WORDWISE
+    if (PCM_ALIGNED4(out)) {
+        for (; i + 4 <= frames; i += 4) {
+            const int16_t *p = in_lr + i * 2;
+            uint32_t m0 = (uint32_t)(((int32_t)p[0] + p[1]) >> 1) & 0xFFFF;
+            uint32_t m1 = (uint32_t)(((int32_t)p[2] + p[3]) >> 1) & 0xFFFF;
+            uint32_t m2 = (uint32_t)(((int32_t)p[4] + p[5]) >> 1) & 0xFFFF;
+            uint32_t m3 = (uint32_t)(((int32_t)p[6] + p[7]) >> 1) & 0xFFFF;
+            store_words(out + i * 3, m0 << 8, m1 | (m2 << 24), (m2 >> 8) | (m3 << 16));
+        }
+    }
+#endif
+    for (; i < frames; i++) {
+        // Mono = average L+R (simple downmix)
+        int32_t m = ((int32_t)in_lr[i * 2] + (int32_t)in_lr[i * 2 + 1]) >> 1;
+        s24_store(m << 8, out + i * 3);
+    }
+}
+
+void pcm_i24_mono_to_s16_stereo(const int32_t *in, size_t frames, int16_t *out_lr) {
+    for (size_t i = 0; i < frames; i++) {
+        int16_t s16 = (int16_t)(in[i] >> 8);
+        out_lr[i * 2] = s16;
+        out_lr[i * 2 + 1] = s16;
+    }
+}
@@ -0,0 +1,160 @@
+#include "audio/plc.h"
+#include "config/build.h"
+#include <math.h>
+#include <string.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+static const char *TAG = "plc";
+
+// Pitch search: the last PLC_TEMPLATE samples are matched against history one
+// period back, coarse on every 4th lag/sample, then refined around the best lag
+#define PLC_HISTORY       (3 * AUDIO_FRAME_SAMPLES)  // 15ms
+#define PLC_TEMPLATE      120   // 2.5ms
+#define PLC_MIN_PITCH     48    // 1 kHz
+#define PLC_MAX_PITCH     480   // 100 Hz (MAX_PITCH + MAX_PITCH/4 must fit in history)
+#define PLC_COARSE_STEP   4
+
+// Level: full for the first 10ms of a loss run, then a linear fade to silence over 40ms
+#define PLC_HOLD_FRAMES   2
+#define PLC_FADE_FRAMES   8
+#define PLC_XFADE_SAMPLES 96    // 2ms cross-fade back into real audio
+
+#define Q15_ONE           32768
+
+static int32_t history[PLC_HISTORY];      // Most recent output, oldest first
+static int32_t pitch_buf[PLC_MAX_PITCH];  // One period, loop point smoothed
+static size_t pitch_len = PLC_MAX_PITCH;
+static size_t pitch_pos = 0;
+static uint32_t lost_run = 0;             // Consecutive concealed frames
+static plc_stats_t stats = {0};
+
+esp_err_t plc_init(void) {
+    plc_reset();
+    memset(&stats, 0, sizeof(stats));
+    ESP_LOGI(TAG, "PLC initialized: pitch %d-%d samples, fade after %dms",
+             PLC_MIN_PITCH, PLC_MAX_PITCH, PLC_HOLD_FRAMES * AUDIO_FRAME_MS);
+    return ESP_OK;
+}
+
+void plc_reset(void) {
+    memset(history, 0, sizeof(history));
+    pitch_len = PLC_MAX_PITCH;
+    pitch_pos = 0;
+    lost_run = 0;
+}
+
+static void push_history(const int32_t *samples) {
+    memmove(history, history + AUDIO_FRAME_SAMPLES, (PLC_HISTORY - AUDIO_FRAME_SAMPLES) * sizeof(int32_t));
+    memcpy(history + PLC_HISTORY - AUDIO_FRAME_SAMPLES, samples, AUDIO_FRAME_SAMPLES * sizeof(int32_t));
+}
+
+// Normalized correlation (up to scale) of template a against candidate b
+static float match_score(const int32_t *a, const int32_t *b, size_t step) {
+    int64_t corr = 0;
+    int64_t energy = 0;
+    for (size_t i = 0; i < PLC_TEMPLATE; i += step) {
+        int32_t x = a[i] >> 8;  // 16-bit precision is plenty for matching
+        int32_t y = b[i] >> 8;
+        corr += (int64_t)x * y;
+        energy += (int64_t)y * y;
+    }
+    if (corr <= 0 || energy == 0) return 0.0f;
+    return (float)corr / sqrtf((float)energy);
+}
+
+static size_t find_pitch(void) {
+    const int32_t *tmpl = history + PLC_HISTORY - PLC_TEMPLATE;
+    size_t best = PLC_MAX_PITCH;
+    float best_score = 0.0f;
+
+    for (size_t p = PLC_MIN_PITCH; p <= PLC_MAX_PITCH; p += PLC_COARSE_STEP) {
+        float score = match_score(tmpl, tmpl - p, PLC_COARSE_STEP);
+        if (score > best_score) {
+            best_score = score;
+            best = p;
+        }
+    }
+
+    size_t lo = (best > PLC_MIN_PITCH + PLC_COARSE_STEP) ? best - PLC_COARSE_STEP + 1 : PLC_MIN_PITCH;
+    size_t hi = (best + PLC_COARSE_STEP - 1 < PLC_MAX_PITCH) ? best + PLC_COARSE_STEP - 1 : PLC_MAX_PITCH;
+    best_score = 0.0f;
+    for (size_t p = lo; p <= hi; p++) {
+        float score = match_score(tmpl, tmpl - p, 1);
+        if (score > best_score) {
+            best_score = score;
+            best = p;
+        }
+    }
+    // No positive match (silence/noise): repeating the longest period is least buzzy
+    return best;
+}
+
+// Copy the last period and overlap-add its final quarter with the samples that
+// lead into its start, so repeating it has no discontinuity at the loop point
+static void build_pitch_buffer(size_t pitch) {
+    const int32_t *period = history + PLC_HISTORY - pitch;
+    size_t ola = pitch / 4;
+    const int32_t *lead = period - ola;
+
+    memcpy(pitch_buf, period, pitch * sizeof(int32_t));
+    for (size_t i = 0; i < ola; i++) {
+        int32_t w = (int32_t)((i + 1) * Q15_ONE / (ola + 1));
+        int32_t tail = pitch_buf[pitch - ola + i];
+        pitch_buf[pitch - ola + i] = tail + (int32_t)(((int64_t)(lead[i] - tail) * w) >> 15);
+    }
+    pitch_len = pitch;
+    pitch_pos = 0;
+}
+
+// Concealment level at the start of lost frame n (0-based) of a run
+static int32_t level_q15(uint32_t n) {
+    if (n <= PLC_HOLD_FRAMES) return Q15_ONE;
+    uint32_t faded = n - PLC_HOLD_FRAMES;
+    if (faded >= PLC_FADE_FRAMES) return 0;
+    return Q15_ONE - (int32_t)(faded * Q15_ONE / PLC_FADE_FRAMES);
+}
+
+void plc_conceal(int32_t *samples) {
+    int64_t start_us = esp_timer_get_time();
+
+    if (lost_run == 0) {
+        build_pitch_buffer(find_pitch());
+    }
+
+    // Ramp the level across the frame so the fade has no steps
+    int32_t g0 = level_q15(lost_run);
+    int32_t g1 = level_q15(lost_run + 1);
+    for (size_t i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
+        int32_t g = g0 + (int32_t)((int64_t)(g1 - g0) * (int32_t)i / AUDIO_FRAME_SAMPLES);
+        samples[i] = (int32_t)(((int64_t)pitch_buf[pitch_pos] * g) >> 15);
+        if (++pitch_pos >= pitch_len) pitch_pos = 0;
+    }
+
+    lost_run++;
+    stats.concealed++;
+    push_history(samples);
+
+    uint32_t cost_us = (uint32_t)(esp_timer_get_time() - start_us);
+    if (cost_us > stats.max_conceal_us) stats.max_conceal_us = cost_us;
+}
+
+void plc_good_frame(int32_t *samples) {
+    if (lost_run > 0) {
+        // Cross-fade from the synthetic continuation into the real frame
+        int32_t g = level_q15(lost_run);
+        for (size_t i = 0; i < PLC_XFADE_SAMPLES; i++) {
+            int32_t synth = (int32_t)(((int64_t)pitch_buf[pitch_pos] * g) >> 15);
+            if (++pitch_pos >= pitch_len) pitch_pos = 0;
+            int32_t w = (int32_t)((i + 1) * Q15_ONE / (PLC_XFADE_SAMPLES + 1));
+            samples[i] = synth + (int32_t)(((int64_t)(samples[i] - synth) * w) >> 15);
+        }
+        lost_run = 0;
+        stats.resumed++;
+    }
+    push_history(samples);
+}
+
+void plc_get_stats(plc_stats_t *out) {
+    if (out) *out = stats;
+}
@@ -0,0 +1,215 @@
+#include "audio/resampler.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+
+static const char *TAG = "resampler";
+
+#define RS_COEF_SHIFT     15
+#define RS_STOP_DB        85.0                   // Kaiser design target; Q15 taps floor it near 80
+#define RS_PASS_MAX_HZ    20000.0
+
+struct resampler_t {
+    uint32_t in_rate;
+    uint32_t L;                 // Interpolation factor (phases)
+    uint32_t M;                 // Decimation factor
+    uint32_t step_int;          // M / L
+    uint32_t step_frac;         // M % L
+    size_t channels;
+    size_t taps;                // T, per phase; even
+    size_t max_in_frames;
+    int16_t *coefs;             // [L][T], oldest input first
+    int16_t *work;              // [T + max_in] frames: history, then this call's input
+    uint32_t phase;             // Position of the next output between inputs, in 1/L
+};
+
+static uint32_t gcd_u32(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Zeroth-order modified Bessel function, for the Kaiser window
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < 1e-12 * sum) break;
+    }
+    return sum;
+}
+
+// Prototype at L*in_rate, length L*T, split so phase p tap k multiplies x[i-k]
+// and stored reversed (oldest first) to match the work buffer order
+static void design(resampler_t *rs, double pass_hz, double stop_hz) {
+    const size_t L = rs->L, T = rs->taps, N = L * T;
+    const double fs = (double)rs->in_rate * L;
+    const double fc = (pass_hz + stop_hz) / 2.0 / fs;         // Cycles per prototype sample
+    const double beta = 0.1102 * (RS_STOP_DB - 8.7);
+    const double centre = (N - 1) / 2.0;
+    const double i0_beta = bessel_i0(beta);
+
+    double *phase_taps = malloc(T * sizeof(double));
+    for (size_t p = 0; p < L; p++) {
+        double sum = 0.0;
+        for (size_t k = 0; k < T; k++) {
+            double n = (double)(p + k * L) - centre;
+            double sinc = (n == 0.0) ? 2.0 * fc : sin(2.0 * M_PI * fc * n) / (M_PI * n);
+            double r = n / (centre + 0.5);
+            double w = bessel_i0(beta * sqrt(fmax(0.0, 1.0 - r * r))) / i0_beta;
+            phase_taps[k] = sinc * w;
+            sum += phase_taps[k];
+        }
+        // Unity DC gain per phase: no phase-dependent ripple at low frequencies
+        int16_t *row = rs->coefs + p * T;
+        for (size_t k = 0; k < T; k++) {
+            row[T - 1 - k] = (int16_t)lrint(phase_taps[k] / sum * (1 << RS_COEF_SHIFT));
+        }
+    }
+    free(phase_taps);
+}
+
+resampler_t* resampler_create(uint32_t in_rate, uint32_t out_rate, size_t channels, size_t max_out_frames) {
+    if (in_rate == 0 || out_rate == 0 || channels == 0 || max_out_frames == 0) return NULL;
+
+    uint32_t g = gcd_u32(in_rate, out_rate);
+    uint32_t L = out_rate / g, M = in_rate / g;
+    if (L > RESAMPLER_MAX_PHASES) {
+        ESP_LOGE(TAG, "Ratio %lu/%lu needs %lu phases", out_rate, in_rate, L);
+        return NULL;
+    }
+
+    resampler_t *rs = calloc(1, sizeof(resampler_t));
+    if (!rs) return NULL;
+    rs->in_rate = in_rate;
+    rs->L = L;
+    rs->M = M;
+    rs->step_int = M / L;
+    rs->step_frac = M % L;
+    rs->channels = channels;
+
+    if (L == M) {
+        // Pass-through: no table, process copies
+        rs->taps = 0;
+        rs->max_in_frames = max_out_frames;
+        return rs;
+    }
+
+    // Band edges: the lower of the two Nyquists bounds the passband; content
+    // past stop_hz would fold back below pass_hz
+    double low = (in_rate < out_rate) ? in_rate : out_rate;
+    double pass_hz = fmin(RS_PASS_MAX_HZ, 0.45 * low);
+    double stop_hz = low - pass_hz;
+    // Kaiser length estimate, in input samples per phase, rounded up to even
+    size_t taps = (size_t)ceil((RS_STOP_DB - 7.95) / (2.285 * 2.0 * M_PI * (stop_hz - pass_hz) / in_rate));
+    rs->taps = (taps + 1) & ~(size_t)1;
+    rs->max_in_frames = (size_t)(((uint64_t)max_out_frames * M + L - 1) / L) + 1;
+
+    rs->coefs = malloc((size_t)L * rs->taps * sizeof(int16_t));
+    rs->work = malloc((rs->taps + rs->max_in_frames) * channels * sizeof(int16_t));
+    if (!rs->coefs || !rs->work) {
+        resampler_destroy(rs);
+        return NULL;
+    }
+    design(rs, pass_hz, stop_hz);
+    resampler_reset(rs);
+
+    ESP_LOGI(TAG, "%lu -> %lu Hz: %lu/%lu, %u taps x %lu phases, pass %.0f Hz",
+             in_rate, out_rate, L, M, (unsigned)rs->taps, L, pass_hz);
+    return rs;
+}
+
+void resampler_destroy(resampler_t *rs) {
+    if (!rs) return;
+    free(rs->coefs);
+    free(rs->work);
+    free(rs);
+}
+
+void resampler_reset(resampler_t *rs) {
+    if (!rs) return;
+    rs->phase = 0;
+    if (rs->work) {
+        memset(rs->work, 0, rs->taps * rs->channels * sizeof(int16_t));
+    }
+}
+
+uint32_t resampler_in_rate(const resampler_t *rs) {
+    return rs ? rs->in_rate : 0;
+}
+
+size_t resampler_taps(const resampler_t *rs) {
+    return rs ? rs->taps : 0;
+}
+
+size_t resampler_input_needed(const resampler_t *rs, size_t out_frames) {
+    if (!rs) return 0;
+    return (size_t)(((uint64_t)rs->phase + (uint64_t)out_frames * rs->M) / rs->L);
+}
+
+static inline int16_t narrow(int32_t acc) {
+    acc = (acc + (1 << (RS_COEF_SHIFT - 1))) >> RS_COEF_SHIFT;
+    if (acc > INT16_MAX) return INT16_MAX;
+    if (acc < INT16_MIN) return INT16_MIN;
+    return (int16_t)acc;
+}
+
+size_t resampler_process(resampler_t *rs, const int16_t *in, size_t in_frames,
+                         int16_t *out, size_t out_frames) {
+    if (!rs || !in || !out) return 0;
+    if (in_frames != resampler_input_needed(rs, out_frames) || in_frames > rs->max_in_frames) return 0;
+
+    const size_t ch = rs->channels;
+    if (rs->taps == 0) {
+        memcpy(out, in, out_frames * ch * sizeof(int16_t));
+        return out_frames;
+    }
+
+    // History (T frames) then the new input. Output n uses the T frames before
+    // input index floor(t/L), one input of latency so it never reads ahead.
+    const size_t T = rs->taps;
+    int16_t *work = rs->work;
+    memcpy(work + T * ch, in, in_frames * ch * sizeof(int16_t));
+
+    uint32_t phase = rs->phase;
+    size_t base = 0;                                   // floor(t/L) relative to this call
+    for (size_t n = 0; n < out_frames; n++) {
+        const int16_t *h = rs->coefs + (size_t)phase * T;
+        const int16_t *x = work + base * ch;
+        if (ch == 2) {
+            int32_t acc_l = 0, acc_r = 0;
+            for (size_t k = 0; k < T; k += 2) {
+                acc_l += h[k] * x[2 * k] + h[k + 1] * x[2 * k + 2];
+                acc_r += h[k] * x[2 * k + 1] + h[k + 1] * x[2 * k + 3];
+            }
+            out[0] = narrow(acc_l);
+            out[1] = narrow(acc_r);
+        } else {
+            for (size_t c = 0; c < ch; c++) {
+                int32_t acc = 0;
+                for (size_t k = 0; k < T; k++) {
+                    acc += h[k] * x[k * ch + c];
+                }
+                out[c] = narrow(acc);
+            }
+        }
+        out += ch;
+
+        base += rs->step_int;
+        phase += rs->step_frac;
+        if (phase >= rs->L) {
+            phase -= rs->L;
+            base++;
+        }
+    }
+    rs->phase = phase;
+
+    // Keep the last T frames as history for the next call
+    memmove(work, work + in_frames * ch, T * ch * sizeof(int16_t));
+    return out_frames;
+}
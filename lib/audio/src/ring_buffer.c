@@ -1,69 +1,145 @@
 #include "audio/ring_buffer.h"
-#include <freertos/FreeRTOS.h>
-#include <freertos/ringbuf.h>
-#include <esp_log.h>
+#include <stdatomic.h>
+#include <stdlib.h>
 #include <string.h>
+#include <esp_log.h>
 
 static const char *TAG = "ring_buffer";
 
+// Indices run over [0, 2 * capacity) so full (distance == capacity) and empty
+// (distance == 0) are distinct without a wasted byte, and any capacity works
+// (e.g. a whole number of 720-byte frames). Each index is written by one side
+// only: release on publish, acquire on the other side's read.
 struct ring_buffer_t {
-    RingbufHandle_t handle;
+    uint8_t *buffer;
+    size_t capacity;
+    _Atomic size_t write_idx;  // Producer-owned
+    _Atomic size_t read_idx;   // Consumer-owned
 };
 
+static inline size_t ring_used(const ring_buffer_t *rb, size_t w, size_t r) {
+    return (w >= r) ? w - r : w + 2 * rb->capacity - r;
+}
+
+static inline size_t ring_offset(const ring_buffer_t *rb, size_t idx) {
+    return (idx >= rb->capacity) ? idx - rb->capacity : idx;
+}
+
+static inline size_t ring_advance(const ring_buffer_t *rb, size_t idx, size_t n) {
+    idx += n;
+    return (idx >= 2 * rb->capacity) ? idx - 2 * rb->capacity : idx;
+}
+
 ring_buffer_t* ring_buffer_create(size_t size) {
-    ring_buffer_t *rb = malloc(sizeof(ring_buffer_t));
+    if (size == 0) return NULL;
+
+    ring_buffer_t *rb = calloc(1, sizeof(ring_buffer_t));
     if (!rb) return NULL;
-    
-    rb->handle = xRingbufferCreate(size, RINGBUF_TYPE_BYTEBUF);
-    if (!rb->handle) {
+
+    rb->buffer = malloc(size);
+    if (!rb->buffer) {
         free(rb);
         return NULL;
     }
-    
+    rb->capacity = size;
+    atomic_init(&rb->write_idx, 0);
+    atomic_init(&rb->read_idx, 0);
+
     ESP_LOGI(TAG, "Ring buffer created: %u bytes", size);
     return rb;
 }
 
 void ring_buffer_destroy(ring_buffer_t *rb) {
     if (rb) {
-        if (rb->handle) {
-            vRingbufferDelete(rb->handle);
-        }
+        free(rb->buffer);
         free(rb);
     }
 }
 
+uint8_t* ring_buffer_reserve(ring_buffer_t *rb, size_t len, size_t *granted) {
+    if (!rb || !granted) return NULL;
+
+    size_t w = atomic_load_explicit(&rb->write_idx, memory_order_relaxed);
+    size_t r = atomic_load_explicit(&rb->read_idx, memory_order_acquire);
+    size_t space = rb->capacity - ring_used(rb, w, r);
+    size_t off = ring_offset(rb, w);
+    size_t contiguous = rb->capacity - off;
+
+    size_t n = len;
+    if (n > space) n = space;
+    if (n > contiguous) n = contiguous;
+    *granted = n;
+    return n ? rb->buffer + off : NULL;
+}
+
+void ring_buffer_commit(ring_buffer_t *rb, size_t len) {
+    if (!rb || len == 0) return;
+    size_t w = atomic_load_explicit(&rb->write_idx, memory_order_relaxed);
+    atomic_store_explicit(&rb->write_idx, ring_advance(rb, w, len), memory_order_release);
+}
+
+const uint8_t* ring_buffer_peek(ring_buffer_t *rb, size_t *len) {
+    if (!rb || !len) return NULL;
+
+    size_t r = atomic_load_explicit(&rb->read_idx, memory_order_relaxed);
+    size_t w = atomic_load_explicit(&rb->write_idx, memory_order_acquire);
+    size_t used = ring_used(rb, w, r);
+    size_t off = ring_offset(rb, r);
+    size_t contiguous = rb->capacity - off;
+
+    *len = (used < contiguous) ? used : contiguous;
+    return *len ? rb->buffer + off : NULL;
+}
+
+void ring_buffer_release(ring_buffer_t *rb, size_t len) {
+    if (!rb || len == 0) return;
+    size_t r = atomic_load_explicit(&rb->read_idx, memory_order_relaxed);
+    atomic_store_explicit(&rb->read_idx, ring_advance(rb, r, len), memory_order_release);
+}
+
 esp_err_t ring_buffer_write(ring_buffer_t *rb, const uint8_t *data, size_t len) {
-    if (!rb || !rb->handle) return ESP_ERR_INVALID_ARG;
-    
-    if (xRingbufferSend(rb->handle, data, len, pdMS_TO_TICKS(10)) != pdTRUE) {
-        return ESP_ERR_NO_MEM;
+    if (!rb || !data) return ESP_ERR_INVALID_ARG;
+    if (ring_buffer_free(rb) < len) return ESP_ERR_NO_MEM;
+
+    // At most two pieces: up to the wrap point, then from the start
+    while (len > 0) {
+        size_t granted = 0;
+        uint8_t *dst = ring_buffer_reserve(rb, len, &granted);
+        memcpy(dst, data, granted);
+        ring_buffer_commit(rb, granted);
+        data += granted;
+        len -= granted;
     }
-    
     return ESP_OK;
 }
 
 esp_err_t ring_buffer_read(ring_buffer_t *rb, uint8_t *data, size_t len) {
-    if (!rb || !rb->handle) return ESP_ERR_INVALID_ARG;
-    
-    size_t item_size;
-    uint8_t *item = xRingbufferReceive(rb->handle, &item_size, pdMS_TO_TICKS(10));
-    
-    if (!item) {
-        return ESP_ERR_NOT_FOUND;
+    if (!rb || !data) return ESP_ERR_INVALID_ARG;
+    if (ring_buffer_available(rb) < len) return ESP_ERR_NOT_FOUND;
+
+    while (len > 0) {
+        size_t contiguous = 0;
+        const uint8_t *src = ring_buffer_peek(rb, &contiguous);
+        size_t n = (contiguous < len) ? contiguous : len;
+        memcpy(data, src, n);
+        ring_buffer_release(rb, n);
+        data += n;
+        len -= n;
     }
-    
-    size_t copy_len = (item_size < len) ? item_size : len;
-    memcpy(data, item, copy_len);
-    vRingbufferReturnItem(rb->handle, item);
-    
     return ESP_OK;
 }
 
+// Snapshots - exact for the calling side, conservative for the other
 size_t ring_buffer_available(ring_buffer_t *rb) {
-    if (!rb || !rb->handle) return 0;
-    
-    UBaseType_t waiting;
-    vRingbufferGetInfo(rb->handle, NULL, NULL, NULL, NULL, &waiting);
-    return waiting;
+    if (!rb) return 0;
+    size_t r = atomic_load_explicit(&rb->read_idx, memory_order_acquire);
+    size_t w = atomic_load_explicit(&rb->write_idx, memory_order_acquire);
+    return ring_used(rb, w, r);
+}
+
+size_t ring_buffer_free(ring_buffer_t *rb) {
+    if (!rb) return 0;
+    size_t w = atomic_load_explicit(&rb->write_idx, memory_order_acquire);
+    size_t r = atomic_load_explicit(&rb->read_idx, memory_order_acquire);
+    return rb->capacity - ring_used(rb, w, r);
 }
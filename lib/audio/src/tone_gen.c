@@ -1,29 +1,239 @@
 #include "audio/tone_gen.h"
 #include "config/build.h"
 #include <math.h>
+#include <stdbool.h>
+#include <freertos/FreeRTOS.h>
 #include <esp_log.h>
 
 static const char *TAG = "tone_gen";
-static double phase = 0.0;
-static float phase_increment = 0.0f;
+
+#define TONE_AMPLITUDE     16000         // Peak level (about -6 dBFS), as before
+#define TABLE_BITS         10
+#define TABLE_SIZE         (1 << TABLE_BITS)
+#define FRAC_BITS          (32 - TABLE_BITS)
+
+// Sine table, Q15, one guard entry so interpolation never wraps
+static int16_t sine_table[TABLE_SIZE + 1];
+static bool table_ready = false;
+
+// Configuration, written by the control side and snapshotted once per buffer
+typedef struct {
+    tone_gen_mode_t mode;
+    uint32_t sine_inc;
+    size_t tone_count;
+    uint32_t tone_inc[TONE_GEN_MAX_TONES];
+    uint32_t sweep_start_hz;
+    uint32_t sweep_end_hz;
+    uint32_t sweep_samples;
+    uint32_t impulse_samples;
+    uint32_t generation;                 // Bumped when a mode is (re)configured
+} tone_config_t;
+
+static tone_config_t config;
+static portMUX_TYPE config_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Generator state, owned by the audio task
+static uint32_t phase;
+static uint32_t tone_phase[TONE_GEN_MAX_TONES];
+static uint32_t position;                // Samples into the sweep/impulse period
+static uint32_t active_generation;
+
+static inline uint32_t freq_to_inc(uint32_t freq_hz) {
+    return (uint32_t)(((uint64_t)freq_hz << 32) / AUDIO_SAMPLE_RATE);
+}
+
+// Q15 sine at a 32-bit phase: table lookup plus linear interpolation on the
+// next 16 phase bits below the index
+static inline int32_t nco_sine(uint32_t ph) {
+    uint32_t idx = ph >> FRAC_BITS;
+    int32_t frac = (int32_t)((ph >> (FRAC_BITS - 16)) & 0xFFFF);
+    int32_t a = sine_table[idx];
+    int32_t b = sine_table[idx + 1];
+    return a + (((b - a) * frac + (1 << 15)) >> 16);
+}
+
+static void build_table(void) {
+    for (int i = 0; i <= TABLE_SIZE; i++) {
+        sine_table[i] = (int16_t)lrintf(32767.0f * sinf(2.0f * (float)M_PI * i / TABLE_SIZE));
+    }
+    table_ready = true;
+}
 
 esp_err_t tone_gen_init(uint32_t freq_hz) {
-    phase_increment = 2.0f * M_PI * freq_hz / AUDIO_SAMPLE_RATE;
+    if (!table_ready) build_table();
+
+    portENTER_CRITICAL(&config_lock);
+    config.mode = TONE_GEN_SINE;
+    config.sine_inc = freq_to_inc(freq_hz);
+    config.generation++;
+    portEXIT_CRITICAL(&config_lock);
+
     ESP_LOGI(TAG, "Tone generator initialized: %luHz", freq_hz);
     return ESP_OK;
 }
 
 void tone_gen_set_frequency(uint32_t freq_hz) {
-phase_increment = 2.0f * M_PI * freq_hz / AUDIO_SAMPLE_RATE;
-phase = 0.0;  // Reset phase to avoid discontinuity
+    // Phase carries on from where it is, so there is no discontinuity to reset
+    portENTER_CRITICAL(&config_lock);
+    config.sine_inc = freq_to_inc(freq_hz);
+    portEXIT_CRITICAL(&config_lock);
 }
 
-void tone_gen_fill_buffer(int16_t *buffer, size_t num_samples) {
+esp_err_t tone_gen_set_multitone(const uint32_t *freqs_hz, size_t count) {
+    if (!freqs_hz || count == 0 || count > TONE_GEN_MAX_TONES) return ESP_ERR_INVALID_ARG;
+    for (size_t i = 0; i < count; i++) {
+        if (freqs_hz[i] == 0 || freqs_hz[i] >= AUDIO_SAMPLE_RATE / 2) return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&config_lock);
+    for (size_t i = 0; i < count; i++) {
+        config.tone_inc[i] = freq_to_inc(freqs_hz[i]);
+    }
+    config.tone_count = count;
+    config.mode = TONE_GEN_MULTITONE;
+    config.generation++;
+    portEXIT_CRITICAL(&config_lock);
+
+    ESP_LOGI(TAG, "Multitone: %u tones", (unsigned)count);
+    return ESP_OK;
+}
+
+esp_err_t tone_gen_set_sweep(uint32_t start_hz, uint32_t end_hz, uint32_t period_ms) {
+    if (start_hz == 0 || end_hz == 0 || start_hz >= AUDIO_SAMPLE_RATE / 2 ||
+        end_hz >= AUDIO_SAMPLE_RATE / 2 || period_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&config_lock);
+    config.sweep_start_hz = start_hz;
+    config.sweep_end_hz = end_hz;
+    config.sweep_samples = (uint32_t)((uint64_t)period_ms * AUDIO_SAMPLE_RATE / 1000);
+    config.mode = TONE_GEN_SWEEP;
+    config.generation++;
+    portEXIT_CRITICAL(&config_lock);
+
+    ESP_LOGI(TAG, "Log sweep: %lu -> %lu Hz over %lu ms", start_hz, end_hz, period_ms);
+    return ESP_OK;
+}
+
+esp_err_t tone_gen_set_impulse(uint32_t period_ms) {
+    if (period_ms == 0) return ESP_ERR_INVALID_ARG;
+
+    portENTER_CRITICAL(&config_lock);
+    config.impulse_samples = (uint32_t)((uint64_t)period_ms * AUDIO_SAMPLE_RATE / 1000);
+    config.mode = TONE_GEN_IMPULSE;
+    config.generation++;
+    portEXIT_CRITICAL(&config_lock);
+
+    ESP_LOGI(TAG, "Impulse every %lu ms", period_ms);
+    return ESP_OK;
+}
+
+esp_err_t tone_gen_set_mode(tone_gen_mode_t mode) {
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&config_lock);
+    bool configured = (mode == TONE_GEN_SINE) ||
+                      (mode == TONE_GEN_MULTITONE && config.tone_count > 0) ||
+                      (mode == TONE_GEN_SWEEP && config.sweep_samples > 0) ||
+                      (mode == TONE_GEN_IMPULSE && config.impulse_samples > 0);
+    if (configured) {
+        config.mode = mode;
+        config.generation++;
+    } else {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    portEXIT_CRITICAL(&config_lock);
+    return ret;
+}
+
+tone_gen_mode_t tone_gen_get_mode(void) {
+    return config.mode;
+}
+
+// Schroeder phases (-pi k(k-1)/N) keep the peak of N equal tones well under N x one tone
+static void start_multitone(const tone_config_t *cfg) {
+    for (size_t k = 0; k < cfg->tone_count; k++) {
+        uint64_t num = (uint64_t)k * (k + 1);       // k counted from 1: k(k-1) -> (k+1)k
+        tone_phase[k] = (uint32_t)(0u - (uint32_t)((num << 31) / cfg->tone_count));
+    }
+}
+
+static void fill_multitone(const tone_config_t *cfg, int16_t *buffer, size_t num_samples) {
+    const int32_t amp = TONE_AMPLITUDE / (int32_t)cfg->tone_count;  // Never clips, whatever the phases
+    for (size_t i = 0; i < num_samples; i++) {
+        int32_t acc = 0;
+        for (size_t k = 0; k < cfg->tone_count; k++) {
+            acc += nco_sine(tone_phase[k]);
+            tone_phase[k] += cfg->tone_inc[k];
+        }
+        buffer[i] = (int16_t)((acc * amp + (1 << 14)) >> 15);
+    }
+}
+
+// Exponential sweep: f(t) = f0 * (f1/f0)^(t/T). The increment is recomputed
+// exactly at each buffer start and stepped by a constant ratio per sample
+// inside it, so float error cannot accumulate across the period
+static void fill_sweep(const tone_config_t *cfg, int16_t *buffer, size_t num_samples) {
+    const float log_ratio = logf((float)cfg->sweep_end_hz / (float)cfg->sweep_start_hz);
+    const float step = expf(log_ratio / (float)cfg->sweep_samples);
+    const float inc0 = (float)cfg->sweep_start_hz * (4294967296.0f / AUDIO_SAMPLE_RATE);
+
+    float inc = inc0 * expf(log_ratio * (float)position / (float)cfg->sweep_samples);
+    for (size_t i = 0; i < num_samples; i++) {
+        buffer[i] = (int16_t)((nco_sine(phase) * TONE_AMPLITUDE + (1 << 14)) >> 15);
+        phase += (uint32_t)inc;
+        inc *= step;
+        if (++position >= cfg->sweep_samples) {
+            // Restart at the start frequency from zero phase (clean sweep onset)
+            position = 0;
+            phase = 0;
+            inc = inc0;
+        }
+    }
+}
+
+static void fill_impulse(const tone_config_t *cfg, int16_t *buffer, size_t num_samples) {
     for (size_t i = 0; i < num_samples; i++) {
-        buffer[i] = (int16_t)(sin(phase) * 16000.0);
-        phase += phase_increment;
-        if (phase >= 2.0 * M_PI) {
-            phase -= 2.0 * M_PI;
+        buffer[i] = (position == 0) ? INT16_MAX : 0;
+        if (++position >= cfg->impulse_samples) position = 0;
+    }
+}
+
+void tone_gen_fill_buffer(int16_t *buffer, size_t num_samples) {
+    if (!buffer || !table_ready) return;
+
+    tone_config_t cfg;
+    portENTER_CRITICAL(&config_lock);
+    cfg = config;
+    portEXIT_CRITICAL(&config_lock);
+
+    if (cfg.generation != active_generation) {
+        // New mode or parameters: start the signal from its beginning
+        active_generation = cfg.generation;
+        position = 0;
+        if (cfg.mode == TONE_GEN_MULTITONE) {
+            start_multitone(&cfg);
+        } else if (cfg.mode == TONE_GEN_SWEEP) {
+            phase = 0;
+        }
+    }
+
+    switch (cfg.mode) {
+    case TONE_GEN_MULTITONE:
+        fill_multitone(&cfg, buffer, num_samples);
+        break;
+    case TONE_GEN_SWEEP:
+        fill_sweep(&cfg, buffer, num_samples);
+        break;
+    case TONE_GEN_IMPULSE:
+        fill_impulse(&cfg, buffer, num_samples);
+        break;
+    case TONE_GEN_SINE:
+    default:
+        for (size_t i = 0; i < num_samples; i++) {
+            buffer[i] = (int16_t)((nco_sine(phase) * TONE_AMPLITUDE + (1 << 14)) >> 15);
+            phase += cfg.sine_inc;
         }
+        break;
     }
 }
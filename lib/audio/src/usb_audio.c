@@ -1,77 +1,212 @@
 #include "audio/usb_audio.h"
+#include "config/build.h"
 
 #include <string.h>
 
 #include <esp_log.h>
 
+#if defined(CONFIG_TX_BUILD) || defined(CONFIG_COMBO_BUILD)
+#define USB_AUDIO_SINK 1
+#include <sdkconfig.h>
+#include <esp_timer.h>
+#include <tusb.h>
+#include "audio/usb_device_uac.h"
 #include "audio/ring_buffer.h"
+#include "audio/resampler.h"
+#include "audio/gain_stage.h"
 
-#ifdef CONFIG_TX_BUILD
-// TODO: USB audio support (v0.2) - requires usb_device_uac.h from ESP-IDF
-// #include "usb_device_uac.h"
-// #include "esp_private/usb_phy.h"
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
+// Asynchronous sink: without the explicit feedback endpoint the host never
+// learns the device clock and the ring drifts into overruns or underruns
+#if !CONFIG_USB_AUDIO_FEEDBACK_EP
+#error "usb_audio needs the USB audio feedback endpoint (CONFIG_USB_AUDIO_FEEDBACK_EP)"
+#endif
+#else
+#define USB_AUDIO_SINK 0
 #endif
 
 static const char *TAG = "usb_audio";
 
-#define USB_AUDIO_BUFFER_SIZE (48000 * 2 * 3 / 10)  // 100ms buffer @ 48kHz 24-bit stereo
+#if USB_AUDIO_SINK
 
-static ring_buffer_t *usb_audio_buffer = NULL;
-
-static bool usb_audio_active = false;
+#ifdef CONFIG_UAC_SAMPLE_RATE
+#define USB_HOST_RATE          CONFIG_UAC_SAMPLE_RATE
+#else
+#define USB_HOST_RATE          AUDIO_SAMPLE_RATE
+#endif
+#define USB_CHANNELS           2
+#define USB_FRAME_BYTES        (USB_CHANNELS * sizeof(int16_t))
+#define USB_FRAMES_PER_SEC     1000                      // Full-speed SOF rate
+
+// Host-rate frames making up one 5 ms audio frame (+1: the SRC may need one more)
+#define USB_HOST_FRAME         (USB_HOST_RATE * AUDIO_FRAME_MS / 1000)
+#define USB_SRC_MAX_IN         (USB_HOST_FRAME + 1)
+// Ring: 4 audio frames. The loop holds the fill at one frame after each read,
+// so latency is 5-10 ms with three frames of headroom for USB task jitter.
+#define USB_RING_FRAMES        (USB_HOST_FRAME * 4)
+#define USB_TARGET_FILL        USB_HOST_FRAME
+#define USB_ACTIVE_TIMEOUT_US  50000
+
+// Feedback loop, in 16.16 samples per USB frame per frame of fill error. The
+// proportional term works off a one-frame fill error in about four seconds; the
+// integrator (kept with 8 extra fraction bits) learns the clock offset and is
+// clamped to DRIFT_MAX_PPM. The total stays within ±1% of nominal.
+#define FB_NOMINAL             ((uint32_t)(((uint64_t)USB_HOST_RATE << 16) / USB_FRAMES_PER_SEC))
+#define FB_KP                  16
+#define FB_KI_Q8               2
+#define FB_INTEG_MAX_Q8        ((int32_t)((int64_t)FB_NOMINAL * DRIFT_MAX_PPM / 1000000) << 8)
+#define FB_LIMIT               (FB_NOMINAL / 100)
+
+static ring_buffer_t *usb_ring = NULL;
+static resampler_t *usb_src = NULL;
+static gain_stage_t *usb_gain = NULL;
+#if USB_HOST_RATE != AUDIO_SAMPLE_RATE
+static int16_t usb_src_in[USB_SRC_MAX_IN * USB_CHANNELS];
+#endif
 
-// Callback for USB audio output (speaker input from host)
+// Written by the UAC output callback (USB task)
+static volatile uint32_t usb_packets = 0;
+static volatile uint32_t usb_overruns = 0;
+static volatile uint32_t last_packet_us = 0;    // Low 32 bits of esp_timer (wraps in 71 min)
+
+// Reader side (audio task)
+static bool primed = false;
+static int32_t fb_integ_q8 = 0;
+static uint32_t fb_value = FB_NOMINAL;
+static uint32_t underruns = 0;
+static uint32_t last_fill = 0;
+static uint32_t fb_errors = 0;
+
+// UAC output callback: land the packet in the ring and return. Whole stereo
+// frames only, so the reader never sees half of one.
 static esp_err_t usb_audio_output_cb(uint8_t *buf, size_t len, void *cb_ctx) {
     (void)cb_ctx;
 
-    if (!usb_audio_buffer) {
-        return ESP_FAIL;
+    len -= len % USB_FRAME_BYTES;
+    usb_packets++;
+    last_packet_us = (uint32_t)esp_timer_get_time();
+    if (len == 0) {
+        return ESP_OK;
     }
-
-    // Write audio data to ring buffer
-    if (ring_buffer_write(usb_audio_buffer, buf, len) != ESP_OK) {
-        ESP_LOGW(TAG, "USB audio buffer full, dropping %d bytes", len);
+    if (ring_buffer_write(usb_ring, buf, len) != ESP_OK) {
+        usb_overruns++;  // Host ahead of the feedback (or reader stalled): drop the packet
     }
-
-    usb_audio_active = true;
     return ESP_OK;
 }
 
+// PI on the post-read fill; the result is what the host should send per USB frame
+static void update_feedback(uint32_t fill_frames) {
+    int32_t err = (int32_t)fill_frames - USB_TARGET_FILL;   // + = too full, ask for less
+
+    fb_integ_q8 -= err * FB_KI_Q8;
+    if (fb_integ_q8 > FB_INTEG_MAX_Q8) fb_integ_q8 = FB_INTEG_MAX_Q8;
+    if (fb_integ_q8 < -FB_INTEG_MAX_Q8) fb_integ_q8 = -FB_INTEG_MAX_Q8;
+
+    int32_t correction = (fb_integ_q8 >> 8) - err * FB_KP;
+    if (correction > (int32_t)FB_LIMIT) correction = FB_LIMIT;
+    if (correction < -(int32_t)FB_LIMIT) correction = -(int32_t)FB_LIMIT;
+    fb_value = FB_NOMINAL + correction;
+    if (!tud_audio_fb_set(fb_value) && fb_errors++ == 0) {
+        // The descriptor has no feedback endpoint, or the host never opened it
+        ESP_LOGW(TAG, "Feedback endpoint not available: the host will drift against the device clock");
+    }
+}
+
+#endif  // USB_AUDIO_SINK
+
 esp_err_t usb_audio_init(void) {
-    // TODO: USB audio support deferred to v0.2
-    // Requires ESP-IDF TinyUSB UAC component configuration
-    ESP_LOGI(TAG, "USB audio init (stub - v0.2 feature)");
+#if USB_AUDIO_SINK
+    usb_ring = ring_buffer_create(USB_RING_FRAMES * USB_FRAME_BYTES);
+    usb_src = resampler_create(USB_HOST_RATE, AUDIO_SAMPLE_RATE, USB_CHANNELS, AUDIO_FRAME_SAMPLES);
+    usb_gain = gain_stage_create();
+    if (!usb_ring || !usb_src || !usb_gain) {
+        ESP_LOGE(TAG, "Failed to allocate USB audio buffers");
+        return ESP_ERR_NO_MEM;
+    }
+
+    uac_device_config_t config = {
+        .skip_tinyusb_init = false,
+        .output_cb = usb_audio_output_cb,
+        .input_cb = NULL,                              // Speaker only
+        .set_mute_cb = gain_stage_uac_set_mute,
+        .set_volume_cb = gain_stage_uac_set_volume,
+        .cb_ctx = usb_gain,
+    };
+    esp_err_t ret = uac_device_init(&config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "UAC device init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "USB audio sink: %d Hz stereo, async with feedback (nominal 0x%08lx)",
+             USB_HOST_RATE, (uint32_t)FB_NOMINAL);
+    return ESP_OK;
+#else
+    ESP_LOGI(TAG, "USB audio not used on this build");
     return ESP_OK;
+#endif
 }
 
 esp_err_t usb_audio_read_frames(int16_t *frames, size_t frame_count, size_t *frames_read) {
-#ifdef CONFIG_TX_BUILD
-    if (!usb_audio_buffer) {
-        *frames_read = 0;
-        return ESP_FAIL;
+    *frames_read = 0;
+#if USB_AUDIO_SINK
+    if (!usb_ring || frame_count > AUDIO_FRAME_SAMPLES) {
+        memset(frames, 0, frame_count * USB_FRAME_BYTES);
+        return usb_ring ? ESP_ERR_INVALID_SIZE : ESP_ERR_INVALID_STATE;
     }
 
-    // Read 16-bit stereo directly
-    size_t bytes_to_read = frame_count * 2 * sizeof(int16_t);
-    size_t bytes_read = ring_buffer_read(usb_audio_buffer, frames, bytes_to_read);
-    *frames_read = bytes_read / (2 * sizeof(int16_t));
+    size_t need = resampler_input_needed(usb_src, frame_count);
+    size_t avail = ring_buffer_available(usb_ring) / USB_FRAME_BYTES;
 
-    // If we don't have enough data, fill with silence
-    if (*frames_read < frame_count) {
-        memset(&frames[*frames_read * 2], 0, (frame_count - *frames_read) * 2 * sizeof(int16_t));
-        *frames_read = frame_count;
+    // Prime to one frame past the target before starting, like the jitter buffer
+    if (!primed && avail >= need + USB_TARGET_FILL) {
+        primed = true;
+    }
+    if (!primed || avail < need) {
+        if (primed) {
+            underruns++;
+            primed = false;
+            resampler_reset(usb_src);
+        }
+        memset(frames, 0, frame_count * USB_FRAME_BYTES);
+        return ESP_OK;
     }
 
+#if USB_HOST_RATE == AUDIO_SAMPLE_RATE
+    ring_buffer_read(usb_ring, (uint8_t *)frames, need * USB_FRAME_BYTES);
+#else
+    ring_buffer_read(usb_ring, (uint8_t *)usb_src_in, need * USB_FRAME_BYTES);
+    resampler_process(usb_src, usb_src_in, need, frames, frame_count);
+#endif
+    gain_stage_process_s16(usb_gain, frames, frame_count, USB_CHANNELS);
+
+    last_fill = ring_buffer_available(usb_ring) / USB_FRAME_BYTES;
+    update_feedback(last_fill);
+    *frames_read = frame_count;
     return ESP_OK;
 #else
-    *frames_read = 0;
+    memset(frames, 0, frame_count * 2 * sizeof(int16_t));
     return ESP_OK;
 #endif
 }
 
 bool usb_audio_is_active(void) {
-    // TODO: Stub for v0.1 - implement in v0.2
+#if USB_AUDIO_SINK
+    return usb_packets > 0 && ((uint32_t)esp_timer_get_time() - last_packet_us) < USB_ACTIVE_TIMEOUT_US;
+#else
     return false;
+#endif
+}
+
+void usb_audio_get_stats(usb_audio_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+#if USB_AUDIO_SINK
+    stats->packets = usb_packets;
+    stats->overruns = usb_overruns;
+    stats->underruns = underruns;
+    stats->fill_frames = last_fill;
+    stats->feedback = fb_value;
+    stats->fb_errors = fb_errors;
+    stats->rate_ppm = (int32_t)(((int64_t)(fb_integ_q8 >> 8)) * 1000000 / (int64_t)FB_NOMINAL);
+#endif
 }
@@ -9,15 +9,44 @@
 #define AUDIO_BYTES_PER_SAMPLE 3     // 24-bit = 3 bytes (packed format)
 #define AUDIO_FRAME_BYTES      (AUDIO_FRAME_SAMPLES * AUDIO_BYTES_PER_SAMPLE * AUDIO_CHANNELS)  // 720 bytes
 
-// Opus compression (future - v0.2)
+// Opus compression (v0.2) - low-delay CELT, 5ms frames
+#define AUDIO_CODEC_OPUS       1     // 1 = send NET_PKT_TYPE_AUDIO_OPUS, 0 = raw PCM (RX decodes both)
+#define OPUS_BITRATE_BPS       64000 // 64 kbps ≈ 40 bytes/frame (vs 720 bytes raw)
+#define OPUS_COMPLEXITY        5     // 0-10, trades quality for encoder CPU
 #define OPUS_MAX_FRAME_BYTES   256  // Maximum Opus frame size
 #define NETWORK_FRAME_BYTES    OPUS_MAX_FRAME_BYTES  // Network packet size (future)
 
+// I2S output (RX/COMBO DAC): 1 = 24-bit samples left-justified in 32-bit slots,
+// 0 = 16-bit slots (original UDA1334 setup, drops the low 8 bits)
+#define I2S_OUTPUT_24BIT       1
+
+// RX output crossover (Hz, 0 = off): 4th-order Linkwitz-Riley high/low-pass before
+// the DAC, e.g. RX_LPF_HZ 80 for a dedicated subwoofer node, RX_HPF_HZ 80 for its satellites
+#define RX_HPF_HZ              0
+#define RX_LPF_HZ              0
+
+// RX playout gain in dB (-60 .. +6; boosts enable soft clipping), e.g. to level-match nodes
+#define RX_OUTPUT_GAIN_DB      0
+
+// AUX signal gate (AC RMS of a 16-bit frame): opens at ON, closes after HANGOVER
+// frames below OFF. COMBO also monitors locally, so it opens on almost any signal.
+#define AUX_GATE_ON_RMS          500   // ~1.5% of full scale
+#define AUX_GATE_OFF_RMS         250   // -6 dB hysteresis
+#define AUX_GATE_HANGOVER_FRAMES 40    // 200ms: rides through pauses between words/notes
+#define COMBO_AUX_GATE_ON_RMS    10
+#define COMBO_AUX_GATE_OFF_RMS   6
+
+// TONE mode test signal: 0 = sine (knob/oscillator sets the pitch), 1 = multitone
+// (6 tones, 100 Hz-10 kHz), 2 = log sweep 20 Hz-20 kHz every 10 s, 3 = impulse every
+// second (latency and impulse-response measurements across the mesh)
+#define TONE_TEST_SIGNAL         0
+
 // Network configuration - 10.48.0.x scheme (48kHz reference)
 #define MESH_ID                "MeshNet-Audio-48"
 #define MESH_SSID              MESH_ID  // SSID for WiFi AP/STA
 #define MESH_PASSWORD          "meshnet123"
 #define MESH_CHANNEL           6
+#define RX_STREAM_ID           0     // Stream RX plays: 0 = first announced, else a TX's stream_id (last MAC byte)
 #define UDP_PORT               3333  // Legacy (for star topology fallback if needed)
 #define MAX_PACKET_SIZE        (NET_FRAME_HEADER_SIZE + AUDIO_FRAME_BYTES)
 
@@ -28,8 +57,28 @@
 
 // Buffer configuration
 #define RING_BUFFER_SIZE       (AUDIO_FRAME_BYTES * 10)  // 10 frames = 50ms @ 5ms/frame
-#define JITTER_BUFFER_FRAMES   10   // 10 frames = 50ms
-#define JITTER_PREFILL_FRAMES  4    // Prefill 4 frames = 20ms startup latency
+#define JITTER_BUFFER_FRAMES   16   // Slots (power of two) = 80ms max depth
+#define JITTER_PREFILL_FRAMES  4    // Initial target: prefill 4 frames = 20ms startup latency
+#define JITTER_MIN_FRAMES      2    // Adaptive target lower bound = 10ms (one-hop, quiet air)
+#define JITTER_MAX_FRAMES      12   // Adaptive target upper bound = 60ms (deep/busy mesh)
+#define DRIFT_MAX_PPM          500  // ASRC correction range (crystals are typically within ±100 ppm)
+#define JITTER_ASRC_DROP_MARGIN 6   // With the ASRC steering depth, drop a frame only 6 frames (30ms) over target
+#define FRAME_POOL_FRAMES      32   // Jitter slots + mesh RX + delivery queue + decode/FEC/playout in flight
+#define FRAME_POOL_BUF_BYTES   768  // Largest mesh packet: header + FEC header + 722-byte parity block
+
+// Forward error correction (optional, off by default): K parity frames after every
+// N audio frames (K=1 is XOR). Recovery waits for the group's parity, so a loss can
+// cost up to N-1 frames of extra latency; with FEC on, the adaptive jitter target
+// never goes below N frames so rebuilt frames still arrive before their playout slot.
+#define AUDIO_FEC_ENABLED      0
+#define FEC_DATA_FRAMES        4     // N: 25% more packets, up to 15ms recovery latency
+#define FEC_PARITY_FRAMES      1     // K
+
+#if AUDIO_FEC_ENABLED && FEC_DATA_FRAMES > JITTER_MIN_FRAMES
+#define JITTER_FLOOR_FRAMES    FEC_DATA_FRAMES
+#else
+#define JITTER_FLOOR_FRAMES    JITTER_MIN_FRAMES
+#endif
 
 // Control layer configuration
 #define CONTROL_TELEMETRY_RATE_MS    1000   // 1 Hz
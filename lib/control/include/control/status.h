@@ -22,6 +22,7 @@ typedef struct {
     uint32_t bandwidth_kbps;
     int rssi;
     uint32_t tone_freq_hz;
+    int32_t input_level_dbfs;      // AUX input RMS level (-96 = silent)
 } tx_status_t;
 
 typedef struct {
@@ -30,6 +31,9 @@ typedef struct {
     uint32_t hops;
     bool receiving_audio;
     uint32_t bandwidth_kbps;
+    uint32_t jitter_depth_frames;  // Current adaptive playout depth target
+    uint32_t jitter_ms;            // Measured interarrival jitter
+    uint32_t late_frames;          // Frames discarded for arriving after playout
 } rx_status_t;
 
 typedef struct {
@@ -40,5 +44,6 @@ typedef struct {
     uint32_t bandwidth_kbps;
     int rssi;
     uint32_t tone_freq_hz;
-    float output_volume;
+    float output_volume;           // Local monitor gain, linear (1.0 = unity, max +6 dB)
+    int32_t input_level_dbfs;      // AUX input RMS level (-96 = silent)
 } combo_status_t;
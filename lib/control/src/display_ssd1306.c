@@ -310,8 +310,13 @@ void display_render_tx(display_view_t view, const tx_status_t *status) {
             display_draw_string(0, 1, buf);
     } else {
         const char *status_str = status->audio_active ? "Playing..." : "Idle...";
+        if (status->input_mode == INPUT_MODE_AUX) {
+            snprintf(buf, sizeof(buf), "%s %ld dB", status_str, status->input_level_dbfs);
+            display_draw_string(0, 1, buf);
+        } else {
             display_draw_string(0, 1, status_str);
         }
+        }
 
         snprintf(buf, sizeof(buf), "Bandwidth: %lu kbps", status->bandwidth_kbps);
         display_draw_string(0, 2, buf);
@@ -422,8 +427,13 @@ void display_render_combo(display_view_t view, const combo_status_t *status) {
             display_draw_string(0, 1, buf);
     } else {
         const char *status_str = status->audio_active ? "Playing..." : "Idle...";
+        if (status->input_mode == INPUT_MODE_AUX) {
+            snprintf(buf, sizeof(buf), "%s %ld dB", status_str, status->input_level_dbfs);
+            display_draw_string(0, 1, buf);
+        } else {
             display_draw_string(0, 1, status_str);
         }
+        }
 
         snprintf(buf, sizeof(buf), "Bandwidth: %lu kbps", status->bandwidth_kbps);
         display_draw_string(0, 2, buf);
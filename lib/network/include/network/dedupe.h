@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Duplicate suppression for broadcast forwarding: a sliding window per stream
+// for audio and one for parity (its own seq space). Each window is a ring of
+// bitmap words indexed by seq (RFC 6479 style): a newer seq clears the words
+// it moves past, so check-and-mark is a table lookup and a bit test whatever
+// the number of streams. stream_id is 8 bits, so it indexes the stream table
+// directly; only a stream's first frame looks for a slot (free, stale or LRU).
+// Not locked: check from one task (the mesh relay task).
+
+#define DEDUPE_STREAMS           32
+// Frames further behind the newest than this count as already seen:
+// 96 frames = 480 ms at 200 fps, far past any path difference in the tree
+#define DEDUPE_WINDOW_DEPTH      96
+// A window with nothing accepted for this long is stale: the source stopped
+// or restarted with a new seq, so its next frame starts a fresh window
+#define DEDUPE_STREAM_TIMEOUT_MS 1000
+
+typedef struct dedupe_t dedupe_t;
+
+dedupe_t* dedupe_create(void);
+void dedupe_destroy(dedupe_t *dd);
+void dedupe_reset(dedupe_t *dd);
+
+// True if seq was already seen on this stream's audio (or parity) window, or
+// is too old to tell; otherwise marks it seen and returns false
+bool dedupe_check(dedupe_t *dd, uint8_t stream_id, bool parity, uint16_t seq, uint32_t now_ms);
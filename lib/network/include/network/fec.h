@@ -0,0 +1,75 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "network/mesh_net.h"
+#include "config/build.h"
+
+// Forward error correction for audio streams (NET_PKT_TYPE_AUDIO_FEC)
+// Every N audio frames the sender emits K parity frames; a receiver holding
+// any N of the N+K frames of a group rebuilds the missing audio frames.
+// Parity is a systematic Cauchy Reed-Solomon code over GF(256) whose first
+// row is all ones, so K=1 degenerates to plain XOR.
+// Cost: the encoder codes straight from the outgoing payload, but the decoder
+// copies every received audio payload into its window (720 bytes per raw PCM
+// frame, ~40 per Opus frame), and the caller copies rebuilt payloads out - the
+// copies on the otherwise zero-copy RX path.
+
+#define FEC_MAX_DATA_FRAMES   16
+#define FEC_MAX_PARITY_FRAMES 4
+#define FEC_MAX_PAYLOAD       AUDIO_FRAME_BYTES
+#define FEC_BLOCK_MAX         (2 + FEC_MAX_PAYLOAD)  // Coded block = be16 length + payload
+
+// Parity payload header (follows net_frame_header_t, which carries type
+// NET_PKT_TYPE_AUDIO_FEC, seq = base_seq + parity_index, timestamp of base frame)
+typedef struct __attribute__((packed)) {
+	uint16_t base_seq;      // First audio seq of the group (network byte order)
+	uint8_t data_frames;    // N
+	uint8_t parity_frames;  // K
+	uint8_t parity_index;   // 0..K-1
+	uint8_t data_type;      // net_pkt_type_t of the protected frames
+	uint16_t block_len;     // Parity block bytes that follow (network byte order)
+} net_fec_header_t;
+
+#define NET_FEC_HEADER_SIZE   8
+#define NET_FEC_MAX_PACKET    (NET_FRAME_HEADER_SIZE + NET_FEC_HEADER_SIZE + FEC_BLOCK_MAX)
+
+typedef struct {
+	uint32_t groups;          // Groups with at least one parity frame seen
+	uint32_t recovered;       // Audio frames rebuilt from parity
+	uint32_t unrecoverable;   // Groups that lost more frames than parity could cover
+} fec_stats_t;
+
+typedef struct fec_encoder_t fec_encoder_t;
+typedef struct fec_decoder_t fec_decoder_t;
+
+// Sender: feed every audio payload in seq order; when a group completes the
+// function returns the number of parity payloads ready (K), else 0
+fec_encoder_t* fec_encoder_create(uint8_t data_frames, uint8_t parity_frames);
+void fec_encoder_destroy(fec_encoder_t *enc);
+int fec_encoder_add(fec_encoder_t *enc, uint8_t type, uint16_t seq, uint32_t timestamp,
+                    const uint8_t *payload, size_t len);
+// Writes net_fec_header_t + parity block for parity_index; fills the seq and
+// timestamp to put in the outer net_frame_header_t
+esp_err_t fec_encoder_get_parity(fec_encoder_t *enc, uint8_t parity_index, uint8_t *out, size_t *out_len,
+                                 uint16_t *seq, uint32_t *timestamp);
+
+// Receiver: one decoder serves several streams, each with its own frame window
+// and groups (seqs are per source); a stream beyond max_streams takes over the
+// least recently heard one. Rebuilt payloads are handed to deliver and are only
+// valid for the call. max_data_frames bounds the group size it will accept.
+typedef void (*fec_deliver_t)(uint8_t stream_id, uint8_t type, uint16_t seq, uint32_t timestamp,
+                              const uint8_t *payload, size_t len);
+
+fec_decoder_t* fec_decoder_create(uint8_t max_data_frames, uint8_t max_parity_frames, uint8_t max_streams);
+void fec_decoder_destroy(fec_decoder_t *dec);
+void fec_decoder_reset(fec_decoder_t *dec);
+void fec_decoder_add_data(fec_decoder_t *dec, uint8_t stream_id, uint8_t type, uint16_t seq,
+                          const uint8_t *payload, size_t len, fec_deliver_t deliver);
+void fec_decoder_add_parity(fec_decoder_t *dec, uint8_t stream_id, uint32_t timestamp,
+                            const uint8_t *payload, size_t len, fec_deliver_t deliver);
+void fec_decoder_get_stats(fec_decoder_t *dec, fec_stats_t *stats);
+
+// Stats of the decoder the mesh RX task runs for the registered audio callback
+esp_err_t network_get_fec_stats(fec_stats_t *stats);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "config/build.h"
+
+// Forwarding table: a relay's direct children (mesh addresses are their STA
+// MACs), kept from the child connect/disconnect events. The routing table is
+// the whole subtree, and a unicast to a grandchild is relayed by its parent -
+// which forwards the frame again itself - so relays send to direct children only.
+//
+// Each child also reports the streams its subtree plays (NET_PKT_TYPE_SUBSCRIBE),
+// and audio only goes down branches that want it. A child that has not reported
+// (just joined, older firmware) or whose report expired gets every stream.
+// Safe to call from the event handler and the relay task at once.
+
+#define FWD_REPORT_REFRESH_MS  CONTROL_HEARTBEAT_RATE_MS   // Reports re-sent with each heartbeat
+#define FWD_REPORT_TIMEOUT_MS  (3 * FWD_REPORT_REFRESH_MS)
+#define FWD_ALL_STREAMS        (-1)                         // Control frames: every child
+
+typedef struct fwd_table_t fwd_table_t;
+
+fwd_table_t* fwd_table_create(size_t max_children);
+void fwd_table_destroy(fwd_table_t *ft);
+void fwd_table_clear(fwd_table_t *ft);
+size_t fwd_table_count(fwd_table_t *ft);
+
+// ESP_ERR_NO_MEM if the table is full; adding a known child is a no-op
+esp_err_t fwd_table_add(fwd_table_t *ft, const uint8_t *mac);
+void fwd_table_remove(fwd_table_t *ft, const uint8_t *mac);
+
+// Store a child's subscription report (NET_STREAM_BITMAP_BYTES bitmap);
+// false if mac is not a direct child
+bool fwd_table_report(fwd_table_t *ft, const uint8_t *mac, const uint8_t *streams, uint32_t now_ms);
+
+// Children a frame of stream_id (or FWD_ALL_STREAMS) goes to, leaving out
+// exclude (the child it came from, may be NULL); returns the count written
+size_t fwd_table_targets(fwd_table_t *ft, int stream_id, const uint8_t *exclude, uint32_t now_ms,
+                         uint8_t (*out)[6], size_t max_out);
+
+// ORs the streams wanted below this node into streams (every stream for a
+// child without a current report)
+void fwd_table_subtree_streams(fwd_table_t *ft, uint32_t now_ms, uint8_t *streams);
@@ -7,6 +7,7 @@
 #include <arpa/inet.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include "audio/frame_pool.h"
 
 // ============================================================================
 // ESP-WIFI-MESH Network API (v0.1)
@@ -24,9 +25,56 @@ esp_err_t network_send_audio(const uint8_t *data, size_t len);
 esp_err_t network_send_control(const uint8_t *data, size_t len);
 
 // Audio reception callback (for RX nodes)
-typedef void (*network_audio_callback_t)(const uint8_t *payload, size_t len, uint16_t seq, uint32_t timestamp);
+// type is the frame's net_pkt_type_t (NET_PKT_TYPE_AUDIO_RAW or NET_PKT_TYPE_AUDIO_OPUS);
+// frames rebuilt from FEC parity arrive through the same callback.
+// frame->data/len is the payload of the pool buffer it was received into; it is only
+// valid during the call unless the callback keeps it with frame_pool_ref.
+// Runs on the mesh delivery task, so a slow callback never holds up relaying.
+typedef void (*network_audio_callback_t)(uint8_t type, audio_frame_t *frame, uint16_t seq, uint32_t timestamp);
 esp_err_t network_register_audio_callback(network_audio_callback_t callback);
 
+// Batched reception: each wakeup of the delivery task drains every frame queued
+// for local delivery (up to NETWORK_RX_BATCH_MAX, FEC rebuilds included) and
+// hands them over in one call, so the consumer takes its locks once per batch.
+// Frames are only valid during the call, as above. Registering a batch callback
+// replaces the per-frame one.
+#define NETWORK_RX_BATCH_MAX 16
+
+typedef struct {
+	audio_frame_t *frame;   // data/len = payload
+	uint8_t type;           // NET_PKT_TYPE_AUDIO_RAW or NET_PKT_TYPE_AUDIO_OPUS
+	uint8_t stream_id;
+	uint16_t seq;
+	uint32_t timestamp;     // Sender timestamp in ms
+	int64_t arrival_us;     // Local receive time (esp_timer), taken before queueing
+} network_rx_frame_t;
+
+typedef void (*network_audio_batch_callback_t)(const network_rx_frame_t *frames, size_t count);
+esp_err_t network_register_audio_batch_callback(network_audio_batch_callback_t callback);
+
+// Receive path counters since boot. Relay time runs from esp_mesh_recv
+// returning to the last forward to a child (the per-hop cost); delivery delay
+// from there to the audio callback (queue wait and batching).
+typedef struct {
+	uint32_t relayed;           // Audio frames through the relay path (dedupe and TTL passed)
+	uint32_t relay_avg_us;
+	uint32_t relay_max_us;
+	uint32_t delivered;         // Frames handed to the audio callback, FEC rebuilds included
+	uint32_t delivery_avg_us;
+	uint32_t delivery_max_us;
+	uint32_t delivery_drops;    // Frames relayed but not played here: delivery queue full
+} network_rx_stats_t;
+
+esp_err_t network_get_rx_stats(network_rx_stats_t *stats);
+
+// Stream subscriptions (RX nodes): only subscribed streams reach the audio
+// callback, and relays only send a stream down branches that subscribed to it.
+// NET_STREAM_AUTO follows the first stream announced (and the next one if it
+// stops announcing). A node can subscribe to several streams.
+#define NET_STREAM_AUTO 0
+esp_err_t network_subscribe_stream(uint8_t stream_id);
+esp_err_t network_unsubscribe_stream(uint8_t stream_id);
+
 // Mesh topology queries
 bool network_is_root(void);
 uint8_t network_get_layer(void);
@@ -38,6 +86,7 @@ int network_get_rssi(void);
 uint32_t network_get_latency_ms(void);
 uint32_t network_get_connected_nodes(void);
 bool network_is_stream_ready(void);  // True when connected to mesh
+uint8_t network_get_stream_id(void);  // This node's stream_id for outgoing audio (from its MAC)
 
 // Network framing header (aligned with mesh-network-architecture.md)
 #define NET_FRAME_MAGIC 0xA5
@@ -47,11 +96,14 @@ typedef enum {
 	NET_PKT_TYPE_AUDIO_RAW = 1,
 	NET_PKT_TYPE_HEARTBEAT = 2,
 	NET_PKT_TYPE_STREAM_ANNOUNCE = 3,
+	NET_PKT_TYPE_AUDIO_OPUS = 4,    // Opus-encoded 5ms mono frame (variable payload_len)
+	NET_PKT_TYPE_AUDIO_FEC = 5,     // Parity over a group of audio frames (see network/fec.h)
+	NET_PKT_TYPE_SUBSCRIBE = 6,     // Streams played below the sender (net_subscribe_t, to its parent)
 	NET_PKT_TYPE_CONTROL = 0x10,
 } net_pkt_type_t;
 
-// Audio frame header (12 bytes, aligned for mesh)
-#define NET_FRAME_HEADER_SIZE 12
+// Audio frame header (16 bytes: the payload after it stays word-aligned)
+#define NET_FRAME_HEADER_SIZE 16
 
 typedef struct __attribute__((packed)) {
 	uint8_t magic;          // 0xA5 (NET_FRAME_MAGIC)
@@ -62,9 +114,11 @@ typedef struct __attribute__((packed)) {
 	uint32_t timestamp;     // Sender timestamp in ms
 	uint16_t payload_len;   // Payload length in bytes (network byte order)
 	uint8_t ttl;            // Hop limit (decremented at each relay)
-	uint8_t reserved;       // Alignment padding
+	uint8_t reserved[3];    // Alignment padding (zero)
 } net_frame_header_t;
 
+_Static_assert(sizeof(net_frame_header_t) == NET_FRAME_HEADER_SIZE, "senders copy NET_FRAME_HEADER_SIZE bytes");
+
 // Heartbeat packet (sent every 2 seconds by all nodes)
 typedef struct __attribute__((packed)) {
 	uint8_t type;           // 0x02 = HEARTBEAT
@@ -77,7 +131,7 @@ typedef struct __attribute__((packed)) {
 	uint8_t reserved;       // Padding
 } mesh_heartbeat_t;
 
-// Stream announcement (sent by TX/COMBO on startup and mode change)
+// Stream announcement (sent by TX/COMBO every heartbeat, after a net_frame_header_t)
 typedef struct __attribute__((packed)) {
 	uint8_t type;           // 0x03 = STREAM_ANNOUNCE
 	uint8_t stream_id;      // Unique ID for this audio stream
@@ -85,4 +139,15 @@ typedef struct __attribute__((packed)) {
 	uint8_t channels;       // 1 (mono)
 	uint8_t bits_per_sample; // 24
 	uint16_t frame_size_ms; // 5
+	uint8_t codec;          // Audio frame type this stream sends (net_pkt_type_t)
+	uint8_t reserved;       // Padding
 } mesh_stream_announce_t;
+
+// Subscription report (after a net_frame_header_t, every heartbeat and on change):
+// the streams the sender and its subtree play. A relay forwards a stream to a
+// child only if the child's last report has its bit set.
+#define NET_STREAM_BITMAP_BYTES 32
+
+typedef struct __attribute__((packed)) {
+	uint8_t streams[NET_STREAM_BITMAP_BYTES];  // Bit (id & 7) of byte (id >> 3) per stream_id
+} net_subscribe_t;
@@ -0,0 +1,107 @@
+#include "network/dedupe.h"
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+
+static const char *TAG = "dedupe";
+
+#define DEDUPE_WINDOW_WORDS    4       // Power of two
+#define DEDUPE_WINDOW_BITS     (DEDUPE_WINDOW_WORDS * 32)
+
+_Static_assert(DEDUPE_WINDOW_DEPTH <= DEDUPE_WINDOW_BITS - 32,
+               "the word holding the newest seq is partly ahead of it");
+
+typedef struct {
+    bool active;
+    uint16_t top;           // Newest seq accepted
+    uint32_t last_ms;       // When a frame was last accepted
+    uint32_t bits[DEDUPE_WINDOW_WORDS];
+} dedupe_window_t;
+
+typedef struct {
+    bool used;
+    uint8_t stream_id;
+    uint32_t last_ms;       // Newest of the two windows (age-based eviction)
+    dedupe_window_t win[2]; // Audio (raw/Opus share the sender's seq), parity
+} dedupe_stream_t;
+
+struct dedupe_t {
+    dedupe_stream_t streams[DEDUPE_STREAMS];
+    uint8_t slot[256];      // stream_id -> streams index (checked against the entry)
+};
+
+dedupe_t* dedupe_create(void) {
+    return calloc(1, sizeof(dedupe_t));
+}
+
+void dedupe_destroy(dedupe_t *dd) {
+    free(dd);
+}
+
+void dedupe_reset(dedupe_t *dd) {
+    if (dd) memset(dd, 0, sizeof(*dd));
+}
+
+// Table entry for a stream, taking a free, stale or least recently used one
+// the first time the stream is seen
+static dedupe_stream_t *find_stream(dedupe_t *dd, uint8_t stream_id, uint32_t now_ms) {
+    uint8_t slot = dd->slot[stream_id];
+    if (dd->streams[slot].used && dd->streams[slot].stream_id == stream_id) {
+        return &dd->streams[slot];
+    }
+
+    slot = 0;
+    for (int i = 0; i < DEDUPE_STREAMS; i++) {
+        if (!dd->streams[i].used) {
+            slot = i;
+            break;
+        }
+        if (now_ms - dd->streams[i].last_ms > now_ms - dd->streams[slot].last_ms) {
+            slot = i;
+        }
+    }
+    dedupe_stream_t *st = &dd->streams[slot];
+    if (st->used) {
+        ESP_LOGD(TAG, "Table full, stream %u replaces %u", stream_id, st->stream_id);
+    }
+    memset(st, 0, sizeof(*st));
+    st->used = true;
+    st->stream_id = stream_id;
+    dd->slot[stream_id] = slot;
+    return st;
+}
+
+bool dedupe_check(dedupe_t *dd, uint8_t stream_id, bool parity, uint16_t seq, uint32_t now_ms) {
+    dedupe_stream_t *st = find_stream(dd, stream_id, now_ms);
+    dedupe_window_t *w = &st->win[parity];
+
+    if (!w->active || now_ms - w->last_ms > DEDUPE_STREAM_TIMEOUT_MS) {
+        w->active = true;
+        w->top = seq;
+        memset(w->bits, 0, sizeof(w->bits));
+    } else {
+        int16_t ahead = (int16_t)(seq - w->top);
+        if (ahead > 0) {
+            // Clear the words between the old newest and this one (all if it jumped far)
+            uint32_t words = ((seq >> 5) - (w->top >> 5)) & 0x7FF;
+            if (words > DEDUPE_WINDOW_WORDS) words = DEDUPE_WINDOW_WORDS;
+            for (uint32_t i = 1; i <= words; i++) {
+                w->bits[((w->top >> 5) + i) & (DEDUPE_WINDOW_WORDS - 1)] = 0;
+            }
+            w->top = seq;
+        } else if (-ahead >= DEDUPE_WINDOW_DEPTH) {
+            return true;
+        }
+    }
+
+    uint32_t bit = seq & (DEDUPE_WINDOW_BITS - 1);
+    uint32_t mask = 1u << (bit & 31);
+    uint32_t *word = &w->bits[bit >> 5];
+    if (*word & mask) {
+        return true;
+    }
+    *word |= mask;
+    w->last_ms = now_ms;
+    st->last_ms = now_ms;
+    return false;
+}
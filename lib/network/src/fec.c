@@ -0,0 +1,484 @@
+#include "network/fec.h"
+#include <esp_log.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+static const char *TAG = "fec";
+
+// Two groups in flight: the parity of group g may arrive after data of g+1
+#define FEC_DECODER_GROUPS 2
+
+// ============================================================================
+// GF(256) arithmetic (polynomial 0x11D) and Cauchy coefficients
+// ============================================================================
+
+static uint8_t gf_exp[512];
+static uint8_t gf_log[256];
+static uint8_t coef[FEC_MAX_PARITY_FRAMES][FEC_MAX_DATA_FRAMES];
+static bool gf_ready = false;
+
+static uint8_t gf_mul(uint8_t a, uint8_t b) {
+    if (a == 0 || b == 0) return 0;
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+static uint8_t gf_inv(uint8_t a) {
+    return gf_exp[255 - gf_log[a]];
+}
+
+static void gf_init(void) {
+    if (gf_ready) return;
+
+    uint16_t x = 1;
+    for (int i = 0; i < 255; i++) {
+        gf_exp[i] = (uint8_t)x;
+        gf_log[x] = (uint8_t)i;
+        x <<= 1;
+        if (x & 0x100) x ^= 0x11D;
+    }
+    for (int i = 255; i < 512; i++) {
+        gf_exp[i] = gf_exp[i - 255];
+    }
+
+    // Cauchy matrix 1/(x_j + y_i) with x_j = 0x80 + j, y_i = i; every square
+    // submatrix is invertible. Scaling each column by 1/c[0][i] keeps that
+    // property and turns parity row 0 into plain XOR.
+    for (int j = 0; j < FEC_MAX_PARITY_FRAMES; j++) {
+        for (int i = 0; i < FEC_MAX_DATA_FRAMES; i++) {
+            uint8_t c = gf_inv((uint8_t)((0x80 + j) ^ i));
+            uint8_t c0 = gf_inv((uint8_t)(0x80 ^ i));
+            coef[j][i] = gf_mul(c, gf_inv(c0));
+        }
+    }
+    gf_ready = true;
+}
+
+// dst ^= c * src
+static void gf_mul_add(uint8_t *dst, const uint8_t *src, uint8_t c, size_t len) {
+    if (c == 0) return;
+    if (c == 1) {
+        for (size_t k = 0; k < len; k++) dst[k] ^= src[k];
+        return;
+    }
+    unsigned lc = gf_log[c];
+    for (size_t k = 0; k < len; k++) {
+        if (src[k]) dst[k] ^= gf_exp[gf_log[src[k]] + lc];
+    }
+}
+
+// In-place Gauss-Jordan inversion of an n x n matrix (n <= FEC_MAX_PARITY_FRAMES)
+static bool gf_invert(uint8_t m[FEC_MAX_PARITY_FRAMES][FEC_MAX_PARITY_FRAMES], int n) {
+    uint8_t inv[FEC_MAX_PARITY_FRAMES][FEC_MAX_PARITY_FRAMES] = {{0}};
+    for (int i = 0; i < n; i++) inv[i][i] = 1;
+
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        while (pivot < n && m[pivot][col] == 0) pivot++;
+        if (pivot == n) return false;
+        if (pivot != col) {
+            for (int k = 0; k < n; k++) {
+                uint8_t t = m[col][k]; m[col][k] = m[pivot][k]; m[pivot][k] = t;
+                t = inv[col][k]; inv[col][k] = inv[pivot][k]; inv[pivot][k] = t;
+            }
+        }
+        uint8_t scale = gf_inv(m[col][col]);
+        for (int k = 0; k < n; k++) {
+            m[col][k] = gf_mul(m[col][k], scale);
+            inv[col][k] = gf_mul(inv[col][k], scale);
+        }
+        for (int row = 0; row < n; row++) {
+            uint8_t f = m[row][col];
+            if (row == col || f == 0) continue;
+            for (int k = 0; k < n; k++) {
+                m[row][k] ^= gf_mul(f, m[col][k]);
+                inv[row][k] ^= gf_mul(f, inv[col][k]);
+            }
+        }
+    }
+    memcpy(m, inv, sizeof(inv));
+    return true;
+}
+
+// Coded block = big-endian payload length + payload, zero padded to the group's block_len
+static size_t make_block(uint8_t *block, const uint8_t *payload, size_t len) {
+    block[0] = (uint8_t)(len >> 8);
+    block[1] = (uint8_t)(len & 0xFF);
+    memcpy(block + 2, payload, len);
+    return len + 2;
+}
+
+// ============================================================================
+// Encoder
+// ============================================================================
+
+struct fec_encoder_t {
+    uint8_t data_frames;
+    uint8_t parity_frames;
+    uint8_t count;             // Frames added to the current group
+    uint8_t data_type;
+    uint16_t base_seq;
+    uint32_t base_timestamp;
+    size_t block_len;          // Longest coded block in the group
+    uint8_t parity[FEC_MAX_PARITY_FRAMES][FEC_BLOCK_MAX];
+};
+
+fec_encoder_t* fec_encoder_create(uint8_t data_frames, uint8_t parity_frames) {
+    if (data_frames == 0 || data_frames > FEC_MAX_DATA_FRAMES ||
+        parity_frames == 0 || parity_frames > FEC_MAX_PARITY_FRAMES) {
+        return NULL;
+    }
+
+    fec_encoder_t *enc = calloc(1, sizeof(fec_encoder_t));
+    if (!enc) return NULL;
+
+    gf_init();
+    enc->data_frames = data_frames;
+    enc->parity_frames = parity_frames;
+
+    ESP_LOGI(TAG, "FEC encoder created: %u parity per %u frames (%u%% overhead)",
+             parity_frames, data_frames, (parity_frames * 100) / data_frames);
+    return enc;
+}
+
+void fec_encoder_destroy(fec_encoder_t *enc) {
+    free(enc);
+}
+
+int fec_encoder_add(fec_encoder_t *enc, uint8_t type, uint16_t seq, uint32_t timestamp,
+                    const uint8_t *payload, size_t len) {
+    if (!enc || !payload || len > FEC_MAX_PAYLOAD) return 0;
+
+    // Start a new group after a completed one, or if the sender skipped a seq
+    // (the partial group is simply sent unprotected)
+    if (enc->count == enc->data_frames || enc->count == 0 ||
+        seq != (uint16_t)(enc->base_seq + enc->count) || type != enc->data_type) {
+        for (int j = 0; j < enc->parity_frames; j++) {
+            memset(enc->parity[j], 0, enc->block_len);
+        }
+        enc->count = 0;
+        enc->block_len = 0;
+        enc->base_seq = seq;
+        enc->base_timestamp = timestamp;
+        enc->data_type = type;
+    }
+
+    // Coded block straight from the payload: length prefix, then the payload
+    // itself (no staging copy; the zero padding contributes nothing)
+    const uint8_t prefix[2] = {(uint8_t)(len >> 8), (uint8_t)(len & 0xFF)};
+    size_t block_len = len + 2;
+    for (int j = 0; j < enc->parity_frames; j++) {
+        gf_mul_add(enc->parity[j], prefix, coef[j][enc->count], 2);
+        gf_mul_add(enc->parity[j] + 2, payload, coef[j][enc->count], len);
+    }
+    if (block_len > enc->block_len) enc->block_len = block_len;
+    enc->count++;
+
+    return (enc->count == enc->data_frames) ? enc->parity_frames : 0;
+}
+
+esp_err_t fec_encoder_get_parity(fec_encoder_t *enc, uint8_t parity_index, uint8_t *out, size_t *out_len,
+                                 uint16_t *seq, uint32_t *timestamp) {
+    if (!enc || !out || !out_len) return ESP_ERR_INVALID_ARG;
+    if (enc->count != enc->data_frames || parity_index >= enc->parity_frames) return ESP_ERR_INVALID_STATE;
+
+    net_fec_header_t hdr;
+    hdr.base_seq = htons(enc->base_seq);
+    hdr.data_frames = enc->data_frames;
+    hdr.parity_frames = enc->parity_frames;
+    hdr.parity_index = parity_index;
+    hdr.data_type = enc->data_type;
+    hdr.block_len = htons((uint16_t)enc->block_len);
+    memcpy(out, &hdr, NET_FEC_HEADER_SIZE);
+    memcpy(out + NET_FEC_HEADER_SIZE, enc->parity[parity_index], enc->block_len);
+    *out_len = NET_FEC_HEADER_SIZE + enc->block_len;
+
+    if (seq) *seq = (uint16_t)(enc->base_seq + parity_index);
+    if (timestamp) *timestamp = enc->base_timestamp;
+    return ESP_OK;
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+typedef struct {
+    bool valid;
+    uint16_t seq;
+    uint8_t block[FEC_BLOCK_MAX];
+} fec_slot_t;
+
+typedef struct {
+    bool valid;
+    bool done;                 // Complete or recovered
+    uint16_t base_seq;
+    uint8_t data_frames;
+    uint8_t parity_frames;
+    uint8_t data_type;
+    uint8_t have;              // Bitmask of parity indices held
+    uint32_t timestamp;
+    size_t block_len;
+    uint8_t parity[FEC_MAX_PARITY_FRAMES][FEC_BLOCK_MAX];
+} fec_group_t;
+
+// Seqs and group bases are per source, so each stream gets its own window and groups
+typedef struct {
+    bool active;
+    uint8_t stream_id;
+    uint32_t last_used;        // Decoder use counter at the stream's last frame (LRU)
+    fec_slot_t *slots;         // Recent audio frames, indexed by seq & mask
+    fec_group_t groups[FEC_DECODER_GROUPS];
+    int next_group;
+} fec_stream_t;
+
+struct fec_decoder_t {
+    uint8_t max_data;
+    uint8_t max_parity;
+    uint8_t max_streams;
+    size_t mask;
+    uint32_t use_count;
+    fec_stream_t *streams;
+    uint8_t syndrome[FEC_MAX_PARITY_FRAMES][FEC_BLOCK_MAX];
+    fec_stats_t stats;
+};
+
+fec_decoder_t* fec_decoder_create(uint8_t max_data_frames, uint8_t max_parity_frames, uint8_t max_streams) {
+    if (max_data_frames == 0 || max_data_frames > FEC_MAX_DATA_FRAMES ||
+        max_parity_frames == 0 || max_parity_frames > FEC_MAX_PARITY_FRAMES || max_streams == 0) {
+        return NULL;
+    }
+
+    // Hold at least two groups of audio so a late parity frame still finds its data
+    size_t capacity = 1;
+    while (capacity < 2u * max_data_frames) capacity <<= 1;
+
+    fec_decoder_t *dec = calloc(1, sizeof(fec_decoder_t));
+    if (!dec) return NULL;
+    dec->streams = calloc(max_streams, sizeof(fec_stream_t));
+    if (!dec->streams) {
+        free(dec);
+        return NULL;
+    }
+    dec->max_streams = max_streams;
+    for (int i = 0; i < max_streams; i++) {
+        dec->streams[i].slots = calloc(capacity, sizeof(fec_slot_t));
+        if (!dec->streams[i].slots) {
+            fec_decoder_destroy(dec);
+            return NULL;
+        }
+    }
+
+    gf_init();
+    dec->max_data = max_data_frames;
+    dec->max_parity = max_parity_frames;
+    dec->mask = capacity - 1;
+
+    ESP_LOGI(TAG, "FEC decoder created: groups up to %u+%u, %u frame window, %u streams",
+             max_data_frames, max_parity_frames, capacity, max_streams);
+    return dec;
+}
+
+void fec_decoder_destroy(fec_decoder_t *dec) {
+    if (dec) {
+        for (int i = 0; i < dec->max_streams; i++) {
+            free(dec->streams[i].slots);
+        }
+        free(dec->streams);
+        free(dec);
+    }
+}
+
+static void stream_reset(fec_decoder_t *dec, fec_stream_t *st) {
+    for (size_t i = 0; i <= dec->mask; i++) {
+        st->slots[i].valid = false;
+    }
+    for (int g = 0; g < FEC_DECODER_GROUPS; g++) {
+        st->groups[g].valid = false;
+    }
+}
+
+void fec_decoder_reset(fec_decoder_t *dec) {
+    if (!dec) return;
+    for (int i = 0; i < dec->max_streams; i++) {
+        stream_reset(dec, &dec->streams[i]);
+        dec->streams[i].active = false;
+    }
+}
+
+// The stream's state, taking a free or the least recently used one for a new
+// stream (whose frames and groups are then forgotten)
+static fec_stream_t* get_stream(fec_decoder_t *dec, uint8_t stream_id) {
+    fec_stream_t *lru = &dec->streams[0];
+    dec->use_count++;
+    for (int i = 0; i < dec->max_streams; i++) {
+        fec_stream_t *st = &dec->streams[i];
+        if (st->active && st->stream_id == stream_id) {
+            st->last_used = dec->use_count;
+            return st;
+        }
+        if (lru->active && (!st->active || (int32_t)(st->last_used - lru->last_used) < 0)) {
+            lru = st;
+        }
+    }
+    if (lru->active) {
+        ESP_LOGD(TAG, "Stream %u takes over the FEC window of stream %u", stream_id, lru->stream_id);
+    }
+    stream_reset(dec, lru);
+    lru->active = true;
+    lru->stream_id = stream_id;
+    lru->last_used = dec->use_count;
+    return lru;
+}
+
+static fec_slot_t* find_slot(fec_decoder_t *dec, fec_stream_t *st, uint16_t seq) {
+    fec_slot_t *slot = &st->slots[seq & dec->mask];
+    return (slot->valid && slot->seq == seq) ? slot : NULL;
+}
+
+static void try_recover(fec_decoder_t *dec, fec_stream_t *st, fec_group_t *g, fec_deliver_t deliver) {
+    if (g->done) return;
+
+    uint8_t missing[FEC_MAX_PARITY_FRAMES];
+    int num_missing = 0;
+    for (int i = 0; i < g->data_frames; i++) {
+        uint16_t seq = (uint16_t)(g->base_seq + i);
+        fec_slot_t *slot = &st->slots[seq & dec->mask];
+        if (slot->valid && slot->seq == seq) continue;
+        if (slot->valid && (int16_t)(slot->seq - seq) > 0) {
+            g->done = true;  // Window already moved past this group
+            return;
+        }
+        if (num_missing == FEC_MAX_PARITY_FRAMES) return;  // More than any parity can cover
+        missing[num_missing++] = (uint8_t)i;
+    }
+    if (num_missing == 0) {
+        g->done = true;
+        return;
+    }
+
+    // Need as many parity frames as missing audio frames; wait for more otherwise
+    uint8_t rows[FEC_MAX_PARITY_FRAMES];
+    int num_rows = 0;
+    for (int j = 0; j < g->parity_frames && num_rows < num_missing; j++) {
+        if (g->have & (1u << j)) rows[num_rows++] = (uint8_t)j;
+    }
+    if (num_rows < num_missing) return;
+
+    // Syndromes: parity minus the contribution of every frame we do have
+    for (int r = 0; r < num_rows; r++) {
+        memcpy(dec->syndrome[r], g->parity[rows[r]], g->block_len);
+        for (int i = 0; i < g->data_frames; i++) {
+            fec_slot_t *slot = find_slot(dec, st, (uint16_t)(g->base_seq + i));
+            if (slot) gf_mul_add(dec->syndrome[r], slot->block, coef[rows[r]][i], g->block_len);
+        }
+    }
+
+    uint8_t m[FEC_MAX_PARITY_FRAMES][FEC_MAX_PARITY_FRAMES];
+    for (int r = 0; r < num_rows; r++) {
+        for (int c = 0; c < num_missing; c++) {
+            m[r][c] = coef[rows[r]][missing[c]];
+        }
+    }
+    if (!gf_invert(m, num_missing)) return;
+
+    for (int c = 0; c < num_missing; c++) {
+        uint16_t seq = (uint16_t)(g->base_seq + missing[c]);
+        fec_slot_t *slot = &st->slots[seq & dec->mask];
+        memset(slot->block, 0, FEC_BLOCK_MAX);
+        for (int r = 0; r < num_rows; r++) {
+            gf_mul_add(slot->block, dec->syndrome[r], m[c][r], g->block_len);
+        }
+        slot->seq = seq;
+        slot->valid = true;
+
+        size_t len = ((size_t)slot->block[0] << 8) | slot->block[1];
+        if (len + 2 > g->block_len) {
+            ESP_LOGD(TAG, "Recovered frame seq=%u has bad length %u", seq, len);
+            slot->valid = false;
+            continue;
+        }
+        dec->stats.recovered++;
+        if (deliver) {
+            deliver(st->stream_id, g->data_type, seq, g->timestamp + missing[c] * AUDIO_FRAME_MS,
+                    slot->block + 2, len);
+        }
+    }
+    g->done = true;
+}
+
+void fec_decoder_add_data(fec_decoder_t *dec, uint8_t stream_id, uint8_t type, uint16_t seq,
+                          const uint8_t *payload, size_t len, fec_deliver_t deliver) {
+    if (!dec || !payload || len > FEC_MAX_PAYLOAD) return;
+
+    // The decoder keeps its own copy of every audio payload: the frame itself
+    // is played (and returned to the pool) long before its group's parity may
+    // need it
+    fec_stream_t *st = get_stream(dec, stream_id);
+    fec_slot_t *slot = &st->slots[seq & dec->mask];
+    size_t block_len = make_block(slot->block, payload, len);
+    memset(slot->block + block_len, 0, FEC_BLOCK_MAX - block_len);
+    slot->seq = seq;
+    slot->valid = true;
+
+    // A late audio frame may complete a group whose parity is already here
+    for (int g = 0; g < FEC_DECODER_GROUPS; g++) {
+        fec_group_t *grp = &st->groups[g];
+        if (grp->valid && !grp->done && (uint16_t)(seq - grp->base_seq) < grp->data_frames) {
+            try_recover(dec, st, grp, deliver);
+        }
+    }
+}
+
+void fec_decoder_add_parity(fec_decoder_t *dec, uint8_t stream_id, uint32_t timestamp,
+                            const uint8_t *payload, size_t len, fec_deliver_t deliver) {
+    if (!dec || !payload || len < NET_FEC_HEADER_SIZE) return;
+
+    net_fec_header_t hdr;
+    memcpy(&hdr, payload, NET_FEC_HEADER_SIZE);
+    uint16_t base_seq = ntohs(hdr.base_seq);
+    size_t block_len = ntohs(hdr.block_len);
+    if (hdr.data_frames == 0 || hdr.data_frames > dec->max_data ||
+        hdr.parity_frames == 0 || hdr.parity_frames > dec->max_parity ||
+        hdr.parity_index >= hdr.parity_frames ||
+        block_len < 2 || block_len > FEC_BLOCK_MAX || len < NET_FEC_HEADER_SIZE + block_len) {
+        ESP_LOGD(TAG, "Ignoring parity frame: N=%u K=%u idx=%u len=%u",
+                 hdr.data_frames, hdr.parity_frames, hdr.parity_index, block_len);
+        return;
+    }
+
+    fec_stream_t *st = get_stream(dec, stream_id);
+    fec_group_t *grp = NULL;
+    for (int g = 0; g < FEC_DECODER_GROUPS; g++) {
+        if (st->groups[g].valid && st->groups[g].base_seq == base_seq) {
+            grp = &st->groups[g];
+            break;
+        }
+    }
+    if (!grp) {
+        // Evict the older group; it is finished one way or the other
+        grp = &st->groups[st->next_group];
+        st->next_group = (st->next_group + 1) % FEC_DECODER_GROUPS;
+        if (grp->valid && !grp->done) {
+            dec->stats.unrecoverable++;
+        }
+        grp->valid = true;
+        grp->done = false;
+        grp->base_seq = base_seq;
+        grp->data_frames = hdr.data_frames;
+        grp->parity_frames = hdr.parity_frames;
+        grp->data_type = hdr.data_type;
+        grp->have = 0;
+        grp->timestamp = timestamp;
+        grp->block_len = block_len;
+        dec->stats.groups++;
+    }
+    if (block_len != grp->block_len || (grp->have & (1u << hdr.parity_index))) return;
+
+    memcpy(grp->parity[hdr.parity_index], payload + NET_FEC_HEADER_SIZE, block_len);
+    grp->have |= (uint8_t)(1u << hdr.parity_index);
+    try_recover(dec, st, grp, deliver);
+}
+
+void fec_decoder_get_stats(fec_decoder_t *dec, fec_stats_t *stats) {
+    if (dec && stats) *stats = dec->stats;
+}
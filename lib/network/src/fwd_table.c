@@ -0,0 +1,141 @@
+#include "network/fwd_table.h"
+#include "network/mesh_net.h"
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+
+static const char *TAG = "fwd_table";
+
+typedef struct {
+    uint8_t mac[6];
+    bool reported;
+    uint32_t report_ms;
+    uint8_t streams[NET_STREAM_BITMAP_BYTES];
+} fwd_child_t;
+
+struct fwd_table_t {
+    fwd_child_t *children;
+    size_t max;
+    size_t count;
+    portMUX_TYPE lock;
+};
+
+fwd_table_t* fwd_table_create(size_t max_children) {
+    if (max_children == 0) return NULL;
+
+    fwd_table_t *ft = calloc(1, sizeof(fwd_table_t));
+    if (!ft) return NULL;
+
+    ft->children = calloc(max_children, sizeof(fwd_child_t));
+    if (!ft->children) {
+        free(ft);
+        return NULL;
+    }
+
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    ft->lock = lock;
+    ft->max = max_children;
+    ESP_LOGD(TAG, "Forwarding table created: %u children", max_children);
+    return ft;
+}
+
+void fwd_table_destroy(fwd_table_t *ft) {
+    if (ft) {
+        free(ft->children);
+        free(ft);
+    }
+}
+
+void fwd_table_clear(fwd_table_t *ft) {
+    portENTER_CRITICAL(&ft->lock);
+    ft->count = 0;
+    portEXIT_CRITICAL(&ft->lock);
+}
+
+size_t fwd_table_count(fwd_table_t *ft) {
+    portENTER_CRITICAL(&ft->lock);
+    size_t count = ft->count;
+    portEXIT_CRITICAL(&ft->lock);
+    return count;
+}
+
+// Index of mac, or count if it is not a child (call under the lock)
+static size_t find_locked(const fwd_table_t *ft, const uint8_t *mac) {
+    size_t i = 0;
+    while (i < ft->count && memcmp(ft->children[i].mac, mac, 6) != 0) i++;
+    return i;
+}
+
+static inline bool child_wants(const fwd_child_t *child, int stream_id, uint32_t now_ms) {
+    if (stream_id == FWD_ALL_STREAMS || !child->reported ||
+        now_ms - child->report_ms > FWD_REPORT_TIMEOUT_MS) {
+        return true;
+    }
+    return child->streams[stream_id >> 3] & (1u << (stream_id & 7));
+}
+
+esp_err_t fwd_table_add(fwd_table_t *ft, const uint8_t *mac) {
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&ft->lock);
+    size_t i = find_locked(ft, mac);
+    if (i == ft->count) {
+        if (i < ft->max) {
+            memset(&ft->children[i], 0, sizeof(fwd_child_t));
+            memcpy(ft->children[i].mac, mac, 6);
+            ft->count++;
+        } else {
+            ret = ESP_ERR_NO_MEM;
+        }
+    }
+    portEXIT_CRITICAL(&ft->lock);
+    return ret;
+}
+
+void fwd_table_remove(fwd_table_t *ft, const uint8_t *mac) {
+    portENTER_CRITICAL(&ft->lock);
+    size_t i = find_locked(ft, mac);
+    if (i < ft->count) {
+        ft->children[i] = ft->children[--ft->count];
+    }
+    portEXIT_CRITICAL(&ft->lock);
+}
+
+bool fwd_table_report(fwd_table_t *ft, const uint8_t *mac, const uint8_t *streams, uint32_t now_ms) {
+    portENTER_CRITICAL(&ft->lock);
+    size_t i = find_locked(ft, mac);
+    bool found = i < ft->count;
+    if (found) {
+        memcpy(ft->children[i].streams, streams, NET_STREAM_BITMAP_BYTES);
+        ft->children[i].reported = true;
+        ft->children[i].report_ms = now_ms;
+    }
+    portEXIT_CRITICAL(&ft->lock);
+    return found;
+}
+
+size_t fwd_table_targets(fwd_table_t *ft, int stream_id, const uint8_t *exclude, uint32_t now_ms,
+                         uint8_t (*out)[6], size_t max_out) {
+    size_t count = 0;
+    portENTER_CRITICAL(&ft->lock);
+    for (size_t i = 0; i < ft->count && count < max_out; i++) {
+        const fwd_child_t *child = &ft->children[i];
+        if (exclude && memcmp(child->mac, exclude, 6) == 0) continue;
+        if (child_wants(child, stream_id, now_ms)) {
+            memcpy(out[count++], child->mac, 6);
+        }
+    }
+    portEXIT_CRITICAL(&ft->lock);
+    return count;
+}
+
+void fwd_table_subtree_streams(fwd_table_t *ft, uint32_t now_ms, uint8_t *streams) {
+    portENTER_CRITICAL(&ft->lock);
+    for (size_t i = 0; i < ft->count; i++) {
+        const fwd_child_t *child = &ft->children[i];
+        bool all = !child->reported || now_ms - child->report_ms > FWD_REPORT_TIMEOUT_MS;
+        for (int j = 0; j < NET_STREAM_BITMAP_BYTES; j++) {
+            streams[j] |= all ? 0xFF : child->streams[j];
+        }
+    }
+    portEXIT_CRITICAL(&ft->lock);
+}
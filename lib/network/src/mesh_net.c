@@ -1,4 +1,7 @@
 #include "network/mesh_net.h"
+#include "network/fec.h"
+#include "network/dedupe.h"
+#include "network/fwd_table.h"
 #include "config/build.h"
 #include <esp_log.h>
 #include <esp_wifi.h>
@@ -10,6 +13,7 @@
 #include <nvs_flash.h>
 #include <string.h>
 #include <esp_timer.h>
+#include <freertos/queue.h>
 #include <lwip/ip4_addr.h>
 
 static const char *TAG = "network_mesh";
@@ -48,20 +52,32 @@ static int waiting_task_count = 0;
 // 5. Audio transmission begins immediately without polling delays
 // Fully event-driven: no polling loops, all state transitions via events/notifications
 
-// Receive buffer for mesh packets
+// Packets are received straight into frame pool buffers so local delivery can keep
+// them without a copy; this scratch buffer only takes over while the pool is empty
+// (the packet is still forwarded, just not played locally)
 #define MESH_RX_BUFFER_SIZE 1500
 static uint8_t mesh_rx_buffer[MESH_RX_BUFFER_SIZE];
 
-// Duplicate suppression cache for broadcast forwarding
-#define DEDUPE_CACHE_SIZE 256  // Covers >1 second @ 200 fps
-typedef struct {
-    uint8_t stream_id;
-    uint16_t seq;
-    uint32_t timestamp_ms;
-} recent_frame_t;
+// Duplicate suppression for frames relayed down the tree (mesh relay task only)
+static dedupe_t *dedupe = NULL;
 
-static recent_frame_t dedupe_cache[DEDUPE_CACHE_SIZE];
-static int dedupe_index = 0;
+// Direct children and the streams each one's subtree plays (see fwd_table.h)
+#define MESH_FWD_MAX_CHILDREN  CONTROL_STATE_CACHE_MAX_NODES
+#define ANNOUNCE_TIMEOUT_MS    (3 * CONTROL_HEARTBEAT_RATE_MS)
+
+static fwd_table_t *fwd_table = NULL;
+static uint8_t local_streams[NET_STREAM_BITMAP_BYTES];     // Played here (audio callback)
+static uint8_t reported_streams[NET_STREAM_BITMAP_BYTES];  // Last report sent to the parent
+static portMUX_TYPE stream_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// NET_STREAM_AUTO: follow the first stream announced until it stops announcing
+static bool auto_follow = false;
+static uint8_t auto_stream_id = 0;
+static uint32_t auto_stream_ms = 0;
+
+static inline bool stream_bit(const uint8_t *bitmap, uint8_t stream_id) {
+    return bitmap[stream_id >> 3] & (1u << (stream_id & 7));
+}
 
 // Convert string MESH_ID to 6-byte mesh_addr_t with readable encoding
 static void mesh_id_from_string(const char *str, uint8_t *mesh_id) {
@@ -73,74 +89,183 @@ static void mesh_id_from_string(const char *str, uint8_t *mesh_id) {
     }
 }
 
-// Audio callback for received frames
-typedef void (*network_audio_callback_t)(const uint8_t *payload, size_t len, uint16_t seq, uint32_t timestamp);
+// Audio callback for received frames (per frame or batched)
 static network_audio_callback_t audio_rx_callback = NULL;
+static network_audio_batch_callback_t audio_rx_batch_callback = NULL;
+
+// Receive is split in two so relaying never waits on local playback: mesh_rx_task
+// (radio core, above the audio tasks) dedupes, forwards and queues the frames
+// this node plays; mesh_deliver_task drains that queue a batch per wakeup, runs
+// the FEC decoder and hands the batch to the audio callback (Opus decode, jitter
+// buffer). A full queue drops the local copy only - the frame has already gone
+// on to the subtree.
+#define MESH_RX_TASK_PRIO       10
+#define MESH_RX_TASK_CORE       0     // Wi-Fi task's core
+#define MESH_RX_TASK_STACK      4096
+#define MESH_DELIVER_TASK_PRIO  5
+#define MESH_DELIVER_TASK_STACK 12288 // Opus decode in the RX audio callback
+#define MESH_DELIVER_QUEUE_LEN  8     // 40 ms of one stream
+#define MESH_FEC_STREAMS        2     // Streams played at once with FEC (~12 KB each)
+
+static QueueHandle_t delivery_queue = NULL;    // network_rx_frame_t, each owning a frame reference
+
+// network_get_rx_stats: relay side written by mesh_rx_task, delivery side by mesh_deliver_task
+static network_rx_stats_t rx_stats;
+static uint64_t relay_us_total = 0;
+static uint64_t delivery_us_total = 0;
+static portMUX_TYPE rx_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Delivery task only: the batch being built, and the frame whose FEC add is
+// running (rebuilt frames take its arrival time)
+static network_rx_frame_t rx_batch[NETWORK_RX_BATCH_MAX];
+static size_t rx_batch_count = 0;
+static const network_rx_frame_t *fec_source = NULL;
+
+// Rebuilds lost audio frames from NET_PKT_TYPE_AUDIO_FEC parity, per stream (created with the callback)
+static fec_decoder_t *fec_decoder = NULL;
+
+#if AUDIO_FEC_ENABLED
+// TX/COMBO: parity over outgoing audio, sent by network_send_audio after each group
+static fec_encoder_t *fec_encoder = NULL;
+static uint8_t fec_tx_packet[NET_FEC_MAX_PACKET];
+#endif
 
 // Forward declarations
 static void mesh_event_handler(void *arg, esp_event_base_t event_base,
                                 int32_t event_id, void *event_data);
 static void mesh_rx_task(void *arg);
+static void mesh_deliver_task(void *arg);
 static void mesh_heartbeat_task(void *arg);
 static void mesh_root_timeout_callback(void *arg);  // Timer callback, not a task
-static bool is_duplicate(uint8_t stream_id, uint16_t seq);
-static void mark_seen(uint8_t stream_id, uint16_t seq);
-static void forward_to_children(const uint8_t *data, size_t len, const mesh_addr_t *sender);
+static void forward_to_children(const uint8_t *data, size_t len, const mesh_addr_t *sender, int stream_id);
 static void send_heartbeat(void);
 static void send_stream_announcement(void);
+static void send_subscription(bool refresh);
+static esp_err_t mesh_send_stream(const uint8_t *data, size_t len, int stream_id);
+static esp_err_t mesh_send_tods(const uint8_t *data, size_t len);
+static void send_fec_parity(const uint8_t *frame, size_t len);
 
-// Duplicate detection
-static bool is_duplicate(uint8_t stream_id, uint16_t seq) {
-    for (int i = 0; i < DEDUPE_CACHE_SIZE; i++) {
-        if (dedupe_cache[i].stream_id == stream_id && 
-            dedupe_cache[i].seq == seq) {
-            return true;  // Already seen this frame
-        }
-    }
-    return false;
-}
-
-static void mark_seen(uint8_t stream_id, uint16_t seq) {
-    dedupe_cache[dedupe_index].stream_id = stream_id;
-    dedupe_cache[dedupe_index].seq = seq;
-    dedupe_cache[dedupe_index].timestamp_ms = esp_timer_get_time() / 1000;
-    dedupe_index = (dedupe_index + 1) % DEDUPE_CACHE_SIZE;
-}
-
-// Forward frame to all children except sender
-static void forward_to_children(const uint8_t *data, size_t len, const mesh_addr_t *sender) {
-    if (!is_mesh_connected) return;
+// Forward frame to each direct child except sender; audio (stream_id >= 0) only
+// to children whose subtree subscribed to the stream
+static void forward_to_children(const uint8_t *data, size_t len, const mesh_addr_t *sender, int stream_id) {
+    if (!is_mesh_connected && !is_mesh_root) return;
     
-    // Get routing table (list of children)
-    mesh_addr_t route_table[10];
-    int route_table_size = 0;
+    // Snapshot the targets: esp_mesh_send can block, so not under the table lock
+    uint8_t children[MESH_FWD_MAX_CHILDREN][6];
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    size_t count = fwd_table_targets(fwd_table, stream_id, sender ? sender->addr : NULL, now_ms,
+                                     children, MESH_FWD_MAX_CHILDREN);
     
-    esp_mesh_get_routing_table(route_table, 10 * 6, &route_table_size);
-    
-    if (route_table_size == 0) {
-        return; // No children to forward to
+    if (count == 0) {
+        return; // No children (that want this stream) to forward to
     }
     
-    // Forward to each child except the sender
-    for (int i = 0; i < route_table_size; i++) {
-        // Don't echo back to sender
-        if (sender && memcmp(&route_table[i], sender, 6) == 0) {
-            continue;
-        }
-        
-        mesh_data_t mesh_data;
-        mesh_data.data = (uint8_t *)data;
-        mesh_data.size = len;
-        mesh_data.proto = MESH_PROTO_BIN;
-        mesh_data.tos = MESH_TOS_P2P;
-        
-        esp_err_t err = esp_mesh_send(&route_table[i], &mesh_data, MESH_DATA_P2P, NULL, 0);
+    mesh_data_t mesh_data;
+    mesh_data.data = (uint8_t *)data;
+    mesh_data.size = len;
+    mesh_data.proto = MESH_PROTO_BIN;
+    mesh_data.tos = MESH_TOS_P2P;
+    
+    for (size_t i = 0; i < count; i++) {
+        mesh_addr_t child;
+        memcpy(child.addr, children[i], 6);
+        esp_err_t err = esp_mesh_send(&child, &mesh_data, MESH_DATA_P2P, NULL, 0);
         if (err != ESP_OK) {
             ESP_LOGD(TAG, "Failed to forward to child: %s", esp_err_to_name(err));
         }
     }
 }
 
+// Mesh addresses are STA MACs; the parent's BSSID is its softAP MAC, which the
+// ESP32 derives as the STA MAC + 1
+static esp_err_t get_parent_addr(mesh_addr_t *parent) {
+    esp_err_t err = esp_mesh_get_parent_bssid(parent);
+    if (err != ESP_OK) return err;
+    for (int i = 5; i >= 0 && parent->addr[i]-- == 0; i--) {
+    }
+    return ESP_OK;
+}
+
+// Tell the parent which streams this subtree plays: the local subscriptions
+// plus every child's report (all streams for a child that has not reported).
+// Sent when that set changes, and on every heartbeat as a refresh.
+static void send_subscription(bool refresh) {
+    if (is_mesh_root || !is_mesh_connected) return;
+
+    struct __attribute__((packed)) {
+        net_frame_header_t hdr;
+        net_subscribe_t sub;
+    } pkt;
+    static uint16_t sub_seq = 0;
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+
+    portENTER_CRITICAL(&stream_lock);
+    memcpy(pkt.sub.streams, local_streams, NET_STREAM_BITMAP_BYTES);
+    portEXIT_CRITICAL(&stream_lock);
+    fwd_table_subtree_streams(fwd_table, now_ms, pkt.sub.streams);
+    portENTER_CRITICAL(&stream_lock);
+    bool changed = memcmp(pkt.sub.streams, reported_streams, NET_STREAM_BITMAP_BYTES) != 0;
+    memcpy(reported_streams, pkt.sub.streams, NET_STREAM_BITMAP_BYTES);
+    portEXIT_CRITICAL(&stream_lock);
+    if (!changed && !refresh) return;
+
+    mesh_addr_t parent;
+    if (get_parent_addr(&parent) != ESP_OK) return;
+
+    pkt.hdr.magic = NET_FRAME_MAGIC;
+    pkt.hdr.version = NET_FRAME_VERSION;
+    pkt.hdr.type = NET_PKT_TYPE_SUBSCRIBE;
+    pkt.hdr.stream_id = 0;
+    pkt.hdr.seq = htons(sub_seq++);
+    pkt.hdr.timestamp = htonl(now_ms);
+    pkt.hdr.payload_len = htons(sizeof(net_subscribe_t));
+    pkt.hdr.ttl = 0;                    // Parent only, never forwarded
+    memset(pkt.hdr.reserved, 0, sizeof(pkt.hdr.reserved));
+
+    mesh_data_t mesh_data;
+    mesh_data.data = (uint8_t *)&pkt;
+    mesh_data.size = sizeof(pkt);
+    mesh_data.proto = MESH_PROTO_BIN;
+    mesh_data.tos = MESH_TOS_DEF;       // Control priority
+    esp_err_t err = esp_mesh_send(&parent, &mesh_data, MESH_DATA_P2P, NULL, 0);
+    if (err != ESP_OK) {
+        ESP_LOGD(TAG, "Subscription report failed: %s", esp_err_to_name(err));
+    } else if (changed) {
+        ESP_LOGD(TAG, "Subscriptions reported to parent");
+    }
+}
+
+static void set_local_stream(uint8_t stream_id, bool subscribe) {
+    portENTER_CRITICAL(&stream_lock);
+    if (subscribe) {
+        local_streams[stream_id >> 3] |= (uint8_t)(1u << (stream_id & 7));
+    } else {
+        local_streams[stream_id >> 3] &= (uint8_t)~(1u << (stream_id & 7));
+    }
+    portEXIT_CRITICAL(&stream_lock);
+}
+
+// Auto mode: take the announced stream if nothing is followed yet or the
+// followed stream stopped announcing
+static void follow_announced_stream(uint8_t stream_id) {
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    if (stream_id == auto_stream_id) {
+        auto_stream_ms = now_ms;
+        return;
+    }
+    if (auto_stream_id != 0 && now_ms - auto_stream_ms <= ANNOUNCE_TIMEOUT_MS) {
+        return;
+    }
+    if (auto_stream_id != 0) {
+        set_local_stream(auto_stream_id, false);
+    }
+    ESP_LOGI(TAG, "Following stream %u", stream_id);
+    auto_stream_id = stream_id;
+    auto_stream_ms = now_ms;
+    set_local_stream(stream_id, true);
+    send_subscription(false);
+}
+
 // Mesh event handler
 static void mesh_event_handler(void *arg, esp_event_base_t event_base,
                                 int32_t event_id, void *event_data) {
@@ -152,6 +277,7 @@ static void mesh_event_handler(void *arg, esp_event_base_t event_base,
         case MESH_EVENT_STOPPED:
             ESP_LOGI(TAG, "Mesh stopped");
             is_mesh_connected = false;
+            fwd_table_clear(fwd_table);
             break;
             
         case MESH_EVENT_PARENT_CONNECTED: {
@@ -176,15 +302,36 @@ static void mesh_event_handler(void *arg, esp_event_base_t event_base,
             is_mesh_connected = false;
             break;
             
-        case MESH_EVENT_CHILD_CONNECTED:
-            ESP_LOGI(TAG, "Child connected");
+        case MESH_EVENT_CHILD_CONNECTED: {
+            mesh_event_child_connected_t *child = (mesh_event_child_connected_t *)event_data;
+            if (fwd_table_add(fwd_table, child->mac) != ESP_OK) {
+                ESP_LOGW(TAG, "Forwarding table full (%d children), " MACSTR " gets no audio",
+                         MESH_FWD_MAX_CHILDREN, MAC2STR(child->mac));
+            }
+            ESP_LOGI(TAG, "Child connected: " MACSTR " (%u direct)", MAC2STR(child->mac),
+                     (unsigned)fwd_table_count(fwd_table));
             mesh_children_count = esp_mesh_get_routing_table_size();
             break;
+        }
         
-        case MESH_EVENT_CHILD_DISCONNECTED:
-            ESP_LOGI(TAG, "Child disconnected");
+        case MESH_EVENT_CHILD_DISCONNECTED: {
+            mesh_event_child_disconnected_t *child = (mesh_event_child_disconnected_t *)event_data;
+            fwd_table_remove(fwd_table, child->mac);
+            ESP_LOGI(TAG, "Child disconnected: " MACSTR " (%u direct)", MAC2STR(child->mac),
+                     (unsigned)fwd_table_count(fwd_table));
             mesh_children_count = esp_mesh_get_routing_table_size();
             break;
+        }
+        
+        case MESH_EVENT_ROUTING_TABLE_ADD:
+        case MESH_EVENT_ROUTING_TABLE_REMOVE: {
+            // Grandchildren joining or leaving change the subtree, not the forwarding table
+            mesh_event_routing_table_change_t *change = (mesh_event_routing_table_change_t *)event_data;
+            mesh_children_count = change->rt_size_new;
+            ESP_LOGD(TAG, "Routing table %s %u, now %u", event_id == MESH_EVENT_ROUTING_TABLE_ADD ? "+" : "-",
+                     change->rt_size_change, change->rt_size_new);
+            break;
+        }
         
         case MESH_EVENT_ROOT_FIXED:
             ESP_LOGI(TAG, "Became mesh root");
@@ -308,13 +455,22 @@ static void mesh_rx_task(void *arg) {
     mesh_addr_t from;
     mesh_data_t data;
     int flag = 0;
+    audio_frame_t *rx_frame = NULL;  // Reused until a packet is delivered locally
     
     ESP_LOGI(TAG, "Mesh RX task started");
     
     while (1) {
         // Set up receive buffer
-        data.data = mesh_rx_buffer;
-        data.size = MESH_RX_BUFFER_SIZE;
+        if (!rx_frame) {
+            rx_frame = frame_pool_alloc(0);
+        }
+        if (rx_frame) {
+            data.data = rx_frame->buf;
+            data.size = FRAME_POOL_BUF_BYTES;
+        } else {
+            data.data = mesh_rx_buffer;
+            data.size = MESH_RX_BUFFER_SIZE;
+        }
         
         // Blocking receive with infinite timeout
         err = esp_mesh_recv(&from, &data, portMAX_DELAY, &flag, NULL, 0);
@@ -341,15 +497,18 @@ static void mesh_rx_task(void *arg) {
         }
         
         uint16_t seq = ntohs(hdr->seq);
+        int64_t arrival_us = esp_timer_get_time();
         
-        // Check for audio frames
-        if (hdr->type == NET_PKT_TYPE_AUDIO_RAW) {
+        // Check for audio frames (raw PCM, Opus or FEC parity - relays forward them unchanged
+        // to the children that subscribed to the stream)
+        if (hdr->type == NET_PKT_TYPE_AUDIO_RAW || hdr->type == NET_PKT_TYPE_AUDIO_OPUS ||
+            hdr->type == NET_PKT_TYPE_AUDIO_FEC) {
             // Duplicate suppression for broadcast
-            if (is_duplicate(hdr->stream_id, seq)) {
+            if (dedupe_check(dedupe, hdr->stream_id, hdr->type == NET_PKT_TYPE_AUDIO_FEC, seq,
+                             (uint32_t)(arrival_us / 1000))) {
                 ESP_LOGD(TAG, "Duplicate frame stream=%u seq=%u, dropping", hdr->stream_id, seq);
                 continue;
             }
-            mark_seen(hdr->stream_id, seq);
             
             // Check TTL - drop if expired
             if (hdr->ttl == 0) {
@@ -357,16 +516,50 @@ static void mesh_rx_task(void *arg) {
                 continue;
             }
             
-            // Decrement TTL and forward to children (tree broadcast)
+            // Decrement TTL and forward down the subscribed branches
             hdr->ttl--;
-            forward_to_children(data.data, data.size, &from);
+            forward_to_children(data.data, data.size, &from, hdr->stream_id);
+            
+            uint32_t relay_us = (uint32_t)(esp_timer_get_time() - arrival_us);
+            portENTER_CRITICAL(&rx_stats_lock);
+            rx_stats.relayed++;
+            relay_us_total += relay_us;
+            if (relay_us > rx_stats.relay_max_us) rx_stats.relay_max_us = relay_us;
+            portEXIT_CRITICAL(&rx_stats_lock);
             
-            // Call audio callback if registered (for RX nodes)
-            if (audio_rx_callback && data.size > NET_FRAME_HEADER_SIZE) {
-                uint8_t *payload = data.data + NET_FRAME_HEADER_SIZE;
+            // Queue it for local delivery if this node plays the stream (RX nodes)
+            if (!delivery_queue || !stream_bit(local_streams, hdr->stream_id)) {
+                // Not played here: relayed for a descendant only
+            } else if (!rx_frame) {
+                ESP_LOGD(TAG, "Frame pool empty, seq=%u forwarded only", seq);
+            } else if (data.size > NET_FRAME_HEADER_SIZE) {
                 uint16_t payload_len = ntohs(hdr->payload_len);
-                uint32_t timestamp = ntohl(hdr->timestamp);
-                audio_rx_callback(payload, payload_len, seq, timestamp);
+                if (payload_len > data.size - NET_FRAME_HEADER_SIZE) {
+                    ESP_LOGD(TAG, "Truncated frame seq=%u (%u > %u bytes)", seq, payload_len,
+                             data.size - NET_FRAME_HEADER_SIZE);
+                } else {
+                    // Hand over the payload in place, frame and all
+                    rx_frame->data = data.data + NET_FRAME_HEADER_SIZE;
+                    rx_frame->len = payload_len;
+                    network_rx_frame_t delivery = {
+                        .frame = rx_frame,
+                        .type = hdr->type,
+                        .stream_id = hdr->stream_id,
+                        .seq = seq,
+                        .timestamp = ntohl(hdr->timestamp),
+                        .arrival_us = arrival_us,
+                    };
+                    if (xQueueSend(delivery_queue, &delivery, 0) == pdTRUE) {
+                        rx_frame = NULL;
+                    } else {
+                        portENTER_CRITICAL(&rx_stats_lock);
+                        uint32_t drops = ++rx_stats.delivery_drops;
+                        portEXIT_CRITICAL(&rx_stats_lock);
+                        if ((drops & 0x3F) == 1) {
+                            ESP_LOGW(TAG, "Local delivery behind, %lu frames dropped", drops);
+                        }
+                    }
+                }
             }
             
             ESP_LOGD(TAG, "Audio frame stream=%u seq=%u ttl=%u received", hdr->stream_id, seq, hdr->ttl);
@@ -374,8 +567,110 @@ static void mesh_rx_task(void *arg) {
             // Heartbeat messages - log for debugging
             ESP_LOGD(TAG, "Heartbeat received");
         } else if (hdr->type == NET_PKT_TYPE_STREAM_ANNOUNCE) {
-            // Stream announcement - log for debugging
-            ESP_LOGD(TAG, "Stream announcement received");
+            // Stream announcements go to every node (that is how RX finds streams)
+            if (hdr->ttl == 0) continue;
+            hdr->ttl--;
+            forward_to_children(data.data, data.size, &from, FWD_ALL_STREAMS);
+            if (data.size >= NET_FRAME_HEADER_SIZE + sizeof(mesh_stream_announce_t)) {
+                const mesh_stream_announce_t *announce =
+                    (const mesh_stream_announce_t *)(data.data + NET_FRAME_HEADER_SIZE);
+                ESP_LOGD(TAG, "Stream announcement received: ID=%u", announce->stream_id);
+                if (auto_follow && delivery_queue) {
+                    follow_announced_stream(announce->stream_id);
+                }
+            }
+        } else if (hdr->type == NET_PKT_TYPE_SUBSCRIBE) {
+            if (data.size < NET_FRAME_HEADER_SIZE + sizeof(net_subscribe_t)) continue;
+            const net_subscribe_t *report = (const net_subscribe_t *)(data.data + NET_FRAME_HEADER_SIZE);
+            if (fwd_table_report(fwd_table, from.addr, report->streams, (uint32_t)(arrival_us / 1000))) {
+                send_subscription(false);   // Pass changes up right away
+            } else {
+                ESP_LOGD(TAG, "Subscription report from non-child " MACSTR, MAC2STR(from.addr));
+            }
+        }
+    }
+}
+
+static void deliver_batch(void) {
+    int64_t now_us = esp_timer_get_time();
+    uint64_t delay_total = 0;
+    uint32_t delay_max = 0;
+    for (size_t i = 0; i < rx_batch_count; i++) {
+        uint32_t delay = (uint32_t)(now_us - rx_batch[i].arrival_us);
+        delay_total += delay;
+        if (delay > delay_max) delay_max = delay;
+    }
+    portENTER_CRITICAL(&rx_stats_lock);
+    rx_stats.delivered += rx_batch_count;
+    delivery_us_total += delay_total;
+    if (delay_max > rx_stats.delivery_max_us) rx_stats.delivery_max_us = delay_max;
+    portEXIT_CRITICAL(&rx_stats_lock);
+    
+    if (audio_rx_batch_callback) {
+        audio_rx_batch_callback(rx_batch, rx_batch_count);
+    } else if (audio_rx_callback) {
+        // The callback refs a frame if it keeps it
+        for (size_t i = 0; i < rx_batch_count; i++) {
+            audio_rx_callback(rx_batch[i].type, rx_batch[i].frame, rx_batch[i].seq, rx_batch[i].timestamp);
+        }
+    }
+    for (size_t i = 0; i < rx_batch_count; i++) {
+        frame_pool_unref(rx_batch[i].frame);
+    }
+    rx_batch_count = 0;
+}
+
+// FEC decoder output: the rebuilt payload is only valid for this call, so it
+// is copied into a pool frame that joins the batch
+static void batch_add_rebuilt(uint8_t stream_id, uint8_t type, uint16_t seq, uint32_t timestamp,
+                              const uint8_t *payload, size_t len) {
+    audio_frame_t *frame = frame_pool_alloc(0);
+    if (!frame) return;
+    memcpy(frame->data, payload, len);
+    frame->len = len;
+    if (rx_batch_count == NETWORK_RX_BATCH_MAX) {
+        deliver_batch();
+    }
+    rx_batch[rx_batch_count++] = (network_rx_frame_t){
+        .frame = frame,
+        .type = type,
+        .stream_id = stream_id,
+        .seq = seq,
+        .timestamp = timestamp,
+        .arrival_us = fec_source->arrival_us,
+    };
+}
+
+// Local delivery task - wakes on the first queued frame, drains whatever else
+// is queued, and delivers it all as one batch. Parity only feeds the FEC
+// decoder, whose rebuilt frames are added to the batch.
+static void mesh_deliver_task(void *arg) {
+    network_rx_frame_t d;
+    
+    ESP_LOGI(TAG, "Mesh delivery task started");
+    
+    while (1) {
+        if (xQueueReceive(delivery_queue, &d, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        do {
+            fec_source = &d;
+            if (d.type == NET_PKT_TYPE_AUDIO_FEC) {
+                fec_decoder_add_parity(fec_decoder, d.stream_id, d.timestamp, d.frame->data, d.frame->len,
+                                       batch_add_rebuilt);
+                frame_pool_unref(d.frame);
+            } else {
+                if (rx_batch_count == NETWORK_RX_BATCH_MAX) {
+                    deliver_batch();
+                }
+                rx_batch[rx_batch_count++] = d;   // The queue's reference moves to the batch
+                fec_decoder_add_data(fec_decoder, d.stream_id, d.type, d.seq, d.frame->data, d.frame->len,
+                                     batch_add_rebuilt);
+            }
+        } while (xQueueReceive(delivery_queue, &d, 0) == pdTRUE);
+        
+        if (rx_batch_count > 0) {
+            deliver_batch();
         }
     }
 }
@@ -384,6 +679,15 @@ static void mesh_rx_task(void *arg) {
 esp_err_t network_init_mesh(void) {
     ESP_LOGI(TAG, "Initializing ESP-WIFI-MESH");
     
+    ESP_ERROR_CHECK(frame_pool_init());
+    
+    dedupe = dedupe_create();
+    fwd_table = fwd_table_create(MESH_FWD_MAX_CHILDREN);
+    if (!dedupe || !fwd_table) {
+        ESP_LOGE(TAG, "Failed to allocate forwarding state");
+        return ESP_ERR_NO_MEM;
+    }
+    
     // Determine node role based on build environment
     #if defined(CONFIG_TX_BUILD) || defined(CONFIG_COMBO_BUILD)
         my_node_role = NODE_ROLE_TX;
@@ -396,7 +700,16 @@ esp_err_t network_init_mesh(void) {
     // Generate unique stream ID from MAC address (for TX/COMBO nodes)
     uint8_t mac[6];
     esp_read_mac(mac, ESP_MAC_WIFI_STA);
-    my_stream_id = mac[5];  // Use last byte of MAC as stream ID
+    my_stream_id = mac[5] ? mac[5] : 1;  // Use last byte of MAC as stream ID (0 is NET_STREAM_AUTO)
+    
+#if AUDIO_FEC_ENABLED
+    if (my_node_role == NODE_ROLE_TX) {
+        fec_encoder = fec_encoder_create(FEC_DATA_FRAMES, FEC_PARITY_FRAMES);
+        if (!fec_encoder) {
+            ESP_LOGW(TAG, "FEC encoder unavailable, sending audio without parity");
+        }
+    }
+#endif
     
     // Initialize NVS
     esp_err_t ret = nvs_flash_init();
@@ -504,8 +817,9 @@ esp_err_t network_init_mesh(void) {
       
       ESP_LOGI(TAG, "Mesh initialized: ID=%s, Channel=%d", MESH_ID, MESH_CHANNEL);
       
-      // Start receive task
-      xTaskCreate(mesh_rx_task, "mesh_rx", 4096, NULL, 5, NULL);
+      // Start receive/relay task; local delivery starts with the audio callback
+      xTaskCreatePinnedToCore(mesh_rx_task, "mesh_rx", MESH_RX_TASK_STACK, NULL,
+                              MESH_RX_TASK_PRIO, NULL, MESH_RX_TASK_CORE);
       
       // Start heartbeat task (2 second interval) - will be notified when ready
       xTaskCreate(mesh_heartbeat_task, "mesh_hb", 3072, NULL, 4, &heartbeat_task_handle);
@@ -548,22 +862,47 @@ static void send_stream_announcement(void) {
     if (my_node_role != NODE_ROLE_TX) {
         return;  // Only TX/COMBO nodes send stream announcements
     }
+    if (!is_mesh_connected && !(is_mesh_root && is_mesh_root_ready)) {
+        return;
+    }
+    
+    // Framed like audio so relays pass it down the tree to every RX
+    struct __attribute__((packed)) {
+        net_frame_header_t hdr;
+        mesh_stream_announce_t announce;
+    } pkt;
+    static uint16_t announce_seq = 0;
+    static bool announced = false;
     
-    mesh_stream_announce_t announce;
-    announce.type = NET_PKT_TYPE_STREAM_ANNOUNCE;
-    announce.stream_id = my_stream_id;
-    announce.sample_rate = htonl(AUDIO_SAMPLE_RATE);
-    announce.channels = AUDIO_CHANNELS;
-    announce.bits_per_sample = AUDIO_BITS_PER_SAMPLE;
-    announce.frame_size_ms = htons(AUDIO_FRAME_MS);
+    pkt.hdr.magic = NET_FRAME_MAGIC;
+    pkt.hdr.version = NET_FRAME_VERSION;
+    pkt.hdr.type = NET_PKT_TYPE_STREAM_ANNOUNCE;
+    pkt.hdr.stream_id = my_stream_id;
+    pkt.hdr.seq = htons(announce_seq++);
+    pkt.hdr.timestamp = htonl((uint32_t)(esp_timer_get_time() / 1000));
+    pkt.hdr.payload_len = htons(sizeof(mesh_stream_announce_t));
+    pkt.hdr.ttl = 6;  // Max 6 hops, as audio
+    memset(pkt.hdr.reserved, 0, sizeof(pkt.hdr.reserved));
     
-    esp_err_t err = network_send_control((uint8_t *)&announce, sizeof(announce));
+    mesh_stream_announce_t *announce = &pkt.announce;
+    announce->type = NET_PKT_TYPE_STREAM_ANNOUNCE;
+    announce->stream_id = my_stream_id;
+    announce->sample_rate = htonl(AUDIO_SAMPLE_RATE);
+    announce->channels = AUDIO_CHANNELS;
+    announce->bits_per_sample = AUDIO_BITS_PER_SAMPLE;
+    announce->frame_size_ms = htons(AUDIO_FRAME_MS);
+    announce->codec = AUDIO_CODEC_OPUS ? NET_PKT_TYPE_AUDIO_OPUS : NET_PKT_TYPE_AUDIO_RAW;
+    announce->reserved = 0;
+    
+    esp_err_t err = mesh_send_stream((uint8_t *)&pkt, sizeof(pkt), FWD_ALL_STREAMS);
     if (err != ESP_OK && err != ESP_ERR_MESH_NO_ROUTE_FOUND) {
         ESP_LOGD(TAG, "Failed to send stream announcement: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "Stream announced: ID=%u, %uHz, %u-bit, %uch, %ums frames", 
-                 announce.stream_id, (unsigned int)AUDIO_SAMPLE_RATE, AUDIO_BITS_PER_SAMPLE, 
-                 AUDIO_CHANNELS, (unsigned int)AUDIO_FRAME_MS);
+    } else if (!announced) {
+        announced = true;
+        ESP_LOGI(TAG, "Stream announced: ID=%u, %uHz, %u-bit, %uch, %ums frames, %s", 
+                 announce->stream_id, (unsigned int)AUDIO_SAMPLE_RATE, AUDIO_BITS_PER_SAMPLE, 
+                 AUDIO_CHANNELS, (unsigned int)AUDIO_FRAME_MS,
+                 announce->codec == NET_PKT_TYPE_AUDIO_OPUS ? "opus" : "raw");
     }
 }
 
@@ -599,11 +938,12 @@ static void mesh_heartbeat_task(void *arg) {
         ESP_LOGI(TAG, "Network ready - sending heartbeats");
     }
     
-    // Send initial stream announcement (TX/COMBO only)
-    send_stream_announcement();
-    
     while (1) {
         send_heartbeat();
+        // Re-announced every interval so nodes that join later find the stream
+        // (TX/COMBO only), and subscriptions refreshed before the parent expires them
+        send_stream_announcement();
+        send_subscription(true);
         vTaskDelay(pdMS_TO_TICKS(HEARTBEAT_INTERVAL_MS));
     }
 }
@@ -636,6 +976,23 @@ esp_err_t network_send_audio(const uint8_t *data, size_t len) {
         return ESP_ERR_INVALID_STATE;
     }
     
+    const net_frame_header_t *hdr = (const net_frame_header_t *)data;
+    esp_err_t err = mesh_send_stream(data, len, len >= NET_FRAME_HEADER_SIZE ? hdr->stream_id : FWD_ALL_STREAMS);
+    send_fec_parity(data, len);
+    return err;
+}
+
+// The root hands its own frames straight to the subscribed children, like any
+// relay; other nodes send them up to the root
+static esp_err_t mesh_send_stream(const uint8_t *data, size_t len, int stream_id) {
+    if (is_mesh_root) {
+        forward_to_children(data, len, NULL, stream_id);
+        return ESP_OK;
+    }
+    return mesh_send_tods(data, len);
+}
+
+static esp_err_t mesh_send_tods(const uint8_t *data, size_t len) {
     mesh_data_t mesh_data;
     mesh_data.data = (uint8_t *)data;
     mesh_data.size = len;
@@ -655,6 +1012,38 @@ esp_err_t network_send_audio(const uint8_t *data, size_t len) {
     return err;
 }
 
+// Feed an outgoing audio frame to the FEC encoder; once it completes a group,
+// send the group's parity frames with the audio frame's stream_id and TTL
+static void send_fec_parity(const uint8_t *frame, size_t len) {
+#if AUDIO_FEC_ENABLED
+    if (!fec_encoder || len < NET_FRAME_HEADER_SIZE) return;
+
+    const net_frame_header_t *hdr = (const net_frame_header_t *)frame;
+    if (hdr->type != NET_PKT_TYPE_AUDIO_RAW && hdr->type != NET_PKT_TYPE_AUDIO_OPUS) return;
+    size_t payload_len = ntohs(hdr->payload_len);
+    if (payload_len > len - NET_FRAME_HEADER_SIZE) return;
+
+    int parity_count = fec_encoder_add(fec_encoder, hdr->type, ntohs(hdr->seq), ntohl(hdr->timestamp),
+                                       frame + NET_FRAME_HEADER_SIZE, payload_len);
+    for (int j = 0; j < parity_count; j++) {
+        size_t fec_len = 0;
+        uint16_t seq = 0;
+        uint32_t timestamp = 0;
+        if (fec_encoder_get_parity(fec_encoder, (uint8_t)j, fec_tx_packet + NET_FRAME_HEADER_SIZE,
+                                   &fec_len, &seq, &timestamp) != ESP_OK) {
+            break;
+        }
+        net_frame_header_t fec_hdr = *hdr;
+        fec_hdr.type = NET_PKT_TYPE_AUDIO_FEC;
+        fec_hdr.seq = htons(seq);
+        fec_hdr.timestamp = htonl(timestamp);
+        fec_hdr.payload_len = htons((uint16_t)fec_len);
+        memcpy(fec_tx_packet, &fec_hdr, NET_FRAME_HEADER_SIZE);
+        mesh_send_stream(fec_tx_packet, NET_FRAME_HEADER_SIZE + fec_len, fec_hdr.stream_id);
+    }
+#endif
+}
+
 // Send control message via mesh
 esp_err_t network_send_control(const uint8_t *data, size_t len) {
     // Allow sending if: (1) connected as child, or (2) root AND ready
@@ -707,15 +1096,91 @@ bool network_is_stream_ready(void) {
     return is_mesh_connected || (is_mesh_root && is_mesh_root_ready);
 }
 
+uint8_t network_get_stream_id(void) {
+    return my_stream_id;
+}
+
 uint32_t network_get_connected_nodes(void) {
     // This is an approximation - in true mesh, we'd need to query all nodes
     return mesh_children_count + 1;
 }
 
+esp_err_t network_subscribe_stream(uint8_t stream_id) {
+    if (stream_id == NET_STREAM_AUTO) {
+        auto_follow = true;
+        ESP_LOGI(TAG, "Following the first stream announced");
+        return ESP_OK;
+    }
+    set_local_stream(stream_id, true);
+    ESP_LOGI(TAG, "Subscribed to stream %u", stream_id);
+    send_subscription(false);
+    return ESP_OK;
+}
+
+esp_err_t network_unsubscribe_stream(uint8_t stream_id) {
+    if (stream_id == NET_STREAM_AUTO) {
+        auto_follow = false;
+        stream_id = auto_stream_id;
+        auto_stream_id = 0;
+        if (stream_id == 0) return ESP_OK;
+    }
+    set_local_stream(stream_id, false);
+    send_subscription(false);
+    return ESP_OK;
+}
+
+// Decoder and delivery task for the first audio callback registered
+static esp_err_t start_local_delivery(void) {
+    if (!fec_decoder) {
+        // Sized for this build's group shape; parity for larger groups is ignored
+        fec_decoder = fec_decoder_create(FEC_DATA_FRAMES, FEC_PARITY_FRAMES, MESH_FEC_STREAMS);
+        if (!fec_decoder) {
+            ESP_LOGW(TAG, "FEC decoder unavailable, lost frames will not be rebuilt");
+        }
+    }
+    if (!delivery_queue) {
+        delivery_queue = xQueueCreate(MESH_DELIVER_QUEUE_LEN, sizeof(network_rx_frame_t));
+        if (!delivery_queue) {
+            return ESP_ERR_NO_MEM;
+        }
+        if (xTaskCreate(mesh_deliver_task, "mesh_deliver", MESH_DELIVER_TASK_STACK, NULL,
+                        MESH_DELIVER_TASK_PRIO, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create mesh delivery task");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
 // Register callback for audio frame reception (used by RX nodes)
 esp_err_t network_register_audio_callback(network_audio_callback_t callback) {
     audio_rx_callback = callback;
     ESP_LOGI(TAG, "Audio callback registered");
+    return start_local_delivery();
+}
+
+esp_err_t network_register_audio_batch_callback(network_audio_batch_callback_t callback) {
+    audio_rx_batch_callback = callback;
+    ESP_LOGI(TAG, "Audio batch callback registered");
+    return start_local_delivery();
+}
+
+esp_err_t network_get_fec_stats(fec_stats_t *stats) {
+    if (!stats) return ESP_ERR_INVALID_ARG;
+    if (!fec_decoder) return ESP_ERR_INVALID_STATE;
+    fec_decoder_get_stats(fec_decoder, stats);
+    return ESP_OK;
+}
+
+esp_err_t network_get_rx_stats(network_rx_stats_t *stats) {
+    if (!stats) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&rx_stats_lock);
+    *stats = rx_stats;
+    uint64_t relay_total = relay_us_total;
+    uint64_t delivery_total = delivery_us_total;
+    portEXIT_CRITICAL(&rx_stats_lock);
+    stats->relay_avg_us = stats->relayed ? (uint32_t)(relay_total / stats->relayed) : 0;
+    stats->delivery_avg_us = stats->delivered ? (uint32_t)(delivery_total / stats->delivered) : 0;
     return ESP_OK;
 }
 
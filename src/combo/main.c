@@ -1,9 +1,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
-#include <freertos/semphr.h>
 #include <esp_log.h>
 #include <esp_task_wdt.h>
-#include <esp_timer.h>
 #include <esp_mesh.h>
 #include <esp_adc/adc_oneshot.h>
 #include <esp_adc/adc_cali.h>
@@ -17,10 +15,15 @@
 #include "control/buttons.h"
 #include "control/status.h"
 #include "audio/tone_gen.h"
+#include "audio/pcm_convert.h"
 #include "audio/usb_audio.h"
 #include "audio/adc_audio.h"
+#include "audio/level_meter.h"
+#include "audio/gain_stage.h"
 #include "audio/i2s_audio.h"  // Added for UDA1334 output
+#include "audio/opus_codec.h"
 #include "audio/ring_buffer.h"
+#include "audio/frame_scheduler.h"
 #include "network/mesh_net.h"
 
 static const char *TAG = "combo_main";
@@ -28,36 +31,12 @@ static const char *TAG = "combo_main";
 // Compile-time check for v0.1 audio format
 _Static_assert(AUDIO_BITS_PER_SAMPLE == 24 && AUDIO_CHANNELS == 1, "v0.1 requires 24-bit mono");
 
-// Audio format conversion helpers: 16-bit → 24-bit packed (S24LE)
-static inline void s24le_pack(int32_t s24, uint8_t* out) {
-    out[0] = (uint8_t)(s24 & 0xFF);
-    out[1] = (uint8_t)((s24 >> 8) & 0xFF);
-    out[2] = (uint8_t)((s24 >> 16) & 0xFF);
-}
-
-static void pcm16_mono_to_pcm24_mono_pack(const int16_t* in, size_t frames, uint8_t* out) {
-    for (size_t i = 0; i < frames; i++) {
-        int32_t s24 = ((int32_t)in[i]) << 8;  // 16→24 bit zero-pad LSBs
-        s24le_pack(s24, &out[i * 3]);
-    }
-}
+// Frames produced so far (throttles per-frame logging)
+static uint32_t combo_frames = 0;
+static volatile uint32_t combo_bytes_sent = 0;  // Running total, rate computed by the control task
 
-static void pcm16_stereo_to_pcm24_mono_pack(const int16_t* in_lr, size_t frames, uint8_t* out) {
-    for (size_t i = 0; i < frames; i++) {
-        // Mono = average L+R (simple downmix)
-        int32_t m = ((int32_t)in_lr[i*2] + (int32_t)in_lr[i*2 + 1]) >> 1;
-        int32_t s24 = m << 8;
-        s24le_pack(s24, &out[i * 3]);
-    }
-}
-
-// Timer for 1ms pacing
-static SemaphoreHandle_t combo_timer_sem = NULL;
-static uint32_t ms_tick = 0;
-
-static void combo_timer_callback(void* arg) {
-    xSemaphoreGive(combo_timer_sem);
-}
+// Housekeeping period: buttons, tone sweep, stats and display run here, off the audio path
+#define COMBO_CONTROL_PERIOD_MS 5
 
 static combo_status_t status = {
 .input_mode = INPUT_MODE_TONE,
@@ -67,7 +46,8 @@ static combo_status_t status = {
 .bandwidth_kbps = 0,
 .rssi = 0,
 .tone_freq_hz = 110,
-.output_volume = 1.0f
+.output_volume = 1.0f,
+.input_level_dbfs = -96
 };
 
 static display_view_t current_view = DISPLAY_VIEW_AUDIO;  // Default to audio view
@@ -75,16 +55,19 @@ static ring_buffer_t *audio_buffer = NULL;
 
 // Global audio buffers to reduce stack usage
 static int16_t mono_frame[AUDIO_FRAME_SAMPLES];
+static level_meter_t *aux_meter = NULL;  // AUX level telemetry and signal gate
+static gain_stage_t *monitor_gain = NULL;  // Local I2S monitor volume (status.output_volume)
 static int16_t stereo_frame[AUDIO_FRAME_SAMPLES * 2];
-static uint8_t packet_buffer[AUDIO_FRAME_BYTES];  // 24-bit packed mono for network
-static uint8_t framed_buffer[NET_FRAME_HEADER_SIZE + AUDIO_FRAME_BYTES];
+static uint8_t framed_buffer[NET_FRAME_HEADER_SIZE + AUDIO_FRAME_BYTES] __attribute__((aligned(4)));  // Payload word-aligned for pcm_convert
+// Capture converts straight into the payload slot of framed_buffer (no copy before send)
+static uint8_t *const packet_buffer = framed_buffer + NET_FRAME_HEADER_SIZE;  // 24-bit packed mono
 
 // Auto-oscillate tone frequency between 300-700 Hz
 void update_tone_oscillate(void) {
     static uint32_t last_log = 0;
     
     // Oscillate over 4 seconds (200ms per frame = 20 frames = 4s for full sweep)
-    uint32_t phase = (ms_tick / 20) % 200;  // 0-199 over 4 seconds
+    uint32_t phase = ((xTaskGetTickCount() * portTICK_PERIOD_MS) / 20) % 200;  // 0-199 over 4 seconds
     float ratio = (float)phase / 200.0f;  // 0.0 to 1.0
     
     // Use sine wave for smooth oscillation
@@ -107,6 +90,76 @@ void update_tone_oscillate(void) {
     }
 }
 
+// Frame clock for each input: the source's own sample clock where there is one
+static frame_clock_t frame_clock_for_mode(input_mode_t mode) {
+    // USB is an asynchronous sink: the device clock (timer) paces it and the
+    // feedback endpoint makes the host follow, so there is no SOF clock to track
+    return (mode == INPUT_MODE_AUX) ? FRAME_CLOCK_ADC : FRAME_CLOCK_TIMER;
+}
+
+static void combo_control_task(void *arg) {
+    uint32_t last_stats_update = xTaskGetTickCount();
+    uint32_t last_bytes_sent = combo_bytes_sent;
+    uint32_t last_display_update = 0;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(COMBO_CONTROL_PERIOD_MS));
+
+        // Handle button events
+        button_event_t btn_event = buttons_poll();
+        if (btn_event == BUTTON_EVENT_SHORT_PRESS) {
+            current_view = (current_view == DISPLAY_VIEW_NETWORK) ?
+                          DISPLAY_VIEW_AUDIO : DISPLAY_VIEW_NETWORK;
+            ESP_LOGI(TAG, "View changed to %s",
+                    current_view == DISPLAY_VIEW_NETWORK ? "Network" : "Audio");
+        } else if (btn_event == BUTTON_EVENT_LONG_PRESS) {
+            input_mode_t old_mode = status.input_mode;
+            status.input_mode = (status.input_mode + 1) % 3;
+
+            // Manage ADC continuous mode based on input mode
+            if (old_mode == INPUT_MODE_AUX && status.input_mode != INPUT_MODE_AUX) {
+                // Leaving AUX mode - stop continuous ADC
+                adc_audio_stop();
+                ESP_LOGI(TAG, "Input mode changed to %d (ADC stopped)", status.input_mode);
+            } else if (old_mode != INPUT_MODE_AUX && status.input_mode == INPUT_MODE_AUX) {
+                // Entering AUX mode - start continuous ADC
+                adc_audio_start();
+                ESP_LOGI(TAG, "Input mode changed to %d (ADC started)", status.input_mode);
+            } else {
+                ESP_LOGI(TAG, "Input mode changed to %d", status.input_mode);
+            }
+            frame_scheduler_set_clock(frame_clock_for_mode(status.input_mode));
+        }
+
+        if (status.input_mode == INPUT_MODE_TONE) {
+            update_tone_oscillate();
+        }
+
+        // Update network stats every second
+        uint32_t now = xTaskGetTickCount();
+        if ((now - last_stats_update) >= pdMS_TO_TICKS(1000)) {
+            uint32_t elapsed_ticks = now - last_stats_update;
+            uint32_t elapsed_ms = elapsed_ticks * portTICK_PERIOD_MS;
+            uint32_t bytes_sent = combo_bytes_sent - last_bytes_sent;
+            if (elapsed_ms > 0 && bytes_sent > 0) {
+                status.bandwidth_kbps = (bytes_sent * 8) / elapsed_ms;
+            }
+            status.connected_nodes = network_get_connected_nodes();
+            status.rssi = network_get_rssi();
+            status.latency_ms = network_get_latency_ms();
+            last_stats_update = now;
+            last_bytes_sent += bytes_sent;
+        }
+
+        // Update display at 10 Hz (every 100ms)
+        if ((now - last_display_update) >= pdMS_TO_TICKS(100)) {
+            display_render_combo(current_view, &status);
+            last_display_update = now;
+        }
+    }
+}
+
 void app_main(void) {
     ESP_LOGI(TAG, "MeshNet Audio COMBO starting...");
 
@@ -123,10 +176,35 @@ void app_main(void) {
 
     // Initialize audio layer
     ESP_ERROR_CHECK(tone_gen_init(status.tone_freq_hz));
+#if TONE_TEST_SIGNAL == 1
+    static const uint32_t test_tones_hz[] = {100, 250, 630, 1600, 4000, 10000};
+    ESP_ERROR_CHECK(tone_gen_set_multitone(test_tones_hz, sizeof(test_tones_hz) / sizeof(test_tones_hz[0])));
+#elif TONE_TEST_SIGNAL == 2
+    ESP_ERROR_CHECK(tone_gen_set_sweep(20, 20000, 10000));
+#elif TONE_TEST_SIGNAL == 3
+    ESP_ERROR_CHECK(tone_gen_set_impulse(1000));
+#endif
     ESP_ERROR_CHECK(usb_audio_init());
     ESP_ERROR_CHECK(adc_audio_init());
     ESP_ERROR_CHECK(i2s_audio_init());  // Initialize I2S output for UDA1334
+    ESP_ERROR_CHECK(opus_codec_encoder_init());
     // Don't start ADC yet - will start when switching to AUX mode
+    const level_meter_config_t gate_config = {
+        .on_rms = COMBO_AUX_GATE_ON_RMS,
+        .off_rms = COMBO_AUX_GATE_OFF_RMS,
+        .hangover_frames = AUX_GATE_HANGOVER_FRAMES,
+    };
+    aux_meter = level_meter_create(&gate_config);
+    if (!aux_meter) {
+        ESP_LOGE(TAG, "Failed to create AUX level meter");
+        return;
+    }
+    monitor_gain = gain_stage_create();
+    if (!monitor_gain) {
+        ESP_LOGE(TAG, "Failed to create monitor gain stage");
+        return;
+    }
+    gain_stage_set_gain(monitor_gain, status.output_volume);
 
     // Create ring buffer (not used for network, but keeping for consistency)
     audio_buffer = ring_buffer_create(RING_BUFFER_SIZE);
@@ -149,23 +227,6 @@ void app_main(void) {
         ESP_ERROR_CHECK(esp_task_wdt_add(NULL));
     }
 
-    // Create semaphore for timer
-    combo_timer_sem = xSemaphoreCreateBinary();
-    if (!combo_timer_sem) {
-        ESP_LOGE(TAG, "Failed to create timer semaphore");
-        return;
-    }
-
-    // Create and start 1ms periodic timer
-    const esp_timer_create_args_t timer_args = {
-        .callback = &combo_timer_callback,
-        .name = "combo_pacer",
-        .dispatch_method = ESP_TIMER_TASK
-    };
-    esp_timer_handle_t combo_timer;
-    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &combo_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(combo_timer, 1000)); // 1ms = 1000us
-
     ESP_LOGI(TAG, "COMBO initialized, registering for network startup notification");
 
     // Wait for mesh network to be ready via event notification (not polling)
@@ -177,49 +238,22 @@ void app_main(void) {
         ESP_LOGI(TAG, "Network ready - starting audio transmission");
     }
 
-    uint32_t bytes_sent = 0;
     static uint16_t combo_seq = 0;
 
-    while (1) {
-        // Wait for 1ms timer tick (but only send every 10ms)
-        xSemaphoreTake(combo_timer_sem, portMAX_DELAY);
-        ms_tick++;
-
-        // Handle button events (every 5ms for responsiveness)
-        if ((ms_tick % 5) == 0) {
-            button_event_t btn_event = buttons_poll();
-            if (btn_event == BUTTON_EVENT_SHORT_PRESS) {
-                current_view = (current_view == DISPLAY_VIEW_NETWORK) ?
-                              DISPLAY_VIEW_AUDIO : DISPLAY_VIEW_NETWORK;
-                ESP_LOGI(TAG, "View changed to %s",
-                        current_view == DISPLAY_VIEW_NETWORK ? "Network" : "Audio");
-            } else if (btn_event == BUTTON_EVENT_LONG_PRESS) {
-                input_mode_t old_mode = status.input_mode;
-                status.input_mode = (status.input_mode + 1) % 3;
-
-                // Manage ADC continuous mode based on input mode
-                if (old_mode == INPUT_MODE_AUX && status.input_mode != INPUT_MODE_AUX) {
-                    // Leaving AUX mode - stop continuous ADC
-                    adc_audio_stop();
-                    ESP_LOGI(TAG, "Input mode changed to %d (ADC stopped)", status.input_mode);
-                } else if (old_mode != INPUT_MODE_AUX && status.input_mode == INPUT_MODE_AUX) {
-                    // Entering AUX mode - start continuous ADC
-                    adc_audio_start();
-                    ESP_LOGI(TAG, "Input mode changed to %d (ADC started)", status.input_mode);
-                } else {
-                    ESP_LOGI(TAG, "Input mode changed to %d", status.input_mode);
-                }
-            }
-        }
+    // One wake per frame from the source clock (started after the startup
+    // notification so the two don't mix); housekeeping runs in its own task
+    ESP_ERROR_CHECK(frame_scheduler_init(xTaskGetCurrentTaskHandle(), frame_clock_for_mode(status.input_mode)));
+    vTaskPrioritySet(NULL, 5);  // Audio path level with mesh RX, above housekeeping
+    xTaskCreate(combo_control_task, "combo_control", 4096, NULL, 2, NULL);
 
-        // Generate/capture audio based on mode (every 10ms to match frame size)
-        if ((ms_tick % AUDIO_FRAME_MS) != 0) {
-            // Update controls every 1ms for responsiveness, but don't generate audio
-            if (status.input_mode == INPUT_MODE_TONE) {
-                update_tone_oscillate();
-            }
-            continue; // Skip non-frame ticks for audio generation
+    while (1) {
+        // Wait for the next frame; the timeout only keeps the watchdog fed if the clock stalls
+        uint32_t due = frame_scheduler_wait(pdMS_TO_TICKS(AUDIO_FRAME_MS * 4));
+        esp_task_wdt_reset();
+        if (due == 0) {
+            continue;
         }
+        combo_frames++;
 
         status.audio_active = false;
         switch (status.input_mode) {
@@ -230,7 +264,7 @@ void app_main(void) {
                 stereo_frame[i * 2] = stereo_frame[i * 2 + 1] = mono_frame[i];
             }
             // Pack 16-bit mono → 24-bit mono for network transmission
-            pcm16_mono_to_pcm24_mono_pack(mono_frame, AUDIO_FRAME_SAMPLES, packet_buffer);
+            pcm_s16_to_s24(mono_frame, AUDIO_FRAME_SAMPLES, packet_buffer);
             status.audio_active = true;
             break;
         case INPUT_MODE_USB:
@@ -239,11 +273,10 @@ void app_main(void) {
                 usb_audio_read_frames(stereo_frame, AUDIO_FRAME_SAMPLES, &frames_read);
                 if (frames_read > 0) {
                     // Pack 16-bit stereo → 24-bit mono for network (downmix L+R)
-                    pcm16_stereo_to_pcm24_mono_pack(stereo_frame, frames_read, packet_buffer);
+                    pcm_s16_stereo_to_s24_mono(stereo_frame, frames_read, packet_buffer);
                     // Pad remaining with silence
-                    for (size_t i = frames_read; i < AUDIO_FRAME_SAMPLES; i++) {
-                        s24le_pack(0, &packet_buffer[i * 3]);
-                    }
+                    memset(packet_buffer + frames_read * AUDIO_BYTES_PER_SAMPLE, 0,
+                           (AUDIO_FRAME_SAMPLES - frames_read) * AUDIO_BYTES_PER_SAMPLE);
                     status.audio_active = true;
                 } else {
                     memset(packet_buffer, 0, AUDIO_FRAME_BYTES);
@@ -252,58 +285,36 @@ void app_main(void) {
             break;
         case INPUT_MODE_AUX:
             {
-                size_t samples_read = 0;
-                esp_err_t ret = adc_audio_read_stereo(stereo_frame, AUDIO_FRAME_SAMPLES, &samples_read);
-
-                if (ret == ESP_OK && samples_read > 0) {
-                    // Fill remaining samples with last value if needed
-                    if (samples_read < AUDIO_FRAME_SAMPLES) {
-                        int16_t last_left = stereo_frame[(samples_read - 1) * 2];
-                        int16_t last_right = stereo_frame[(samples_read - 1) * 2 + 1];
-                        for (size_t i = samples_read; i < AUDIO_FRAME_SAMPLES; i++) {
-                            stereo_frame[i * 2] = last_left;
-                            stereo_frame[i * 2 + 1] = last_right;
-                        }
-                    }
-
-                    // Detect actual audio by measuring AC variance
-                    int64_t sum_left = 0, sum_right = 0;
-                    for (size_t i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
-                        sum_left += stereo_frame[i * 2];
-                        sum_right += stereo_frame[i * 2 + 1];
-                    }
-                    int32_t mean_left = (int32_t)(sum_left / AUDIO_FRAME_SAMPLES);
-                    int32_t mean_right = (int32_t)(sum_right / AUDIO_FRAME_SAMPLES);
-
-                    int64_t var_left = 0, var_right = 0;
-                    for (size_t i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
-                        int32_t diff_l = stereo_frame[i * 2] - mean_left;
-                        int32_t diff_r = stereo_frame[i * 2 + 1] - mean_right;
-                        var_left += (int64_t)diff_l * diff_l;
-                        var_right += (int64_t)diff_r * diff_r;
+                // Whole frames only: the scheduler wakes us once the capture task has one
+                esp_err_t ret = adc_audio_read_frame(mono_frame, AUDIO_FRAME_SAMPLES);
+
+                if (ret == ESP_OK) {
+                    // Duplicate mono to stereo for local I2S output
+                    pcm_s16_mono_to_stereo(mono_frame, AUDIO_FRAME_SAMPLES, stereo_frame);
+
+                    // Gate on AC level, with hysteresis and hangover
+                    status.audio_active = level_meter_process(aux_meter, mono_frame, AUDIO_FRAME_SAMPLES);
+                    level_meter_reading_t level;
+                    level_meter_get_reading(aux_meter, &level);
+                    status.input_level_dbfs = level.rms_dbfs;
+
+                    if ((combo_frames & 0xFF) == 0) {
+                        ESP_LOGI(TAG, "AUX: RMS=%ld (%ld dBFS), peak=%ld, DC=%ld, gate=%s",
+                                 level.rms, level.rms_dbfs, level.peak, level.dc,
+                                 level.active ? "open" : "closed");
                     }
-                    int32_t std_left = (int32_t)sqrt(var_left / AUDIO_FRAME_SAMPLES);
-                    int32_t std_right = (int32_t)sqrt(var_right / AUDIO_FRAME_SAMPLES);
-                    int32_t std_avg = (std_left + std_right) / 2;
 
-                    const int32_t SIGNAL_THRESHOLD = 10;
-
-                    if ((ms_tick & 0xFF) == 0) {
-                        ESP_LOGI(TAG, "AUX: STD=%ld, DC_L=%ld, DC_R=%ld", std_avg, mean_left, mean_right);
-                    }
-
-                    if (std_avg > SIGNAL_THRESHOLD) {
-                        // Pack 16-bit stereo → 24-bit mono for network (downmix L+R)
-                        pcm16_stereo_to_pcm24_mono_pack(stereo_frame, samples_read, packet_buffer);
-                        status.audio_active = true;
+                    if (status.audio_active) {
+                        // Pack 16-bit mono → 24-bit mono for network
+                        pcm_s16_to_s24(mono_frame, AUDIO_FRAME_SAMPLES, packet_buffer);
                     } else {
                         memset(packet_buffer, 0, AUDIO_FRAME_BYTES);
-                        status.audio_active = false;
                     }
                 } else {
+                    // Short read (mode just switched) or error - fill with silence
                     memset(packet_buffer, 0, AUDIO_FRAME_BYTES);
                     status.audio_active = false;
-                    if (ret != ESP_OK) {
+                    if (ret != ESP_ERR_NOT_FOUND) {
                         ESP_LOGW(TAG, "AUX: ADC read error: %s", esp_err_to_name(ret));
                     }
                 }
@@ -313,17 +324,15 @@ void app_main(void) {
             break;
         }
 
-        // Apply volume scaling for AUX and USB modes
+        // Apply monitor volume for AUX and USB modes (ramped, so changes don't zipper)
         if (status.input_mode == INPUT_MODE_AUX || status.input_mode == INPUT_MODE_USB) {
-            for (size_t i = 0; i < AUDIO_FRAME_SAMPLES * 2; i++) {
-                stereo_frame[i] = (int16_t)(stereo_frame[i] * status.output_volume);
-            }
+            gain_stage_process_s16(monitor_gain, stereo_frame, AUDIO_FRAME_SAMPLES, 2);
         }
 
         // Output audio directly to I2S (UDA1334)
         if (status.audio_active) {
             i2s_audio_write_samples(stereo_frame, AUDIO_FRAME_SAMPLES * 2);
-            if ((ms_tick & 0x7F) == 0) {
+            if ((combo_frames & 0x7F) == 0) {
                 ESP_LOGI(TAG, "Output frame to I2S");
             }
         } else {
@@ -333,32 +342,47 @@ void app_main(void) {
         }
 
         // Transmit audio to mesh network when ready
-        // Payload format (v0.1): PCM S24LE packed, mono, 48 kHz, 5ms frames (720 bytes)
+        // Payload format: Opus (NET_PKT_TYPE_AUDIO_OPUS) when AUDIO_CODEC_OPUS is enabled,
+        // otherwise PCM S24LE packed, mono, 48 kHz, 5ms frames (720 bytes)
         // Only attempt send if both audio is active AND mesh is fully ready
         if (status.audio_active && network_is_stream_ready()) {
-            // packet_buffer already contains 24-bit packed mono data from conversion above
+            // packet_buffer (= payload) already contains 24-bit packed mono data from conversion above
+            uint8_t *payload = framed_buffer + NET_FRAME_HEADER_SIZE;
+            uint8_t pkt_type = NET_PKT_TYPE_AUDIO_RAW;
+            uint16_t payload_len = AUDIO_FRAME_BYTES;
+
+#if AUDIO_CODEC_OPUS
+            // Encode over the PCM in the framed buffer (mono_frame holds the input); raw PCM on failure
+            int opus_len = 0;
+            pcm_s24_to_s16(packet_buffer, AUDIO_FRAME_SAMPLES, mono_frame);
+            if (opus_codec_encode(mono_frame, AUDIO_FRAME_SAMPLES, payload, &opus_len) == ESP_OK) {
+                pkt_type = NET_PKT_TYPE_AUDIO_OPUS;
+                payload_len = (uint16_t)opus_len;
+            } else {
+                // The encoder may have written over the PCM; the 16-bit source repacks losslessly
+                pcm_s16_to_s24(mono_frame, AUDIO_FRAME_SAMPLES, payload);
+            }
+#endif
 
             // Build frame header
             net_frame_header_t hdr;
             hdr.magic = NET_FRAME_MAGIC;
             hdr.version = NET_FRAME_VERSION;
-            hdr.type = NET_PKT_TYPE_AUDIO_RAW;
-            hdr.stream_id = 1;  // Stream ID (will be set by network layer)
+            hdr.type = pkt_type;
+            hdr.stream_id = network_get_stream_id();  // Per-node, so relays dedupe sources apart
             hdr.seq = htons(combo_seq++);
             hdr.timestamp = htonl((uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-            hdr.payload_len = htons((uint16_t)AUDIO_FRAME_BYTES);
+            hdr.payload_len = htons(payload_len);
             hdr.ttl = 6;  // Max 6 hops
-            hdr.reserved = 0;
-
-            // Copy header + payload to framed buffer
+            memset(hdr.reserved, 0, sizeof(hdr.reserved));
             memcpy(framed_buffer, &hdr, NET_FRAME_HEADER_SIZE);
-            memcpy(framed_buffer + NET_FRAME_HEADER_SIZE, packet_buffer, AUDIO_FRAME_BYTES);
 
-            esp_err_t send_ret = network_send_audio(framed_buffer, NET_FRAME_HEADER_SIZE + AUDIO_FRAME_BYTES);
+            size_t frame_len = NET_FRAME_HEADER_SIZE + payload_len;
+            esp_err_t send_ret = network_send_audio(framed_buffer, frame_len);
             if (send_ret == ESP_OK) {
-                bytes_sent += (NET_FRAME_HEADER_SIZE + AUDIO_FRAME_BYTES);
+                combo_bytes_sent += frame_len;
                 if ((combo_seq & 0x7F) == 0) {
-                    ESP_LOGI(TAG, "Sent packet seq=%u (%d bytes)", ntohs(hdr.seq), NET_FRAME_HEADER_SIZE + AUDIO_FRAME_BYTES);
+                    ESP_LOGI(TAG, "Sent packet seq=%u (%d bytes)", ntohs(hdr.seq), (int)frame_len);
                 }
             } else if (send_ret != ESP_ERR_MESH_DISCONNECTED) {
                 // Only warn on errors other than disconnected (expected for standalone root)
@@ -367,29 +391,5 @@ void app_main(void) {
                 }
             }
         }
-
-        // Update network stats every second
-        uint32_t now = xTaskGetTickCount();
-        static uint32_t last_stats_update = 0;
-        if ((now - last_stats_update) >= pdMS_TO_TICKS(1000)) {
-            uint32_t elapsed_ticks = now - last_stats_update;
-            uint32_t elapsed_ms = elapsed_ticks * portTICK_PERIOD_MS;
-            if (elapsed_ms > 0 && bytes_sent > 0) {
-                status.bandwidth_kbps = (bytes_sent * 8) / elapsed_ms;
-            }
-            status.connected_nodes = network_get_connected_nodes();
-            status.rssi = network_get_rssi();
-            status.latency_ms = network_get_latency_ms();
-            last_stats_update = now;
-            bytes_sent = 0;  // Reset for next interval
-        }
-
-        // Update display at 10 Hz (every 100ms)
-        if ((ms_tick % 100) == 0) {
-            display_render_combo(current_view, &status);
-        }
-
-        // Reset watchdog
-        esp_task_wdt_reset();
     }
 }
@@ -1,16 +1,24 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include "config/build.h"
 #include "config/pins.h"
 #include "control/display.h"
 #include "control/buttons.h"
 #include "control/status.h"
 #include "network/mesh_net.h"
+#include "network/fec.h"
 #include <string.h>
 #include "audio/i2s_audio.h"
-// #include "audio/opus_codec.h"  // Removed for now
-#include "audio/ring_buffer.h"
+#include "audio/opus_codec.h"
+#include "audio/jitter_buffer.h"
+#include "audio/frame_pool.h"
+#include "audio/pcm_convert.h"
+#include "audio/drift_control.h"
+#include "audio/plc.h"
+#include "audio/dsp_chain.h"
+#include "audio/gain_stage.h"
 #include <netinet/in.h>
 
 static const char *TAG = "rx_main";
@@ -20,58 +28,124 @@ static rx_status_t status = {
     .latency_ms = 0,
     .hops = 1,  // Direct connection
     .receiving_audio = false,
-    .bandwidth_kbps = 0
+    .bandwidth_kbps = 0,
+    .jitter_depth_frames = JITTER_PREFILL_FRAMES,
+    .jitter_ms = 0,
+    .late_frames = 0
 };
 
 static display_view_t current_view = DISPLAY_VIEW_NETWORK;
-static ring_buffer_t *jitter_buffer = NULL;
-
-#define JITTER_BUFFER_FRAMES 10  // 10 frames * 10ms = 100ms buffer
-#define PREFILL_FRAMES 5         // Prefill 5 frames = 50ms latency
+static jitter_buffer_t *jitter_buffer = NULL;
 
 // Move large buffers to static storage to avoid stack overflow
-static int16_t rx_audio_frame[AUDIO_FRAME_SAMPLES * 2];
-static int16_t rx_silence_frame[AUDIO_FRAME_SAMPLES * 2] = {0};
+static const int32_t rx_silence_frame[AUDIO_FRAME_SAMPLES] = {0};
+static int32_t rx_resampled[AUDIO_FRAME_SAMPLES];
+static dsp_chain_t *rx_output_chain = NULL;  // Crossover/EQ after drift correction (empty = bypass)
+static gain_stage_t *rx_output_gain = NULL;  // Playout level, ramped (unity = bypass)
+// Opus frames are decoded and re-packed to S24LE (into a pool frame) so the jitter buffer holds one format
+static int16_t rx_decoded_pcm[AUDIO_FRAME_SAMPLES];
 
-// Packet tracking for statistics
+// Packet tracking for statistics (loss/late/duplicate counts live in the jitter buffer)
 static uint32_t packets_received = 0;
-static uint32_t dropped_packets = 0;
-static uint16_t last_seq = 0;
-static bool first_packet = true;
 static uint32_t last_packet_time = 0;
+static int64_t last_arrival_us = 0;  // Drift loop: time since newest frame refines depth below a frame
+static uint32_t underrun_count = 0;
 
-// Audio callback for mesh network - called when audio frames are received
-static void audio_rx_callback(const uint8_t *payload, size_t len, uint16_t seq, uint32_t timestamp) {
-    if (len != AUDIO_FRAME_BYTES) {
-        ESP_LOGW(TAG, "Invalid audio frame size: %d", len);
-        return;
+// Drift control source: next frame from the jitter buffer, gaps concealed by PLC
+static esp_err_t rx_pull_frame(int32_t *samples, void *ctx) {
+    audio_frame_t *frame = NULL;
+    esp_err_t ret = jitter_buffer_get(jitter_buffer, &frame);
+    if (ret == ESP_OK) {
+        // Unpack straight from the received buffer, then return it to the pool
+        pcm_s24_to_i24(frame->data, AUDIO_FRAME_SAMPLES, samples);
+        frame_pool_unref(frame);
+        plc_good_frame(samples);
+        return ESP_OK;
+    }
+    if (ret == ESP_ERR_NOT_FOUND) {
+        // Missing frame or underrun - synthesize 5ms from recent history
+        plc_conceal(samples);
+        underrun_count++;
+        if (underrun_count % 100 == 0) {
+            ESP_LOGW(TAG, "Missing frame count: %lu", underrun_count);
+        }
+        return ESP_OK;
     }
+    return ret;  // Prefilling or no audio stream
+}
+
+// Opus frames decode into pool frames held until the batch is in the jitter buffer
+static jitter_buffer_entry_t rx_entries[NETWORK_RX_BATCH_MAX];
+static esp_err_t rx_results[NETWORK_RX_BATCH_MAX];
+static audio_frame_t *rx_decoded[NETWORK_RX_BATCH_MAX];
+
+// Audio batch callback for mesh network - everything received since the delivery
+// task last woke, put into the jitter buffer under one lock
+static void audio_rx_batch_callback(const network_rx_frame_t *frames, size_t count) {
+    size_t n = 0;
+    size_t decoded_count = 0;
     
-    // Track sequence gaps for packet loss measurement
-    if (!first_packet) {
-        uint16_t expected_seq = (last_seq + 1) & 0xFFFF;
-        if (seq != expected_seq) {
-            int16_t gap = (int16_t)(seq - expected_seq);
-            if (gap > 0) {
-                dropped_packets += gap;
+    for (size_t i = 0; i < count; i++) {
+        audio_frame_t *frame = frames[i].frame;
+        if (frames[i].type == NET_PKT_TYPE_AUDIO_OPUS) {
+            int decoded_samples = 0;
+            if (opus_codec_decode(frame->data, (int)frame->len, rx_decoded_pcm, &decoded_samples) != ESP_OK ||
+                decoded_samples != AUDIO_FRAME_SAMPLES) {
+                ESP_LOGW(TAG, "Opus decode failed for seq=%u (%d bytes)", frames[i].seq, frame->len);
+                continue;
             }
+            audio_frame_t *decoded = frame_pool_alloc(0);
+            if (!decoded) {
+                ESP_LOGD(TAG, "Frame pool empty, dropping seq=%u", frames[i].seq);
+                continue;
+            }
+            pcm_s16_to_s24(rx_decoded_pcm, AUDIO_FRAME_SAMPLES, decoded->data);
+            decoded->len = AUDIO_FRAME_BYTES;
+            rx_decoded[decoded_count++] = decoded;
+            frame = decoded;
         }
+        
+        if (frame->len != AUDIO_FRAME_BYTES) {
+            ESP_LOGW(TAG, "Invalid audio frame size: %d", frame->len);
+            continue;
+        }
+        rx_entries[n++] = (jitter_buffer_entry_t){
+            .frame = frame,
+            .seq = frames[i].seq,
+            .timestamp = frames[i].timestamp,
+            .arrival_us = frames[i].arrival_us,
+        };
+    }
+    if (n == 0) {
+        return;
+    }
+    
+    // Slot into jitter buffer by sequence number (reorders, drops late/duplicate frames);
+    // the buffer keeps its own references, raw PCM is played from the mesh RX buffer itself
+    size_t stored = jitter_buffer_put_batch(jitter_buffer, rx_entries, n, rx_results);
+    for (size_t i = 0; i < decoded_count; i++) {
+        frame_pool_unref(rx_decoded[i]);
     }
-    first_packet = false;
-    last_seq = seq;
     
-    // Write to jitter buffer
-    esp_err_t write_ret = ring_buffer_write(jitter_buffer, payload, AUDIO_FRAME_BYTES);
-    if (write_ret == ESP_OK) {
+    int64_t newest_us = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (rx_results[i] == ESP_OK) {
+            if (rx_entries[i].arrival_us > newest_us) {
+                newest_us = rx_entries[i].arrival_us;
+            }
+            if ((++packets_received & 0x7F) == 0) {
+                ESP_LOGI(TAG, "RX packet %lu (seq=%u)", packets_received, rx_entries[i].seq);
+            }
+        } else if (rx_results[i] == ESP_ERR_TIMEOUT) {
+            ESP_LOGD(TAG, "Late frame seq=%u, dropping", rx_entries[i].seq);
+        } else if (rx_results[i] == ESP_ERR_INVALID_STATE) {
+            ESP_LOGD(TAG, "Duplicate frame seq=%u, dropping", rx_entries[i].seq);
+        }
+    }
+    if (stored > 0) {
         status.receiving_audio = true;
-        packets_received++;
         last_packet_time = xTaskGetTickCount();
-        
-        if ((packets_received & 0x7F) == 0) {
-            ESP_LOGI(TAG, "RX packet %lu (seq=%u)", packets_received, seq);
-        }
-    } else {
-        ESP_LOGW(TAG, "Jitter buffer full, dropping packet seq=%u", seq);
+        last_arrival_us = newest_us;
     }
 }
 
@@ -90,19 +164,56 @@ ESP_LOGI(TAG, "Starting mesh network...");
 ESP_ERROR_CHECK(network_init_mesh());
 ESP_ERROR_CHECK(network_start_latency_measurement());
 
-// Register audio callback for mesh audio reception
-ESP_ERROR_CHECK(network_register_audio_callback(audio_rx_callback));
-
 // Initialize audio output
 ESP_ERROR_CHECK(i2s_audio_init());
-// ESP_ERROR_CHECK(opus_codec_init());  // Removed for now
+ESP_ERROR_CHECK(opus_codec_decoder_init());
 
 // Create jitter buffer
-jitter_buffer = ring_buffer_create(JITTER_BUFFER_FRAMES * AUDIO_FRAME_BYTES);
+jitter_buffer = jitter_buffer_create(JITTER_BUFFER_FRAMES, AUDIO_FRAME_BYTES, JITTER_PREFILL_FRAMES);
 if (!jitter_buffer) {
 ESP_LOGE(TAG, "Failed to create jitter buffer");
 return;
 }
+// Track measured jitter: shallow meshes run near the floor (JITTER_MIN_FRAMES, or the FEC
+// recovery wait), deep ones grow toward MAX
+ESP_ERROR_CHECK(jitter_buffer_set_adaptive(jitter_buffer, JITTER_FLOOR_FRAMES, JITTER_MAX_FRAMES,
+                                           AUDIO_FRAME_MS * 1000));
+
+ESP_ERROR_CHECK(plc_init());
+
+// Resample between jitter buffer and I2S so TX/RX crystal offset never drains or floods it
+ESP_ERROR_CHECK(drift_control_init(rx_pull_frame, NULL));
+// The ASRC now pulls depth to the target, so the buffer's 5ms shrink drops are a last resort
+ESP_ERROR_CHECK(jitter_buffer_set_drop_margin(jitter_buffer, JITTER_ASRC_DROP_MARGIN));
+
+// Output crossover: each Linkwitz-Riley leg is two identical Butterworth sections
+rx_output_chain = dsp_chain_create(4);
+if (!rx_output_chain) {
+ESP_LOGE(TAG, "Failed to create output filter chain");
+return;
+}
+#if RX_HPF_HZ > 0
+dsp_chain_add(rx_output_chain, DSP_FILTER_HIGHPASS, RX_HPF_HZ, DSP_Q_BUTTERWORTH, 0.0f);
+dsp_chain_add(rx_output_chain, DSP_FILTER_HIGHPASS, RX_HPF_HZ, DSP_Q_BUTTERWORTH, 0.0f);
+#endif
+#if RX_LPF_HZ > 0
+dsp_chain_add(rx_output_chain, DSP_FILTER_LOWPASS, RX_LPF_HZ, DSP_Q_BUTTERWORTH, 0.0f);
+dsp_chain_add(rx_output_chain, DSP_FILTER_LOWPASS, RX_LPF_HZ, DSP_Q_BUTTERWORTH, 0.0f);
+#endif
+
+rx_output_gain = gain_stage_create();
+if (!rx_output_gain) {
+ESP_LOGE(TAG, "Failed to create output gain stage");
+return;
+}
+gain_stage_set_gain_db(rx_output_gain, RX_OUTPUT_GAIN_DB);
+gain_stage_set_soft_clip(rx_output_gain, RX_OUTPUT_GAIN_DB > 0);  // Boost bends peaks instead of clipping
+
+// Register audio callback for mesh audio reception - last, so the decoder and
+// jitter buffer exist before the first frame is delivered
+ESP_ERROR_CHECK(network_register_audio_batch_callback(audio_rx_batch_callback));
+// Only the subscribed stream reaches the callback (and this branch of the mesh)
+ESP_ERROR_CHECK(network_subscribe_stream(RX_STREAM_ID));
 
 ESP_LOGI(TAG, "RX initialized, registering for network startup notification");
 
@@ -113,14 +224,16 @@ if (notify_value > 0) {
     ESP_LOGI(TAG, "Network ready - starting audio reception");
 }
 
+// Woken by the I2S output engine each time a DMA buffer drains (after the startup
+// notification so the two don't mix)
+i2s_audio_set_refill_task(xTaskGetCurrentTaskHandle());
+
 // Log initial stack/heap status
 ESP_LOGI(TAG, "Main task stack high water mark: %u bytes", uxTaskGetStackHighWaterMark(NULL));
 ESP_LOGI(TAG, "Free heap: %u bytes", heap_caps_get_free_size(MALLOC_CAP_8BIT));
 
 uint32_t bytes_received = 0;
 uint32_t last_stats_update = xTaskGetTickCount();
-uint32_t underrun_count = 0;
-bool prefilled = false;
     
     while (1) {
         // Handle button events
@@ -133,37 +246,37 @@ bool prefilled = false;
         }
         
         // Check for audio stream timeout (callback-based reception)
-        if ((xTaskGetTickCount() - last_packet_time) > pdMS_TO_TICKS(100)) {
+        if (status.receiving_audio && (xTaskGetTickCount() - last_packet_time) > pdMS_TO_TICKS(100)) {
             status.receiving_audio = false;
-            prefilled = false;
+            jitter_buffer_reset(jitter_buffer);  // Prefill again when the stream resumes
+            drift_control_reset();
+            plc_reset();
         }
         
-        // Playback from jitter buffer with prefill
-        size_t available_bytes = ring_buffer_available(jitter_buffer);
-        size_t available_frames = available_bytes / AUDIO_FRAME_BYTES;
-        if (!prefilled) {
-            if (available_frames >= PREFILL_FRAMES) {
-                prefilled = true;
-                ESP_LOGI(TAG, "Buffer prefilled (%zu frames), starting playback", available_frames);
-            }
-        }
+        // Fill error in samples: whole frames vs target, plus time since the newest
+        // arrival so the estimate is continuous instead of stepping a frame at a time
+        jitter_buffer_stats_t jb_fill;
+        jitter_buffer_get_stats(jitter_buffer, &jb_fill);
+        int64_t age_us = esp_timer_get_time() - last_arrival_us;
+        if (age_us < 0) age_us = 0;
+        if (age_us > AUDIO_FRAME_MS * 1000) age_us = AUDIO_FRAME_MS * 1000;
+        int32_t fill_error = ((int32_t)jb_fill.depth - (int32_t)jb_fill.target_depth) * AUDIO_FRAME_SAMPLES
+                           + (int32_t)(age_us * AUDIO_SAMPLE_RATE / 1000000) - AUDIO_FRAME_SAMPLES / 2;
         
-        if (prefilled) {
-        if (ring_buffer_read(jitter_buffer, (uint8_t*)rx_audio_frame, AUDIO_FRAME_BYTES) == ESP_OK) {
-        // Write 10ms frame in one go (I2S will buffer it)
-        i2s_audio_write_samples(rx_audio_frame, AUDIO_FRAME_SAMPLES * 2);
+        // Playback from jitter buffer in sequence order via the drift-correcting resampler
+        // (prefill handled by the buffer, gaps by rx_pull_frame), whenever the I2S
+        // playout queue has room for another 5ms frame
+        if (i2s_audio_get_free_frames() >= AUDIO_FRAME_SAMPLES) {
+        if (drift_control_process(rx_resampled, AUDIO_FRAME_SAMPLES, fill_error) == ESP_OK) {
+        dsp_chain_process(rx_output_chain, rx_resampled, AUDIO_FRAME_SAMPLES);
+        gain_stage_process_i24(rx_output_gain, rx_resampled, AUDIO_FRAME_SAMPLES);
+        // Queue 5ms frame in one go - full 24-bit, mono to both channels
+        i2s_audio_write_i24_mono(rx_resampled, AUDIO_FRAME_SAMPLES);
         } else {
-        // Buffer underrun - play silence (10ms worth)
-        i2s_audio_write_samples(rx_silence_frame, AUDIO_FRAME_SAMPLES * 2);
-        underrun_count++;
-        if (underrun_count % 100 == 0) {
-        ESP_LOGW(TAG, "Buffer underrun count: %lu", underrun_count);
+        // Prefilling or no audio stream - play silence to mute
+        i2s_audio_write_i24_mono(rx_silence_frame, AUDIO_FRAME_SAMPLES);
         }
         }
-        } else {
-        // No audio stream - play silence to mute
-        i2s_audio_write_samples(rx_silence_frame, AUDIO_FRAME_SAMPLES * 2);
-        }
         
         // Update network stats every second
         uint32_t now = xTaskGetTickCount();
@@ -176,17 +289,50 @@ bool prefilled = false;
             status.rssi = network_get_rssi();
             status.latency_ms = network_get_latency_ms();
             
-            // Log packet loss statistics
+            // Log packet loss statistics (frames that reached playout as gaps)
+            jitter_buffer_stats_t jb_stats;
+            jitter_buffer_get_stats(jitter_buffer, &jb_stats);
             float loss_pct = 0.0f;
-            if (packets_received + dropped_packets > 0) {
-                loss_pct = (100.0f * dropped_packets) / (packets_received + dropped_packets);
+            if (jb_stats.played + jb_stats.missing > 0) {
+                loss_pct = (100.0f * jb_stats.missing) / (jb_stats.played + jb_stats.missing);
+            }
+            status.jitter_depth_frames = jb_stats.target_depth;
+            status.jitter_ms = jb_stats.jitter_us / 1000;
+            status.late_frames = jb_stats.late;
+            ESP_LOGI(TAG, "Stats: RX=%lu pkts, MISS=%lu, LATE=%lu, DUP=%lu, LOSS=%.1f%%, BW=%lu kbps", 
+                     packets_received, jb_stats.missing, jb_stats.late, jb_stats.duplicates,
+                     loss_pct, status.bandwidth_kbps);
+            ESP_LOGI(TAG, "Jitter: %lu us, depth=%lu/%lu frames, drops=%lu, holds=%lu, drift=%.1f ppm",
+                     jb_stats.jitter_us, jb_stats.depth, jb_stats.target_depth,
+                     jb_stats.drops, jb_stats.holds, drift_control_get_ppm_error());
+            frame_pool_stats_t pool_stats;
+            frame_pool_get_stats(&pool_stats);
+            ESP_LOGI(TAG, "Frame pool: in_use=%lu/%lu, high_water=%lu, exhausted=%lu",
+                     pool_stats.in_use, pool_stats.total, pool_stats.high_water, pool_stats.exhausted);
+            network_rx_stats_t rx_stats;
+            if (network_get_rx_stats(&rx_stats) == ESP_OK) {
+                ESP_LOGI(TAG, "Mesh RX: relay avg/max=%lu/%lu us, delivery avg/max=%lu/%lu us, delivery_drops=%lu",
+                         rx_stats.relay_avg_us, rx_stats.relay_max_us, rx_stats.delivery_avg_us,
+                         rx_stats.delivery_max_us, rx_stats.delivery_drops);
+            }
+            i2s_audio_stats_t i2s_stats;
+            i2s_audio_get_stats(&i2s_stats);
+            ESP_LOGI(TAG, "I2S: queued=%lu+%lu frames, underruns=%lu (%lu silent frames), overflows=%lu",
+                     i2s_stats.queued_frames, i2s_stats.dma_frames, i2s_stats.underruns,
+                     i2s_stats.silence_frames, i2s_stats.overflows);
+            plc_stats_t plc_stats;
+            plc_get_stats(&plc_stats);
+            ESP_LOGI(TAG, "PLC: concealed=%lu, resumed=%lu, max=%lu us/frame",
+                     plc_stats.concealed, plc_stats.resumed, plc_stats.max_conceal_us);
+            fec_stats_t fec_stats;
+            if (network_get_fec_stats(&fec_stats) == ESP_OK && fec_stats.groups > 0) {
+                ESP_LOGI(TAG, "FEC: groups=%lu, recovered=%lu, unrecoverable=%lu",
+                         fec_stats.groups, fec_stats.recovered, fec_stats.unrecoverable);
             }
-            ESP_LOGI(TAG, "Stats: RX=%lu pkts, DROP=%lu pkts, LOSS=%.1f%%, BW=%lu kbps", 
-                     packets_received, dropped_packets, loss_pct, status.bandwidth_kbps);
             
             last_stats_update = now;
             bytes_received = 0;  // Reset for next interval
-            // Don't reset packets_received/dropped_packets - keep cumulative for accurate loss %
+            // Don't reset packets_received/jitter stats - keep cumulative for accurate loss %
         }
         
         // Update display at 10 Hz (every 100ms) to reduce I2C overhead
@@ -197,6 +343,10 @@ bool prefilled = false;
             last_display_update = now_display;
         }
         
-        // No delay - let I2S write timing control the loop (10ms per frame now)
+        // Sleep until the output engine drains a DMA buffer (the timeout keeps
+        // buttons and display alive if I2S ever stalls)
+        if (i2s_audio_get_free_frames() < AUDIO_FRAME_SAMPLES) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(AUDIO_FRAME_MS * 2));
+        }
     }
 }
@@ -0,0 +1,110 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_event.h"
+
+// Host build: the ESP-WIFI-MESH surface mesh_net.c uses. Configuration calls
+// succeed (host_mesh.c); esp_mesh_recv, esp_mesh_send and the topology queries
+// are left to the test, which plays the radio.
+#define ESP_ERR_MESH_NO_ROUTE_FOUND     0x4008
+
+typedef struct {
+    uint8_t addr[6];
+} mesh_addr_t;
+
+typedef enum { MESH_PROTO_BIN, MESH_PROTO_HTTP, MESH_PROTO_JSON } mesh_proto_t;
+typedef enum { MESH_TOS_P2P, MESH_TOS_E2E, MESH_TOS_DEF } mesh_tos_t;
+
+typedef struct {
+    uint8_t *data;
+    uint16_t size;
+    mesh_proto_t proto;
+    mesh_tos_t tos;
+} mesh_data_t;
+
+#define MESH_DATA_TODS      0x02
+#define MESH_DATA_P2P       0x04
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t password[64];
+    bool allow_router_switch;
+} mesh_router_t;
+
+typedef struct {
+    uint8_t password[64];
+    uint8_t max_connection;
+    uint8_t nonmesh_max_connection;
+} mesh_ap_cfg_t;
+
+typedef struct {
+    uint8_t channel;
+    mesh_addr_t mesh_id;
+    mesh_router_t router;
+    mesh_ap_cfg_t mesh_ap;
+} mesh_cfg_t;
+#define MESH_INIT_CONFIG_DEFAULT()  ((mesh_cfg_t){0})
+
+typedef struct {
+    int scan;
+    int vote;
+    int fail;
+    int monitor_ie;
+} mesh_attempts_t;
+
+// Events
+extern const char *MESH_EVENT;
+typedef enum {
+    MESH_EVENT_STARTED,
+    MESH_EVENT_STOPPED,
+    MESH_EVENT_CHILD_CONNECTED,
+    MESH_EVENT_CHILD_DISCONNECTED,
+    MESH_EVENT_ROUTING_TABLE_ADD,
+    MESH_EVENT_ROUTING_TABLE_REMOVE,
+    MESH_EVENT_PARENT_CONNECTED,
+    MESH_EVENT_PARENT_DISCONNECTED,
+    MESH_EVENT_ROOT_ADDRESS,
+    MESH_EVENT_TODS_STATE,
+    MESH_EVENT_ROOT_FIXED,
+} mesh_event_id_t;
+
+typedef struct {
+    mesh_addr_t connected;
+    uint16_t self_layer;
+} mesh_event_connected_t;
+
+typedef struct {
+    uint8_t mac[6];
+    uint8_t aid;
+} mesh_event_child_connected_t;
+typedef mesh_event_child_connected_t mesh_event_child_disconnected_t;
+
+typedef struct {
+    uint16_t rt_size_new;
+    uint16_t rt_size_change;
+} mesh_event_routing_table_change_t;
+
+typedef mesh_addr_t mesh_event_root_address_t;
+typedef enum { MESH_TODS_UNREACHABLE, MESH_TODS_REACHABLE } mesh_event_toDS_state_t;
+
+esp_err_t esp_mesh_init(void);
+esp_err_t esp_mesh_start(void);
+esp_err_t esp_mesh_set_config(const mesh_cfg_t *config);
+esp_err_t esp_mesh_set_self_organized(bool enable, bool select_parent);
+esp_err_t esp_mesh_set_max_layer(int max_layer);
+esp_err_t esp_mesh_set_vote_percentage(float percentage);
+esp_err_t esp_mesh_fix_root(bool enable);
+esp_err_t esp_mesh_set_attempts(mesh_attempts_t *attempts);
+
+// Provided by the test
+esp_err_t esp_mesh_recv(mesh_addr_t *from, mesh_data_t *data, int timeout_ms, int *flag,
+                        void *opt, int opt_count);
+esp_err_t esp_mesh_send(const mesh_addr_t *to, const mesh_data_t *data, int flag,
+                        const void *opt, int opt_count);
+esp_err_t esp_mesh_get_parent_bssid(mesh_addr_t *bssid);
+int esp_mesh_get_layer(void);
+int esp_mesh_get_routing_table_size(void);
+bool esp_mesh_is_root(void);
@@ -0,0 +1,16 @@
+#pragma once
+#include "esp_err.h"
+#include "lwip/ip4_addr.h"
+
+// Host build: network interfaces are opaque and never found
+typedef struct esp_netif_obj esp_netif_t;
+typedef struct {
+    ip4_addr_t ip;
+    ip4_addr_t netmask;
+    ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+esp_err_t esp_netif_init(void);
+esp_err_t esp_netif_create_default_wifi_mesh_netifs(esp_netif_t **sta, esp_netif_t **ap);
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key);
+esp_err_t esp_netif_set_ip_info(esp_netif_t *netif, const esp_netif_ip_info_t *ip_info);
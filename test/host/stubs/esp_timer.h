@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Host build: esp_timer_get_time reads the simulated clock (host_stubs.c), or
+// the monotonic clock once a test running real tasks switches to it
+int64_t esp_timer_get_time(void);
+
+void host_time_set_us(int64_t us);
+void host_time_advance_us(int64_t us);
+void host_time_use_real_clock(bool real);
+
+// Timers are accepted but never fire (host_rtos.c)
+typedef struct host_timer *esp_timer_handle_t;
+typedef enum { ESP_TIMER_TASK } esp_timer_dispatch_t;
+typedef struct {
+    void (*callback)(void *arg);
+    void *arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char *name;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
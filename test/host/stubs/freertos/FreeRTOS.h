@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "esp_attr.h"
+
+// Host build: critical sections are a spinlock that nests on the owning thread
+// like the ESP-IDF one, so a module can be driven from several threads; ticks
+// are milliseconds of esp_timer_get_time
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  1
+#define portMAX_DELAY           0xffffffffu
+#define portTICK_PERIOD_MS      1
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+
+typedef struct {
+    _Atomic uintptr_t owner;    // 0 when free
+    uint32_t count;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    {0, 0}
+void host_mux_enter(portMUX_TYPE *mux);
+void host_mux_exit(portMUX_TYPE *mux);
+#define portENTER_CRITICAL(mux)         host_mux_enter(mux)
+#define portEXIT_CRITICAL(mux)          host_mux_exit(mux)
+#define portENTER_CRITICAL_ISR(mux)     host_mux_enter(mux)
+#define portEXIT_CRITICAL_ISR(mux)      host_mux_exit(mux)
@@ -0,0 +1,93 @@
+// Wi-Fi, netif, NVS and ESP-WIFI-MESH configuration calls for host tests of
+// mesh_net.c: they all succeed and do nothing. Event handlers are kept for
+// host_event_post; the radio itself (esp_mesh_recv/send) is up to the test.
+#include <esp_event.h>
+#include <esp_mac.h>
+#include <esp_mesh.h>
+#include <esp_netif.h>
+#include <esp_wifi.h>
+#include <nvs_flash.h>
+
+#include <string.h>
+
+#define MAX_HANDLERS 4
+
+typedef struct {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t handler;
+    void *arg;
+} handler_t;
+
+static handler_t handlers[MAX_HANDLERS];
+static int handler_count;
+static uint8_t host_mac[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01};
+
+const char *MESH_EVENT = "MESH_EVENT";
+
+esp_err_t esp_event_loop_create_default(void) { return ESP_OK; }
+
+esp_err_t esp_event_handler_register(esp_event_base_t base, int32_t id, esp_event_handler_t handler, void *arg) {
+    if (handler_count == MAX_HANDLERS) return ESP_ERR_NO_MEM;
+    handlers[handler_count++] = (handler_t){base, id, handler, arg};
+    return ESP_OK;
+}
+
+// Runs the handlers on the caller's thread, as the default event loop task would
+void host_event_post(esp_event_base_t base, int32_t id, void *data) {
+    for (int i = 0; i < handler_count; i++) {
+        if (handlers[i].base == base && (handlers[i].id == ESP_EVENT_ANY_ID || handlers[i].id == id)) {
+            handlers[i].handler(handlers[i].arg, base, id, data);
+        }
+    }
+}
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type) {
+    memcpy(mac, host_mac, 6);
+    return ESP_OK;
+}
+
+void host_mac_set(const uint8_t mac[6]) {
+    memcpy(host_mac, mac, 6);
+}
+
+esp_err_t nvs_flash_init(void) { return ESP_OK; }
+esp_err_t nvs_flash_erase(void) { return ESP_OK; }
+
+esp_err_t esp_netif_init(void) { return ESP_OK; }
+esp_err_t esp_netif_create_default_wifi_mesh_netifs(esp_netif_t **sta, esp_netif_t **ap) { return ESP_OK; }
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key) { return NULL; }
+esp_err_t esp_netif_set_ip_info(esp_netif_t *netif, const esp_netif_ip_info_t *ip_info) { return ESP_OK; }
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config) { return ESP_OK; }
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage) { return ESP_OK; }
+esp_err_t esp_wifi_start(void) { return ESP_OK; }
+esp_err_t esp_wifi_stop(void) { return ESP_OK; }
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type) { return ESP_OK; }
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode) { return ESP_OK; }
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *config) { return ESP_OK; }
+
+esp_err_t esp_wifi_get_mode(wifi_mode_t *mode) {
+    *mode = WIFI_MODE_APSTA;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *config) {
+    memset(config, 0, sizeof(*config));
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info) {
+    memset(ap_info, 0, sizeof(*ap_info));
+    ap_info->rssi = -50;
+    return ESP_OK;
+}
+
+esp_err_t esp_mesh_init(void) { return ESP_OK; }
+esp_err_t esp_mesh_start(void) { return ESP_OK; }
+esp_err_t esp_mesh_set_config(const mesh_cfg_t *config) { return ESP_OK; }
+esp_err_t esp_mesh_set_self_organized(bool enable, bool select_parent) { return ESP_OK; }
+esp_err_t esp_mesh_set_max_layer(int max_layer) { return ESP_OK; }
+esp_err_t esp_mesh_set_vote_percentage(float percentage) { return ESP_OK; }
+esp_err_t esp_mesh_fix_root(bool enable) { return ESP_OK; }
+esp_err_t esp_mesh_set_attempts(mesh_attempts_t *attempts) { return ESP_OK; }
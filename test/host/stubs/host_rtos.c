@@ -0,0 +1,187 @@
+// FreeRTOS tasks, notifications and queues on pthreads, for host tests that
+// run a module's own tasks (mesh_net.c). Priorities and cores are ignored;
+// waits are real time in milliseconds (one tick).
+#include <esp_err.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct tskTaskControlBlock {
+    TaskFunction_t fn;
+    void *arg;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+};
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t *items;
+    size_t item_size;
+    size_t length;
+    size_t head;
+    size_t count;
+};
+
+struct host_timer {
+    esp_timer_create_args_t args;
+};
+
+static _Thread_local TaskHandle_t current_task;
+
+static struct tskTaskControlBlock *task_new(TaskFunction_t fn, void *arg) {
+    struct tskTaskControlBlock *task = calloc(1, sizeof(*task));
+    if (!task) return NULL;
+    task->fn = fn;
+    task->arg = arg;
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+    return task;
+}
+
+// The calling thread's task, made on first use for threads the test started
+static TaskHandle_t task_self(void) {
+    if (!current_task) current_task = task_new(NULL, NULL);
+    return current_task;
+}
+
+// Deadline `ticks` from now; false for portMAX_DELAY (wait forever)
+static bool deadline(TickType_t ticks, struct timespec *ts) {
+    if (ticks == portMAX_DELAY) return false;
+    clock_gettime(CLOCK_REALTIME, ts);
+    int64_t ns = ts->tv_nsec + (int64_t)ticks * portTICK_PERIOD_MS * 1000000;
+    ts->tv_sec += ns / 1000000000;
+    ts->tv_nsec = ns % 1000000000;
+    return true;
+}
+
+// One wait on cond (lock held); false once the deadline, if any, has passed
+static bool wait_once(pthread_cond_t *cond, pthread_mutex_t *lock, const struct timespec *until) {
+    return until ? pthread_cond_timedwait(cond, lock, until) != ETIMEDOUT : pthread_cond_wait(cond, lock) == 0;
+}
+
+static void* task_main(void *arg) {
+    current_task = arg;
+    current_task->fn(current_task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *handle, BaseType_t core) {
+    struct tskTaskControlBlock *task = task_new(fn, arg);
+    pthread_t thread;
+    if (!task || pthread_create(&thread, NULL, task_main, task) != 0) {
+        free(task);
+        return pdFALSE;
+    }
+    pthread_detach(thread);
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                       UBaseType_t prio, TaskHandle_t *handle) {
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, handle, 0);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec ts = {ticks / 1000, (long)(ticks % 1000) * 1000000};
+    nanosleep(&ts, NULL);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    TaskHandle_t task = task_self();
+    struct timespec ts;
+    const struct timespec *until = deadline(ticks, &ts) ? &ts : NULL;
+    pthread_mutex_lock(&task->lock);
+    while (task->notify == 0 && wait_once(&task->cond, &task->lock, until)) {
+    }
+    uint32_t value = task->notify;
+    if (value > 0) task->notify = clear ? 0 : value - 1;
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    QueueHandle_t queue = calloc(1, sizeof(*queue));
+    if (!queue) return NULL;
+    queue->items = calloc(length, item_size);
+    if (!queue->items) {
+        free(queue);
+        return NULL;
+    }
+    queue->item_size = item_size;
+    queue->length = length;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    struct timespec ts;
+    const struct timespec *until = deadline(ticks, &ts) ? &ts : NULL;
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length && wait_once(&queue->cond, &queue->lock, until)) {
+    }
+    bool room = queue->count < queue->length;
+    if (room) {
+        size_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return room ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+    struct timespec ts;
+    const struct timespec *until = deadline(ticks, &ts) ? &ts : NULL;
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && wait_once(&queue->cond, &queue->lock, until)) {
+    }
+    bool ready = queue->count > 0;
+    if (ready) {
+        memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ready ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *handle) {
+    struct host_timer *timer = calloc(1, sizeof(*timer));
+    if (!timer) return ESP_ERR_NO_MEM;
+    timer->args = *args;
+    *handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return ESP_OK;
+}
@@ -0,0 +1,68 @@
+#include <esp_err.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <time.h>
+
+static int64_t now_us = 0;
+static bool real_clock = false;
+static _Thread_local char thread_tag;   // Its address identifies the thread
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        default: return "ESP_ERR_UNKNOWN";
+    }
+}
+
+int64_t esp_timer_get_time(void) {
+    if (real_clock) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    }
+    return now_us;
+}
+
+void host_time_set_us(int64_t us) {
+    now_us = us;
+}
+
+void host_time_advance_us(int64_t us) {
+    now_us += us;
+}
+
+void host_time_use_real_clock(bool real) {
+    real_clock = real;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+void host_mux_enter(portMUX_TYPE *mux) {
+    uintptr_t self = (uintptr_t)&thread_tag;
+    if (atomic_load_explicit(&mux->owner, memory_order_relaxed) == self) {
+        mux->count++;
+        return;
+    }
+    uintptr_t expected = 0;
+    while (!atomic_compare_exchange_weak_explicit(&mux->owner, &expected, self,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+        expected = 0;
+    }
+    mux->count = 1;
+}
+
+void host_mux_exit(portMUX_TYPE *mux) {
+    if (--mux->count == 0) {
+        atomic_store_explicit(&mux->owner, 0, memory_order_release);
+    }
+}
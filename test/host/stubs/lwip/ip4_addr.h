@@ -0,0 +1,7 @@
+#pragma once
+#include <stdint.h>
+
+typedef struct { uint32_t addr; } ip4_addr_t;
+
+#define IP4_ADDR(ipaddr, a, b, c, d) \
+    ((ipaddr)->addr = ((uint32_t)(d) << 24) | ((uint32_t)(c) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(a))
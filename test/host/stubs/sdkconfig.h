@@ -0,0 +1,5 @@
+#pragma once
+
+// Host build: no target options (CONFIG_IDF_TARGET_* comes from the test target).
+// Project options (src/Kconfig.projbuild) as the TX/COMBO defaults set them:
+#define CONFIG_USB_AUDIO_FEEDBACK_EP    1
@@ -0,0 +1,8 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Host build: only the TinyUSB audio surface usb_audio.c uses; the test
+// implements tud_audio_fb_set as the USB host
+
+bool tud_audio_fb_set(uint32_t feedback);
@@ -0,0 +1,185 @@
+// Dedupe: the per-stream windows slide and wrap with seq, reject anything
+// older than their depth, restart after the stream timeout, and share the
+// stream table LRU-first once more streams than slots are seen
+#include "network/dedupe.h"
+#include "test_util.h"
+
+#include <stdbool.h>
+
+static void test_duplicates(void) {
+    dedupe_t *dd = dedupe_create();
+    CHECK(!dedupe_check(dd, 1, false, 100, 0));
+    CHECK(dedupe_check(dd, 1, false, 100, 0));
+    CHECK(!dedupe_check(dd, 1, false, 101, 5));
+    CHECK(dedupe_check(dd, 1, false, 101, 5));
+    // Parity has its own seq space, and other streams their own windows
+    CHECK(!dedupe_check(dd, 1, true, 100, 5));
+    CHECK(dedupe_check(dd, 1, true, 100, 5));
+    CHECK(!dedupe_check(dd, 2, false, 100, 5));
+    CHECK(!dedupe_check(dd, 2, true, 101, 5));
+    dedupe_reset(dd);
+    CHECK(!dedupe_check(dd, 1, false, 100, 5));
+    dedupe_destroy(dd);
+}
+
+// Reordered frames within the depth are accepted once; older ones never
+static void test_window_slide(void) {
+    dedupe_t *dd = dedupe_create();
+    uint32_t now = 0;
+    CHECK(!dedupe_check(dd, 7, false, 1000, now));
+    // Leave gaps, then fill them in from the oldest possible one
+    for (uint16_t s = 1002; s <= 1000 + DEDUPE_WINDOW_DEPTH; s += 2) {
+        CHECK(!dedupe_check(dd, 7, false, s, now));
+    }
+    uint16_t top = 1000 + DEDUPE_WINDOW_DEPTH;
+    CHECK(dedupe_check(dd, 7, false, (uint16_t)(top - DEDUPE_WINDOW_DEPTH), now));  // Just out of the window
+    for (uint16_t s = top - DEDUPE_WINDOW_DEPTH + 1; s < top; s += 2) {
+        CHECK(!dedupe_check(dd, 7, false, s, now));
+        CHECK(dedupe_check(dd, 7, false, s, now));
+    }
+    for (uint16_t s = top - DEDUPE_WINDOW_DEPTH + 1; s <= top; s++) {
+        CHECK(dedupe_check(dd, 7, false, s, now));
+    }
+
+    // Steady stream with every frame arriving twice, the copy up to 40 late
+    int accepted = 0, repeats = 0;
+    uint16_t seq = 5000;
+    for (int i = 0; i < 20000; i++, seq++) {
+        now = (uint32_t)i * 5;
+        if (!dedupe_check(dd, 7, false, seq, now)) accepted++;
+        uint16_t late = (uint16_t)(seq - test_rand() % (i < 40 ? i + 1 : 40));
+        if (!dedupe_check(dd, 7, false, late, now)) repeats++;
+    }
+    CHECK_EQ(accepted, 20000);
+    CHECK_EQ(repeats, 0);
+
+    // A jump further than the whole window drops every old bit
+    seq += 1000;
+    CHECK(!dedupe_check(dd, 7, false, seq, now));
+    for (uint16_t s = seq - DEDUPE_WINDOW_DEPTH + 1; s != seq; s++) {
+        CHECK(!dedupe_check(dd, 7, false, s, now));
+    }
+    dedupe_destroy(dd);
+}
+
+static void test_seq_wrap(void) {
+    dedupe_t *dd = dedupe_create();
+    int accepted = 0;
+    for (uint32_t i = 0; i < 200; i++) {
+        uint16_t seq = (uint16_t)(65436 + i);    // 65436..65535, 0..99
+        if (!dedupe_check(dd, 3, false, seq, 0)) accepted++;
+        CHECK(dedupe_check(dd, 3, false, seq, 0));
+    }
+    CHECK_EQ(accepted, 200);
+    // Frames from just before the wrap are still within the window
+    CHECK(dedupe_check(dd, 3, false, 65535, 0));
+    CHECK(dedupe_check(dd, 3, false, 65530, 0));
+    // A late frame from before the wrap, arriving after it
+    dedupe_reset(dd);
+    CHECK(!dedupe_check(dd, 3, false, 65530, 0));
+    CHECK(!dedupe_check(dd, 3, false, 2, 0));
+    CHECK(!dedupe_check(dd, 3, false, 65533, 0));
+    CHECK(dedupe_check(dd, 3, false, 65533, 0));
+    CHECK(!dedupe_check(dd, 3, false, 0, 0));
+    // More than half the seq space ahead reads as behind: rejected, not a jump
+    CHECK(dedupe_check(dd, 3, false, 40000, 0));
+    dedupe_destroy(dd);
+}
+
+static void test_stream_timeout(void) {
+    dedupe_t *dd = dedupe_create();
+    CHECK(!dedupe_check(dd, 9, false, 4000, 0));
+    CHECK(!dedupe_check(dd, 9, false, 4001, 10));
+    // A source that restarted with an older seq is dropped while the window is live...
+    CHECK(dedupe_check(dd, 9, false, 10, 500));
+    CHECK(dedupe_check(dd, 9, false, 10, 10 + DEDUPE_STREAM_TIMEOUT_MS));
+    // ...and accepted once nothing was accepted for the timeout
+    CHECK(!dedupe_check(dd, 9, false, 10, 11 + DEDUPE_STREAM_TIMEOUT_MS));
+    CHECK(!dedupe_check(dd, 9, false, 11, 11 + DEDUPE_STREAM_TIMEOUT_MS));
+    CHECK(dedupe_check(dd, 9, false, 10, 12 + DEDUPE_STREAM_TIMEOUT_MS));
+    // Rejected duplicates do not keep a window alive
+    uint32_t t = 11 + DEDUPE_STREAM_TIMEOUT_MS;
+    for (uint32_t ms = t; ms <= t + DEDUPE_STREAM_TIMEOUT_MS; ms += 100) {
+        CHECK(dedupe_check(dd, 9, false, 11, ms));
+    }
+    CHECK(!dedupe_check(dd, 9, false, 11, t + DEDUPE_STREAM_TIMEOUT_MS + 1));
+    // The parity window times out on its own
+    CHECK(!dedupe_check(dd, 9, true, 50, 0));
+    CHECK(!dedupe_check(dd, 9, true, 50, 2 * DEDUPE_STREAM_TIMEOUT_MS + 100));
+    // Timer wrap (ms since boot in 32 bits)
+    CHECK(!dedupe_check(dd, 10, false, 1, 0xFFFFFF00u));
+    CHECK(dedupe_check(dd, 10, false, 1, 0x00000010u));
+    CHECK(!dedupe_check(dd, 10, false, 1, 0xFFFFFF00u + DEDUPE_STREAM_TIMEOUT_MS + 1));
+    dedupe_destroy(dd);
+}
+
+// More streams than slots: a new stream takes a free slot, else the one
+// idle longest, and the streams still sending keep their windows
+static void test_slot_reuse(void) {
+    dedupe_t *dd = dedupe_create();
+    for (int id = 0; id < DEDUPE_STREAMS; id++) {
+        CHECK(!dedupe_check(dd, (uint8_t)id, false, 100, (uint32_t)id));
+    }
+    for (int id = 0; id < DEDUPE_STREAMS; id++) {
+        CHECK(dedupe_check(dd, (uint8_t)id, false, 100, 100));
+    }
+    // Stream 0 sends again, so stream 1 (idle longest) is the one replaced
+    CHECK(!dedupe_check(dd, 0, false, 101, 200));
+    CHECK(!dedupe_check(dd, 200, false, 100, 201));
+    CHECK(dedupe_check(dd, 200, false, 100, 201));
+    CHECK(dedupe_check(dd, 0, false, 101, 202));
+    CHECK(!dedupe_check(dd, 1, false, 100, 203));    // Forgotten: seen as new
+    CHECK(dedupe_check(dd, 0, false, 100, 204));
+    CHECK(dedupe_check(dd, 200, false, 100, 205));
+    for (int id = 3; id < DEDUPE_STREAMS; id++) {
+        CHECK(dedupe_check(dd, (uint8_t)id, false, 100, 206));
+    }
+
+    // Churn: 64 streams competing for the slots, 32 of them live (a frame
+    // every 5 ms) and 32 sending a single frame each. The live ones never
+    // lose their windows, since a one-off stream is always idle longer.
+    dedupe_reset(dd);
+    uint16_t seq = 0;
+    int live_repeats = 0;
+    for (uint32_t ms = 0; ms < 2000; ms += 5, seq++) {
+        for (int id = 0; id < DEDUPE_STREAMS / 2; id++) {
+            dedupe_check(dd, (uint8_t)id, false, seq, ms);
+            if (!dedupe_check(dd, (uint8_t)id, false, seq, ms)) live_repeats++;
+        }
+        if (ms % 50 == 0) dedupe_check(dd, (uint8_t)(128 + (ms / 50) % 64), false, 1, ms);
+    }
+    CHECK_EQ(live_repeats, 0);
+    dedupe_destroy(dd);
+}
+
+// Check-and-mark cost with 1, 8 and 32 interleaved streams, half the frames repeated
+static void test_speed(void) {
+    static const int streams[] = {1, 8, DEDUPE_STREAMS};
+    dedupe_t *dd = dedupe_create();
+    for (size_t k = 0; k < sizeof(streams) / sizeof(streams[0]); k++) {
+        dedupe_reset(dd);
+        const int n = 4000000;
+        volatile int dup = 0;
+        double t0 = test_now_s();
+        for (int i = 0; i < n; i++) {
+            int frame = i / 2;
+            uint8_t id = (uint8_t)(frame % streams[k] * 7);
+            uint16_t seq = (uint16_t)(frame / streams[k]);
+            dup += dedupe_check(dd, id, false, seq, (uint32_t)(frame / streams[k] / 200));
+        }
+        double ns = (test_now_s() - t0) / n * 1e9;
+        printf("%2d streams: %.1f ns per check\n", streams[k], ns);
+        CHECK_EQ(dup, n / 2);
+    }
+    dedupe_destroy(dd);
+}
+
+int main(void) {
+    RUN(test_duplicates);
+    RUN(test_window_slide);
+    RUN(test_seq_wrap);
+    RUN(test_stream_timeout);
+    RUN(test_slot_reuse);
+    RUN(test_speed);
+    return TEST_RESULT();
+}
@@ -0,0 +1,238 @@
+// Drift control: a TX clock ±200 ppm off the RX clock feeding the jitter
+// buffer, played out through the ASRC the way the RX main loop does it.
+// After the loop settles there must be no frame drops, gaps or underruns, the
+// correction must match the offset and the depth must stay on target. A busy-air
+// episode grows the adaptive target; shrinking back afterwards is left to the
+// ASRC, so the buffer's last-resort drop must not fire.
+// Simulates 1 hour per offset by default; pass hours as argv[1] for longer runs.
+// Separately, tones go through the interpolator at ±200 ppm to check its SNR
+// against the figures in drift_control.c and to time one output block.
+#include "audio/drift_control.h"
+#include "audio/jitter_buffer.h"
+#include "config/build.h"
+#include "test_util.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define FRAME_US        (AUDIO_FRAME_MS * 1000)
+#define SETTLE_S        120
+#define MAX_DELAY_US    3000              // Arrival spread on top of the TX clock
+#define WINDOW_BLOCKS   2000              // Rate averaged over 10 s windows
+#define BURST_DELAY_US  12000             // Busy-air episode: 12 ms spread for a minute
+#define BURST_BLOCKS    12000
+#define TONE_AMPLITUDE  (0.5 * 8388607.0) // -6 dBFS S24
+#define TONE_TARGET     (2 * AUDIO_FRAME_SAMPLES)
+#define TONE_MEASURE_S  10
+
+static jitter_buffer_t *jb;
+static uint32_t gaps = 0;
+
+static esp_err_t pull(int32_t *samples, void *ctx) {
+    audio_frame_t *frame = NULL;
+    esp_err_t ret = jitter_buffer_get(jb, &frame);
+    if (ret == ESP_OK) {
+        memset(samples, 0, AUDIO_FRAME_SAMPLES * sizeof(int32_t));
+        frame_pool_unref(frame);
+        return ESP_OK;
+    }
+    if (ret == ESP_ERR_NOT_FOUND) {
+        gaps++;
+        memset(samples, 0, AUDIO_FRAME_SAMPLES * sizeof(int32_t));
+        return ESP_OK;
+    }
+    return ret;
+}
+
+typedef struct {
+    double ppm_mean;         // Mean correction after settling
+    double ppm_max_dev;      // Worst |10 s mean correction - offset| after settling
+    int32_t fill_max;        // Worst |fill error| in samples after settling
+    uint32_t drops;
+    uint32_t gaps;
+    uint32_t late;
+} drift_result_t;
+
+static drift_result_t run(double offset_ppm, double hours, size_t drop_margin, bool burst) {
+    drift_result_t r = {0};
+    int32_t out[AUDIO_FRAME_SAMPLES];
+    jitter_buffer_stats_t st;
+
+    jb = jitter_buffer_create(JITTER_BUFFER_FRAMES, AUDIO_FRAME_BYTES, JITTER_PREFILL_FRAMES);
+    jitter_buffer_set_adaptive(jb, JITTER_FLOOR_FRAMES, JITTER_MAX_FRAMES, FRAME_US);
+    jitter_buffer_set_drop_margin(jb, drop_margin);
+    drift_control_init(pull, NULL);
+    gaps = 0;
+
+    // TX frame k leaves at k x 5 ms of the TX clock, seen on the RX clock
+    const double tx_period_us = FRAME_US / (1.0 + offset_ppm * 1e-6);
+    const uint64_t blocks = (uint64_t)(hours * 3600.0 * 1e6 / FRAME_US);
+    const uint64_t settle = (uint64_t)SETTLE_S * 1000000 / FRAME_US;
+    uint32_t tx_seq = 0;
+    double next_tx_us = 0.0;
+    int64_t next_arrival_us = MAX_DELAY_US;
+    int64_t last_arrival_us = 0;
+    uint32_t gaps_at_settle = 0, drops_at_settle = 0;
+    double window_sum = 0.0, total_sum = 0.0;
+    uint64_t window_n = 0, total_n = 0;
+
+    for (uint64_t b = 0; b < blocks; b++) {
+        int64_t now = (int64_t)b * FRAME_US;
+
+        // Deliver everything that has arrived by now (in order; the delay
+        // only moves arrivals later, never past the next frame's)
+        while (next_arrival_us <= now) {
+            audio_frame_t *f = frame_pool_alloc(0);
+            f->len = AUDIO_FRAME_BYTES;
+            jitter_buffer_put(jb, (uint16_t)tx_seq, (uint32_t)(next_tx_us / 1000.0), next_arrival_us, f);
+            frame_pool_unref(f);
+            last_arrival_us = next_arrival_us;
+            tx_seq++;
+            next_tx_us += tx_period_us;
+            uint32_t spread = (burst && b > settle && b < settle + BURST_BLOCKS) ? BURST_DELAY_US : MAX_DELAY_US;
+            int64_t arrival = (int64_t)next_tx_us + (int64_t)(test_rand() % spread);
+            next_arrival_us = arrival > next_arrival_us ? arrival : next_arrival_us;
+        }
+
+        // Fill error as the RX main loop computes it
+        jitter_buffer_get_stats(jb, &st);
+        int64_t age_us = now - last_arrival_us;
+        if (age_us < 0) age_us = 0;
+        if (age_us > FRAME_US) age_us = FRAME_US;
+        int32_t fill_error = ((int32_t)st.depth - (int32_t)st.target_depth) * AUDIO_FRAME_SAMPLES
+                           + (int32_t)(age_us * AUDIO_SAMPLE_RATE / 1000000) - AUDIO_FRAME_SAMPLES / 2;
+        drift_control_process(out, AUDIO_FRAME_SAMPLES, fill_error);
+
+        if (b == settle) {
+            gaps_at_settle = gaps;
+            drops_at_settle = st.drops;
+        }
+        if (b > settle) {
+            // The P term moves the ratio with arrival jitter from block to block;
+            // what has to track the offset is the rate averaged over seconds
+            double ppm = drift_control_get_ppm_error();
+            window_sum += ppm;
+            total_sum += ppm;
+            total_n++;
+            if (++window_n == WINDOW_BLOCKS) {
+                double dev = fabs(window_sum / WINDOW_BLOCKS - offset_ppm);
+                if (dev > r.ppm_max_dev) r.ppm_max_dev = dev;
+                window_sum = 0.0;
+                window_n = 0;
+            }
+            if (abs(fill_error) > r.fill_max) r.fill_max = abs(fill_error);
+        }
+    }
+
+    jitter_buffer_get_stats(jb, &st);
+    r.ppm_mean = total_n ? total_sum / total_n : 0.0;
+    r.drops = st.drops - drops_at_settle;
+    r.gaps = gaps - gaps_at_settle;
+    r.late = st.late;
+    jitter_buffer_destroy(jb);
+    return r;
+}
+
+// Tone source: input sample n is A sin(2 pi f n / fs), whatever rate it is read at
+typedef struct {
+    double freq_hz;
+    uint64_t pulled;     // Samples handed to the ASRC so far
+} tone_source_t;
+
+static esp_err_t tone_pull(int32_t *samples, void *ctx) {
+    tone_source_t *t = ctx;
+    for (size_t i = 0; i < AUDIO_FRAME_SAMPLES; i++, t->pulled++) {
+        samples[i] = (int32_t)lrint(TONE_AMPLITUDE * sin(2.0 * M_PI * t->freq_hz * t->pulled / AUDIO_SAMPLE_RATE));
+    }
+    return ESP_OK;
+}
+
+typedef struct {
+    double snr_db;
+    double block_us;     // Mean host time per drift_control_process() block
+} tone_result_t;
+
+// Plays a tone from a TX clock offset_ppm fast through the ASRC, the upstream
+// buffer being whatever the TX has delivered minus what the ASRC has pulled.
+// The input position of every output sample is rebuilt from the correction the
+// loop applied (the same Q32 step drift_control_process() takes), so the ideal
+// output is the tone at that position. One gain and phase are fitted over the
+// whole run; the residual is what the interpolator adds, including the level
+// and phase wobble as the fractional position sweeps through the phases.
+static tone_result_t tone_snr(double freq_hz, double offset_ppm) {
+    tone_result_t r = {0};
+    tone_source_t src = {.freq_hz = freq_hz};
+    int32_t out[AUDIO_FRAME_SAMPLES];
+    const uint64_t settle = (uint64_t)SETTLE_S * 1000000 / FRAME_US;
+    const uint64_t blocks = settle + (uint64_t)TONE_MEASURE_S * 1000000 / FRAME_US;
+    uint64_t pos_q32 = 0;   // Input position of the next output sample
+    double cc = 0, ss = 0, cs = 0, yc = 0, ys = 0, yy = 0, busy_s = 0.0;
+
+    drift_control_init(tone_pull, &src);
+    for (uint64_t b = 0; b < blocks; b++) {
+        double delivered = (double)(b * AUDIO_FRAME_SAMPLES) * (1.0 + offset_ppm * 1e-6) + TONE_TARGET;
+        int32_t fill_error = (int32_t)lrint(delivered - (double)src.pulled) - TONE_TARGET;
+
+        double t0 = test_now_s();
+        drift_control_process(out, AUDIO_FRAME_SAMPLES, fill_error);
+        busy_s += b >= settle ? test_now_s() - t0 : 0.0;
+
+        int64_t ppb = lrint(drift_control_get_ppm_error() * 1000.0f);
+        int64_t step = (1LL << 32) + ((ppb << 32) / 1000000000LL);
+        for (size_t i = 0; i < AUDIO_FRAME_SAMPLES; i++, pos_q32 += (uint64_t)step) {
+            if (b < settle) continue;
+            double th = 2.0 * M_PI * freq_hz * (pos_q32 / 4294967296.0) / AUDIO_SAMPLE_RATE;
+            double c = cos(th), sn = sin(th), y = out[i];
+            cc += c * c; ss += sn * sn; cs += c * sn;
+            yc += y * c; ys += y * sn; yy += y * y;
+        }
+    }
+
+    // Least-squares a cos + b sin; residual energy = yy - (a yc + b ys)
+    double det = cc * ss - cs * cs;
+    double a = (yc * ss - ys * cs) / det;
+    double bs = (ys * cc - yc * cs) / det;
+    double signal = a * yc + bs * ys;
+    r.snr_db = 10.0 * log10(signal / (yy - signal));
+    r.block_us = busy_s * 1e6 / (blocks - settle);
+    return r;
+}
+
+int main(int argc, char **argv) {
+    double hours = argc > 1 ? atof(argv[1]) : 1.0;
+    static const double offsets[] = {200.0, -200.0, 0.0};
+
+    frame_pool_init();
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        drift_result_t r = run(offsets[i], hours, JITTER_ASRC_DROP_MARGIN, false);
+        printf("%+.0f ppm, %.2f h: mean correction %+.1f ppm (10 s max dev %.1f), max fill error %ld samples, "
+               "drops %lu, gaps %lu, late %lu\n",
+               offsets[i], hours, r.ppm_mean, r.ppm_max_dev, (long)r.fill_max,
+               (unsigned long)r.drops, (unsigned long)r.gaps, (unsigned long)r.late);
+        CHECK(fabs(r.ppm_mean - offsets[i]) < 5.0);
+        CHECK(fabs(offsets[i]) + r.ppm_max_dev < DRIFT_MAX_PPM);   // 10 s average never at the clamp
+        CHECK(r.fill_max < 2 * AUDIO_FRAME_SAMPLES);
+        CHECK_EQ(r.drops, 0);
+        CHECK_EQ(r.gaps, 0);
+    }
+
+    drift_result_t r = run(200.0, 0.1, JITTER_ASRC_DROP_MARGIN, true);
+    printf("+200 ppm with a 1 min busy-air episode: drops %lu, gaps %lu, late %lu, mean correction %+.1f ppm\n",
+           (unsigned long)r.drops, (unsigned long)r.gaps, (unsigned long)r.late, r.ppm_mean);
+    CHECK_EQ(r.drops, 0);
+    CHECK_EQ(r.gaps, 0);
+
+    // SNR as documented in drift_control.c, a few dB of margin each
+    static const struct { double hz; double min_snr_db; } tones[] = {
+        {1000.0, 90.0}, {10000.0, 78.0}, {15000.0, 73.0}, {18000.0, 36.0}, {20000.0, 19.0},
+    };
+    for (size_t i = 0; i < sizeof(tones) / sizeof(tones[0]); i++) {
+        for (int sign = -1; sign <= 1; sign += 2) {
+            tone_result_t t = tone_snr(tones[i].hz, sign * 200.0);
+            printf("%5.0f Hz at %+d ppm: SNR %.1f dB, %.1f us per %d-sample block\n",
+                   tones[i].hz, sign * 200, t.snr_db, t.block_us, AUDIO_FRAME_SAMPLES);
+            CHECK(t.snr_db > tones[i].min_snr_db);
+        }
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,157 @@
+// dsp_chain: boosts that need coefficients beyond ±2 (shelves above ~+1 dB
+// wrapped in Q2.30), rejection of designs that don't fit Q5.27,
+// the basic responses, and the error-feedback DC blocker
+#include "audio/dsp_chain.h"
+#include "config/build.h"
+#include "test_util.h"
+
+#include <math.h>
+
+#define FS          ((double)AUDIO_SAMPLE_RATE)
+#define AMPLITUDE   (1 << 19)   // i24 headroom for +12 dB and the filters' overshoot
+#define SETTLE      (FS / 2)    // Samples discarded while the filters settle
+#define MEASURE     9600        // 200 ms
+
+// Steady-state gain in dB of chain at freq_hz: sine in, RMS out / RMS in
+static double gain_db(dsp_chain_t *chain, double freq_hz) {
+    static int32_t buf[AUDIO_FRAME_SAMPLES];
+    double phase = 0.0, in_sq = 0.0, out_sq = 0.0;
+    const double step = 2.0 * M_PI * freq_hz / FS;
+    dsp_chain_reset(chain);
+    for (size_t n = 0; n < SETTLE + MEASURE; n += AUDIO_FRAME_SAMPLES) {
+        double in_frame = 0.0;
+        for (size_t i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
+            buf[i] = (int32_t)lrint(AMPLITUDE * sin(phase));
+            in_frame += (double)buf[i] * buf[i];
+            phase = fmod(phase + step, 2.0 * M_PI);
+        }
+        dsp_chain_process(chain, buf, AUDIO_FRAME_SAMPLES);
+        if (n >= SETTLE) {
+            in_sq += in_frame;
+            for (size_t i = 0; i < AUDIO_FRAME_SAMPLES; i++) out_sq += (double)buf[i] * buf[i];
+        }
+    }
+    return 10.0 * log10(out_sq / in_sq);
+}
+
+static double single_stage_gain(dsp_filter_type_t type, double f0, double q, double boost, double at_hz) {
+    dsp_chain_t *chain = dsp_chain_create(1);
+    CHECK_EQ(dsp_chain_add(chain, type, (float)f0, (float)q, (float)boost), ESP_OK);
+    double g = gain_db(chain, at_hz);
+    dsp_chain_destroy(chain);
+    return g;
+}
+
+#define CHECK_NEAR(v, expect, tol) CHECK(fabs((v) - (expect)) <= (tol))
+
+static void test_boosts(void) {
+    // The review cases: b0 3.7, b1 -7.0 for the 1 kHz high shelf
+    double hs = single_stage_gain(DSP_FILTER_HIGH_SHELF, 1000, DSP_Q_BUTTERWORTH, 12, 12000);
+    double hs_low = single_stage_gain(DSP_FILTER_HIGH_SHELF, 1000, DSP_Q_BUTTERWORTH, 12, 50);
+    double ls = single_stage_gain(DSP_FILTER_LOW_SHELF, 200, DSP_Q_BUTTERWORTH, 12, 20);
+    double ls_high = single_stage_gain(DSP_FILTER_LOW_SHELF, 200, DSP_Q_BUTTERWORTH, 12, 5000);
+    double pk = single_stage_gain(DSP_FILTER_PEAKING, 1000, 1.0, 12, 1000);
+    double pk_off = single_stage_gain(DSP_FILTER_PEAKING, 1000, 1.0, 12, 100);
+    printf("+12 dB: high shelf %.2f / %.2f dB, low shelf %.2f / %.2f dB, bell %.2f / %.2f dB\n",
+           hs, hs_low, ls, ls_high, pk, pk_off);
+    CHECK_NEAR(hs, 12.0, 0.1);
+    CHECK_NEAR(hs_low, 0.0, 0.1);
+    CHECK_NEAR(ls, 12.0, 0.2);
+    CHECK_NEAR(ls_high, 0.0, 0.1);
+    CHECK_NEAR(pk, 12.0, 0.05);
+    CHECK_NEAR(pk_off, 0.0, 0.3);
+
+    // Cuts mirror the boosts
+    CHECK_NEAR(single_stage_gain(DSP_FILTER_HIGH_SHELF, 1000, DSP_Q_BUTTERWORTH, -12, 12000), -12.0, 0.1);
+    CHECK_NEAR(single_stage_gain(DSP_FILTER_PEAKING, 1000, 1.0, -12, 1000), -12.0, 0.05);
+}
+
+// Designs past the range are refused and leave the chain as it was
+static void test_out_of_range(void) {
+    dsp_chain_t *chain = dsp_chain_create(2);
+    CHECK_EQ(dsp_chain_add(chain, DSP_FILTER_HIGH_SHELF, 1000, DSP_Q_BUTTERWORTH, 24), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(dsp_chain_add(chain, DSP_FILTER_HIGH_SHELF, 20, DSP_Q_BUTTERWORTH, 19), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(dsp_chain_stages(chain), 0);
+
+    CHECK_EQ(dsp_chain_add(chain, DSP_FILTER_PEAKING, 1000, 1.0f, 6), ESP_OK);
+    CHECK_EQ(dsp_chain_set(chain, 0, DSP_FILTER_HIGH_SHELF, 1000, DSP_Q_BUTTERWORTH, 24), ESP_ERR_INVALID_ARG);
+    CHECK_NEAR(gain_db(chain, 1000), 6.0, 0.05);   // Old design kept
+
+    CHECK_EQ(dsp_chain_add(chain, DSP_FILTER_LOWPASS, 0, 0, 0), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(dsp_chain_add(chain, DSP_FILTER_LOWPASS, 24000, 0, 0), ESP_ERR_INVALID_ARG);
+    dsp_chain_destroy(chain);
+
+    // Largest boost each type takes at 1 kHz (informational)
+    const dsp_filter_type_t types[3] = {DSP_FILTER_HIGH_SHELF, DSP_FILTER_LOW_SHELF, DSP_FILTER_PEAKING};
+    const char *names[3] = {"high shelf", "low shelf", "bell (q 0.707)"};
+    for (int t = 0; t < 3; t++) {
+        chain = dsp_chain_create(1);
+        double db = 0.0;
+        while (db < 40.0 && dsp_chain_add(chain, types[t], 1000, DSP_Q_BUTTERWORTH, (float)(db + 0.5)) == ESP_OK) {
+            db += 0.5;
+            dsp_chain_destroy(chain);
+            chain = dsp_chain_create(1);
+        }
+        printf("max boost at 1 kHz: %s %.1f dB\n", names[t], db);
+        CHECK(db >= 18.0);
+        dsp_chain_destroy(chain);
+    }
+}
+
+static void test_responses(void) {
+    // Linkwitz-Riley 4: -6 dB at the corner per leg
+    dsp_chain_t *lr = dsp_chain_create(2);
+    dsp_chain_add(lr, DSP_FILTER_LOWPASS, 2000, DSP_Q_BUTTERWORTH, 0);
+    dsp_chain_add(lr, DSP_FILTER_LOWPASS, 2000, DSP_Q_BUTTERWORTH, 0);
+    CHECK_NEAR(gain_db(lr, 2000), -6.02, 0.05);
+    CHECK_NEAR(gain_db(lr, 200), 0.0, 0.05);
+    CHECK(gain_db(lr, 20000) < -40.0);
+    dsp_chain_destroy(lr);
+
+    CHECK_NEAR(single_stage_gain(DSP_FILTER_HIGHPASS, 100, DSP_Q_BUTTERWORTH, 0, 100), -3.01, 0.05);
+    CHECK_NEAR(single_stage_gain(DSP_FILTER_LOWPASS1, 800, 0, 0, 800), -3.01, 0.05);
+    CHECK_NEAR(single_stage_gain(DSP_FILTER_HIGHPASS1, 800, 0, 0, 800), -3.01, 0.05);
+}
+
+// DC blocker at 10 Hz: a DC offset decays to exactly zero (no truncation
+// residue thanks to error feedback) and audio passes
+static void test_dc_block(void) {
+    dsp_chain_t *chain = dsp_chain_create(1);
+    dsp_chain_add(chain, DSP_FILTER_DC_BLOCK, 10, 0, 0);
+    static int32_t buf[AUDIO_FRAME_SAMPLES];
+    int32_t peak = 0;
+    for (int frame = 0; frame < 2000; frame++) {   // 10 s
+        for (size_t i = 0; i < AUDIO_FRAME_SAMPLES; i++) buf[i] = 100000;
+        dsp_chain_process(chain, buf, AUDIO_FRAME_SAMPLES);
+        if (frame >= 1800) {
+            for (size_t i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
+                if (abs(buf[i]) > peak) peak = abs(buf[i]);
+            }
+        }
+    }
+    CHECK(peak <= 1);
+    CHECK_NEAR(gain_db(chain, 1000), 0.0, 0.01);
+    dsp_chain_destroy(chain);
+}
+
+static void test_speed(void) {
+    dsp_chain_t *chain = dsp_chain_create(4);
+    for (int s = 0; s < 4; s++) dsp_chain_add(chain, DSP_FILTER_PEAKING, 1000, 1.0f, 6);
+    static int32_t buf[AUDIO_FRAME_SAMPLES];
+    for (size_t i = 0; i < AUDIO_FRAME_SAMPLES; i++) buf[i] = (int32_t)(test_rand() >> 12) - (1 << 19);
+    const int frames = 20000;
+    double t0 = test_now_s();
+    for (int f = 0; f < frames; f++) dsp_chain_process(chain, buf, AUDIO_FRAME_SAMPLES);
+    double t1 = test_now_s();
+    printf("4 biquads on the host: %.2f us per 240-sample frame\n", (t1 - t0) * 1e6 / frames);
+    dsp_chain_destroy(chain);
+}
+
+int main(void) {
+    RUN(test_boosts);
+    RUN(test_out_of_range);
+    RUN(test_responses);
+    RUN(test_dc_block);
+    RUN(test_speed);
+    return TEST_RESULT();
+}
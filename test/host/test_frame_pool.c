@@ -0,0 +1,180 @@
+// Frame pool: allocation until empty, ref/unref balance and reuse, unref of a
+// frame that is already free, and several threads allocating, sharing and
+// freeing frames at once with every frame owned by one holder at a time
+#include "audio/frame_pool.h"
+#include "test_util.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#define THREADS         4
+#define THREAD_ITERS    2000000
+#define THREAD_HOLD     8               // Frames each thread holds at once: the pool runs dry
+
+static frame_pool_stats_t stats(void) {
+    frame_pool_stats_t st;
+    frame_pool_get_stats(&st);
+    return st;
+}
+
+static void test_alloc_until_empty(void) {
+    audio_frame_t *frames[FRAME_POOL_FRAMES];
+    frame_pool_stats_t before = stats();
+
+    for (size_t i = 0; i < FRAME_POOL_FRAMES; i++) {
+        frames[i] = frame_pool_alloc(16);
+        CHECK(frames[i] != NULL);
+        if (!frames[i]) return;
+        CHECK(frames[i]->data == frames[i]->buf + 16);
+        CHECK_EQ(frames[i]->len, 0);
+        for (size_t j = 0; j < i; j++) {
+            CHECK(frames[j] != frames[i]);
+        }
+    }
+    CHECK(frame_pool_alloc(0) == NULL);
+    CHECK(frame_pool_alloc(0) == NULL);
+    frame_pool_stats_t st = stats();
+    CHECK_EQ(st.in_use, FRAME_POOL_FRAMES);
+    CHECK_EQ(st.high_water, FRAME_POOL_FRAMES);
+    CHECK_EQ(st.exhausted, before.exhausted + 2);
+
+    for (size_t i = 0; i < FRAME_POOL_FRAMES; i++) {
+        frame_pool_unref(frames[i]);
+    }
+    CHECK_EQ(stats().in_use, 0);
+    CHECK(frame_pool_alloc(FRAME_POOL_BUF_BYTES + 1) == NULL);   // Headroom past the buffer
+}
+
+static void test_ref_unref_balance(void) {
+    audio_frame_t *f = frame_pool_alloc(0);
+    CHECK(f != NULL);
+    if (!f) return;
+    frame_pool_ref(f);
+    frame_pool_ref(f);
+    frame_pool_unref(f);
+    frame_pool_unref(f);
+    CHECK_EQ(stats().in_use, 1);           // The allocation's reference is still held
+    frame_pool_unref(f);
+    CHECK_EQ(stats().in_use, 0);
+    CHECK(frame_pool_alloc(0) == f);       // LIFO: the frame just freed comes back
+    frame_pool_unref(f);
+    frame_pool_unref(NULL);
+    CHECK_EQ(stats().in_use, 0);
+}
+
+static void test_double_unref(void) {
+    audio_frame_t *frames[FRAME_POOL_FRAMES];
+    frame_pool_stats_t before = stats();
+
+    audio_frame_t *f = frame_pool_alloc(0);
+    CHECK(f != NULL);
+    if (!f) return;
+    frame_pool_unref(f);
+    frame_pool_unref(f);
+    frame_pool_stats_t st = stats();
+    CHECK_EQ(st.bad_unrefs, before.bad_unrefs + 1);
+    CHECK_EQ(st.in_use, 0);
+
+    // The frame went back once: the pool still holds each frame exactly once
+    size_t n = 0;
+    while (n < FRAME_POOL_FRAMES && (frames[n] = frame_pool_alloc(0)) != NULL) n++;
+    CHECK_EQ(n, FRAME_POOL_FRAMES);
+    CHECK(frame_pool_alloc(0) == NULL);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < i; j++) CHECK(frames[j] != frames[i]);
+        frame_pool_unref(frames[i]);
+    }
+    CHECK_EQ(stats().in_use, 0);
+}
+
+// Each thread stamps the frames it holds with its id and checks the stamp
+// before letting go; half the frames are handed to the next thread, which
+// drops the last reference, so frames are freed on other threads than they
+// were allocated on
+typedef struct {
+    int id;
+    uint32_t allocs;
+    uint32_t corrupt;
+} worker_t;
+
+static _Atomic(audio_frame_t *) handoff[THREADS];
+
+static void* worker(void *arg) {
+    worker_t *w = arg;
+    audio_frame_t *held[THREAD_HOLD] = {0};
+
+    for (uint32_t it = 0; it < THREAD_ITERS; it++) {
+        size_t slot = it % THREAD_HOLD;
+        if (held[slot]) {
+            if (held[slot]->data[0] != w->id || held[slot]->data[FRAME_POOL_BUF_BYTES - 1] != w->id) w->corrupt++;
+            if (it & 1) {
+                // Keep a reference and pass one on; the taker drops it
+                frame_pool_ref(held[slot]);
+                audio_frame_t *old = atomic_exchange(&handoff[w->id % THREADS], held[slot]);
+                frame_pool_unref(old);
+            }
+            frame_pool_unref(held[slot]);
+            held[slot] = NULL;
+        }
+        audio_frame_t *taken = atomic_exchange(&handoff[w->id - 1], NULL);
+        frame_pool_unref(taken);
+
+        held[slot] = frame_pool_alloc(0);
+        if (held[slot]) {
+            w->allocs++;
+            held[slot]->data[0] = (uint8_t)w->id;
+            held[slot]->data[FRAME_POOL_BUF_BYTES - 1] = (uint8_t)w->id;
+        }
+    }
+    for (size_t i = 0; i < THREAD_HOLD; i++) frame_pool_unref(held[i]);
+    return NULL;
+}
+
+static void test_threads(void) {
+    pthread_t threads[THREADS];
+    worker_t workers[THREADS];
+    uint32_t allocs = 0, corrupt = 0;
+    frame_pool_stats_t before = stats();
+
+    for (int i = 0; i < THREADS; i++) {
+        workers[i] = (worker_t){.id = i + 1};
+        pthread_create(&threads[i], NULL, worker, &workers[i]);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        allocs += workers[i].allocs;
+        corrupt += workers[i].corrupt;
+    }
+    for (int i = 0; i < THREADS; i++) {
+        frame_pool_unref(atomic_exchange(&handoff[i], NULL));
+    }
+
+    frame_pool_stats_t st = stats();
+    printf("%d threads: %lu allocations, %lu refused, high water %lu/%lu\n", THREADS, (unsigned long)allocs,
+           (unsigned long)(st.exhausted - before.exhausted), (unsigned long)st.high_water, (unsigned long)st.total);
+    CHECK(allocs > 0);
+    CHECK_EQ(corrupt, 0);
+    CHECK_EQ(st.in_use, 0);
+    CHECK_EQ(st.bad_unrefs, before.bad_unrefs);
+
+    // Nothing lost or duplicated in the free stack
+    audio_frame_t *frames[FRAME_POOL_FRAMES];
+    size_t n = 0;
+    while (n < FRAME_POOL_FRAMES && (frames[n] = frame_pool_alloc(0)) != NULL) n++;
+    CHECK_EQ(n, FRAME_POOL_FRAMES);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < i; j++) CHECK(frames[j] != frames[i]);
+        frame_pool_unref(frames[i]);
+    }
+}
+
+int main(void) {
+    frame_pool_init();
+    frame_pool_init();    // Idempotent
+    CHECK_EQ(stats().total, FRAME_POOL_FRAMES);
+    RUN(test_alloc_until_empty);
+    RUN(test_ref_unref_balance);
+    RUN(test_double_unref);
+    RUN(test_threads);
+    return TEST_RESULT();
+}
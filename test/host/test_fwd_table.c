@@ -0,0 +1,327 @@
+// Forwarding table: children come and go, a report narrows what a child gets
+// until it expires, and the sender is never a target. Then airtime per frame
+// in simulated 3-layer meshes, relaying to direct children from the table
+// against the old fan-out to (the first 10 of) the routing table.
+#include "network/fwd_table.h"
+#include "network/dedupe.h"
+#include "network/mesh_net.h"
+#include "test_util.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define MAX_CHILDREN CONTROL_STATE_CACHE_MAX_NODES
+
+static void mac_of(int node, uint8_t *mac) {
+    static const uint8_t oui[3] = {0x24, 0x6F, 0x28};
+    memcpy(mac, oui, 3);
+    mac[3] = 0;
+    mac[4] = (uint8_t)(node >> 8);
+    mac[5] = (uint8_t)node;
+}
+
+static void set_stream(uint8_t *streams, int stream_id) {
+    streams[stream_id >> 3] |= (uint8_t)(1u << (stream_id & 7));
+}
+
+static bool has_target(uint8_t (*out)[6], size_t n, int node) {
+    uint8_t mac[6];
+    mac_of(node, mac);
+    for (size_t i = 0; i < n; i++) {
+        if (memcmp(out[i], mac, 6) == 0) return true;
+    }
+    return false;
+}
+
+static void test_add_remove(void) {
+    fwd_table_t *ft = fwd_table_create(4);
+    uint8_t mac[6], out[8][6];
+    for (int n = 1; n <= 4; n++) {
+        mac_of(n, mac);
+        CHECK_EQ(fwd_table_add(ft, mac), ESP_OK);
+    }
+    mac_of(2, mac);
+    CHECK_EQ(fwd_table_add(ft, mac), ESP_OK);      // Known: no-op
+    CHECK_EQ(fwd_table_count(ft), 4);
+    mac_of(5, mac);
+    CHECK_EQ(fwd_table_add(ft, mac), ESP_ERR_NO_MEM);
+    CHECK(!fwd_table_report(ft, mac, (uint8_t[NET_STREAM_BITMAP_BYTES]){0}, 0));
+
+    mac_of(2, mac);
+    fwd_table_remove(ft, mac);
+    fwd_table_remove(ft, mac);
+    CHECK_EQ(fwd_table_count(ft), 3);
+    size_t n = fwd_table_targets(ft, FWD_ALL_STREAMS, NULL, 0, out, 8);
+    CHECK_EQ(n, 3);
+    CHECK(has_target(out, n, 1) && !has_target(out, n, 2) && has_target(out, n, 3) && has_target(out, n, 4));
+    mac_of(5, mac);
+    CHECK_EQ(fwd_table_add(ft, mac), ESP_OK);      // Room again
+    CHECK_EQ(fwd_table_targets(ft, FWD_ALL_STREAMS, NULL, 0, out, 2), 2);   // Capped by the caller
+
+    fwd_table_clear(ft);
+    CHECK_EQ(fwd_table_count(ft), 0);
+    CHECK_EQ(fwd_table_targets(ft, FWD_ALL_STREAMS, NULL, 0, out, 8), 0);
+    fwd_table_destroy(ft);
+}
+
+static void test_reports(void) {
+    fwd_table_t *ft = fwd_table_create(MAX_CHILDREN);
+    uint8_t mac[6], out[MAX_CHILDREN][6];
+    for (int n = 1; n <= 3; n++) {
+        mac_of(n, mac);
+        fwd_table_add(ft, mac);
+    }
+    // Nothing reported: every child gets every stream
+    CHECK_EQ(fwd_table_targets(ft, 7, NULL, 0, out, MAX_CHILDREN), 3);
+    uint8_t sub[NET_STREAM_BITMAP_BYTES] = {0};
+    fwd_table_subtree_streams(ft, 0, sub);
+    for (int j = 0; j < NET_STREAM_BITMAP_BYTES; j++) CHECK_EQ(sub[j], 0xFF);
+
+    // Child 1 plays stream 7, child 2 stream 200, child 3 nothing
+    uint8_t s1[NET_STREAM_BITMAP_BYTES] = {0}, s2[NET_STREAM_BITMAP_BYTES] = {0};
+    uint8_t s3[NET_STREAM_BITMAP_BYTES] = {0};
+    set_stream(s1, 7);
+    set_stream(s2, 200);
+    mac_of(1, mac);
+    CHECK(fwd_table_report(ft, mac, s1, 1000));
+    mac_of(2, mac);
+    CHECK(fwd_table_report(ft, mac, s2, 1000));
+    mac_of(3, mac);
+    CHECK(fwd_table_report(ft, mac, s3, 1000));
+
+    size_t n = fwd_table_targets(ft, 7, NULL, 1000, out, MAX_CHILDREN);
+    CHECK(n == 1 && has_target(out, n, 1));
+    n = fwd_table_targets(ft, 200, NULL, 1000, out, MAX_CHILDREN);
+    CHECK(n == 1 && has_target(out, n, 2));
+    CHECK_EQ(fwd_table_targets(ft, 9, NULL, 1000, out, MAX_CHILDREN), 0);
+    CHECK_EQ(fwd_table_targets(ft, FWD_ALL_STREAMS, NULL, 1000, out, MAX_CHILDREN), 3);
+    memset(sub, 0, sizeof(sub));
+    fwd_table_subtree_streams(ft, 1000, sub);
+    for (int id = 0; id < 256; id++) {
+        CHECK_EQ((sub[id >> 3] >> (id & 7)) & 1, id == 7 || id == 200);
+    }
+
+    // Child 2 keeps reporting; the others' reports expire and they get everything
+    mac_of(2, mac);
+    CHECK(fwd_table_report(ft, mac, s2, 1000 + FWD_REPORT_TIMEOUT_MS));
+    CHECK_EQ(fwd_table_targets(ft, 9, NULL, 1000 + FWD_REPORT_TIMEOUT_MS, out, MAX_CHILDREN), 0);
+    n = fwd_table_targets(ft, 9, NULL, 1001 + FWD_REPORT_TIMEOUT_MS, out, MAX_CHILDREN);
+    CHECK(n == 2 && has_target(out, n, 1) && has_target(out, n, 3));
+    memset(sub, 0, sizeof(sub));
+    fwd_table_subtree_streams(ft, 1001 + FWD_REPORT_TIMEOUT_MS, sub);
+    CHECK_EQ(sub[1], 0xFF);
+
+    // A child that reconnects starts unreported again
+    mac_of(2, mac);
+    fwd_table_remove(ft, mac);
+    fwd_table_add(ft, mac);
+    n = fwd_table_targets(ft, 9, NULL, 1001 + FWD_REPORT_TIMEOUT_MS, out, MAX_CHILDREN);
+    CHECK_EQ(n, 3);
+    fwd_table_destroy(ft);
+}
+
+static void test_exclude_sender(void) {
+    fwd_table_t *ft = fwd_table_create(MAX_CHILDREN);
+    uint8_t mac[6], out[MAX_CHILDREN][6];
+    for (int n = 1; n <= MAX_CHILDREN; n++) {
+        mac_of(n, mac);
+        CHECK_EQ(fwd_table_add(ft, mac), ESP_OK);
+    }
+    mac_of(17, mac);
+    size_t n = fwd_table_targets(ft, FWD_ALL_STREAMS, mac, 0, out, MAX_CHILDREN);
+    CHECK_EQ(n, MAX_CHILDREN - 1);
+    CHECK(!has_target(out, n, 17));
+    mac_of(99, mac);
+    CHECK_EQ(fwd_table_targets(ft, FWD_ALL_STREAMS, mac, 0, out, MAX_CHILDREN), MAX_CHILDREN);
+    fwd_table_destroy(ft);
+}
+
+// --- Simulated mesh -------------------------------------------------------
+// Node 0 is the root (the source); the tree is given as each node's parent.
+// A transmission is one frame on the air for one hop: a unicast to a node k
+// layers down costs k, since every node on the path relays it at the mesh
+// layer without the application seeing it.
+
+#define SIM_NODES          64
+#define LEGACY_ROUTES      10     // Stack array size in the old forward_to_children
+#define SIM_STREAM         42
+
+typedef struct {
+    int parent[SIM_NODES];
+    int layer[SIM_NODES];
+    int n;
+    fwd_table_t *table[SIM_NODES];
+    dedupe_t *dedupe[SIM_NODES];
+} sim_mesh_t;
+
+typedef struct {
+    int transmissions;    // Hops on the air
+    int receptions;       // Frames handed to the relay task
+    int duplicates;       // ...that dedupe dropped
+    int reached;          // Nodes that got the frame (root included)
+} sim_result_t;
+
+// Root, layer1 children under it and layer2 grandchildren spread evenly over
+// them (1-3-9: three children, three grandchildren each)
+static void sim_build(sim_mesh_t *m, int layer1, int layer2) {
+    memset(m, 0, sizeof(*m));
+    m->n = 1 + layer1 + layer2;
+    m->parent[0] = -1;
+    for (int i = 0; i < layer1; i++) {
+        m->parent[1 + i] = 0;
+        m->layer[1 + i] = 1;
+    }
+    for (int i = 0; i < layer2; i++) {
+        m->parent[1 + layer1 + i] = 1 + i % layer1;
+        m->layer[1 + layer1 + i] = 2;
+    }
+    for (int v = 0; v < m->n; v++) {
+        m->table[v] = fwd_table_create(MAX_CHILDREN);
+        m->dedupe[v] = dedupe_create();
+    }
+    // Child connected events
+    for (int v = 1; v < m->n; v++) {
+        uint8_t mac[6];
+        mac_of(v, mac);
+        CHECK_EQ(fwd_table_add(m->table[m->parent[v]], mac), ESP_OK);
+    }
+}
+
+static void sim_free(sim_mesh_t *m) {
+    for (int v = 0; v < m->n; v++) {
+        fwd_table_destroy(m->table[v]);
+        dedupe_destroy(m->dedupe[v]);
+    }
+}
+
+// A node's routing table: itself, then its subtree depth-first (each branch
+// in the order it joined)
+static int sim_routes(const sim_mesh_t *m, int v, int *out, int count) {
+    out[count++] = v;
+    for (int c = 0; c < m->n; c++) {
+        if (m->parent[c] == v) count = sim_routes(m, c, out, count);
+    }
+    return count;
+}
+
+// Deliver one frame from the root breadth-first. legacy: each node unicasts
+// to the first LEGACY_ROUTES entries of its routing table, itself included
+// (that copy never goes on the air); otherwise to the fwd_table targets.
+static sim_result_t sim_frame(sim_mesh_t *m, uint16_t seq, uint32_t now_ms, bool legacy) {
+    sim_result_t r = {0};
+    int queue[SIM_NODES * SIM_NODES], from[SIM_NODES * SIM_NODES];
+    bool got[SIM_NODES] = {0};
+    int head = 0, tail = 0;
+
+    queue[tail] = 0;
+    from[tail++] = -1;
+    while (head < tail) {
+        int v = queue[head], sender = from[head++];
+        if (sender >= 0) {
+            r.receptions++;
+            if (dedupe_check(m->dedupe[v], SIM_STREAM, false, seq, now_ms)) {
+                r.duplicates++;
+                continue;
+            }
+        }
+        got[v] = true;
+
+        if (legacy) {
+            int routes[SIM_NODES];
+            int count = sim_routes(m, v, routes, 0);
+            for (int i = 1; i < count && i < LEGACY_ROUTES; i++) {
+                int d = routes[i];
+                r.transmissions += m->layer[d] - m->layer[v];
+                queue[tail] = d;
+                from[tail++] = v;
+            }
+        } else {
+            uint8_t out[MAX_CHILDREN][6], sender_mac[6];
+            if (sender >= 0) mac_of(sender, sender_mac);
+            size_t n = fwd_table_targets(m->table[v], SIM_STREAM, sender >= 0 ? sender_mac : NULL,
+                                         now_ms, out, MAX_CHILDREN);
+            for (size_t i = 0; i < n; i++) {
+                r.transmissions++;
+                queue[tail] = out[i][4] << 8 | out[i][5];
+                from[tail++] = v;
+            }
+        }
+    }
+    for (int v = 0; v < m->n; v++) r.reached += got[v];
+    return r;
+}
+
+static void test_airtime(void) {
+    static const int shapes[][2] = {{3, 9}, {4, 16}, {10, 20}};
+    for (size_t k = 0; k < sizeof(shapes) / sizeof(shapes[0]); k++) {
+        sim_mesh_t m;
+        sim_build(&m, shapes[k][0], shapes[k][1]);
+        sim_result_t old = {0}, now = {0}, r;
+        const int frames = 100;
+        for (int f = 0; f < frames; f++) {
+            r = sim_frame(&m, (uint16_t)f, (uint32_t)f * 5, true);
+            old.transmissions += r.transmissions;
+            old.duplicates += r.duplicates;
+            old.reached += r.reached;
+        }
+        for (int v = 0; v < m.n; v++) dedupe_reset(m.dedupe[v]);
+        for (int f = 0; f < frames; f++) {
+            r = sim_frame(&m, (uint16_t)f, (uint32_t)f * 5, false);
+            now.transmissions += r.transmissions;
+            now.duplicates += r.duplicates;
+            now.reached += r.reached;
+        }
+        printf("1-%d-%d mesh, per frame: routing table %.1f hops (%.1f duplicates, %.1f/%d reached), "
+               "direct children %.1f hops (%.1f duplicates, %.1f/%d reached)\n",
+               shapes[k][0], shapes[k][1],
+               (double)old.transmissions / frames, (double)old.duplicates / frames,
+               (double)old.reached / frames, m.n,
+               (double)now.transmissions / frames, (double)now.duplicates / frames,
+               (double)now.reached / frames, m.n);
+        // One hop per node, each reached exactly once
+        CHECK_EQ(now.transmissions, frames * (m.n - 1));
+        CHECK_EQ(now.duplicates, 0);
+        CHECK_EQ(now.reached, frames * m.n);
+        // The old fan-out either resends down the tree or misses nodes past its 10 entries
+        CHECK(old.transmissions > now.transmissions || old.reached < now.reached);
+        sim_free(&m);
+    }
+}
+
+// Only the leaves under the first layer-1 node play the stream: once the
+// reports have gone up the tree, frames only go down that branch
+static void test_subscribed_branch(void) {
+    sim_mesh_t m;
+    sim_build(&m, 3, 9);
+    uint32_t now_ms = 10000;
+    // Reports go up leaves first, each node sending local | subtree_streams
+    for (int layer = 2; layer >= 1; layer--) {
+        for (int v = 1; v < m.n; v++) {
+            if (m.layer[v] != layer) continue;
+            uint8_t streams[NET_STREAM_BITMAP_BYTES] = {0}, mac[6];
+            if (layer == 2 && m.parent[v] == 1) set_stream(streams, SIM_STREAM);
+            fwd_table_subtree_streams(m.table[v], now_ms, streams);
+            mac_of(v, mac);
+            CHECK(fwd_table_report(m.table[m.parent[v]], mac, streams, now_ms));
+        }
+    }
+    sim_result_t r = sim_frame(&m, 1, now_ms, false);
+    printf("1-3-9 mesh, one branch subscribed: %d hops, %d/%d reached\n", r.transmissions, r.reached, m.n);
+    CHECK_EQ(r.transmissions, 4);    // Node 1 and its three children
+    CHECK_EQ(r.reached, 5);
+    CHECK_EQ(r.duplicates, 0);
+
+    // Reports stop: after the timeout every branch gets the stream again
+    r = sim_frame(&m, 2, now_ms + FWD_REPORT_TIMEOUT_MS + 1, false);
+    CHECK_EQ(r.transmissions, m.n - 1);
+    sim_free(&m);
+}
+
+int main(void) {
+    RUN(test_add_remove);
+    RUN(test_reports);
+    RUN(test_exclude_sender);
+    RUN(test_airtime);
+    RUN(test_subscribed_branch);
+    return TEST_RESULT();
+}
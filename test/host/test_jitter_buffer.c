@@ -0,0 +1,242 @@
+// Jitter buffer: reordering, late/duplicate return codes, gaps, 16-bit seq
+// wrap, the 4x-capacity resync, batch puts, and the adaptive depth target
+#include "audio/jitter_buffer.h"
+#include "test_util.h"
+
+#include <esp_timer.h>
+
+#define FRAME_BYTES 8
+#define FRAME_US    5000
+
+static jitter_buffer_t *jb;
+
+// Frame carrying its seq in the first bytes so playout order can be checked
+static esp_err_t put(uint16_t seq) {
+    audio_frame_t *f = frame_pool_alloc(0);
+    if (!f) return ESP_ERR_NO_MEM;
+    f->len = FRAME_BYTES;
+    f->data[0] = (uint8_t)seq;
+    f->data[1] = (uint8_t)(seq >> 8);
+    esp_err_t ret = jitter_buffer_put(jb, seq, (uint32_t)seq * 5, esp_timer_get_time(), f);
+    frame_pool_unref(f);
+    return ret;
+}
+
+// ESP_OK and the played seq in *seq, or the get error
+static esp_err_t get(int *seq) {
+    audio_frame_t *f = NULL;
+    esp_err_t ret = jitter_buffer_get(jb, &f);
+    if (ret == ESP_OK) {
+        *seq = f->data[0] | (f->data[1] << 8);
+        frame_pool_unref(f);
+    }
+    return ret;
+}
+
+static uint32_t pool_in_use(void) {
+    frame_pool_stats_t st;
+    frame_pool_get_stats(&st);
+    return st.in_use;
+}
+
+static void setup(size_t prefill) {
+    jb = jitter_buffer_create(16, FRAME_BYTES, prefill);
+}
+
+static void teardown(void) {
+    jitter_buffer_destroy(jb);
+    CHECK_EQ(pool_in_use(), 0);   // Every slot reference went back to the pool
+}
+
+static void test_reorder_and_prefill(void) {
+    int seq = -1;
+    setup(3);
+    CHECK_EQ(put(11), ESP_OK);
+    CHECK_EQ(get(&seq), ESP_ERR_INVALID_STATE);   // Prefilling
+    CHECK_EQ(put(10), ESP_OK);                    // Ahead of the first frame: head moves back
+    CHECK_EQ(put(13), ESP_OK);
+    CHECK_EQ(put(12), ESP_OK);
+    for (int expect = 10; expect <= 13; expect++) {
+        CHECK_EQ(get(&seq), ESP_OK);
+        CHECK_EQ(seq, expect);
+    }
+    teardown();
+}
+
+static void test_late_duplicate_gap(void) {
+    int seq = -1;
+    jitter_buffer_stats_t st;
+    setup(2);
+    CHECK_EQ(put(100), ESP_OK);
+    CHECK_EQ(put(101), ESP_OK);
+    CHECK_EQ(put(101), ESP_ERR_INVALID_STATE);    // Duplicate
+    CHECK_EQ(put(103), ESP_OK);                   // 102 lost
+    CHECK_EQ(get(&seq), ESP_OK);
+    CHECK_EQ(seq, 100);
+    CHECK_EQ(put(99), ESP_ERR_TIMEOUT);           // Its slot has been played
+    CHECK_EQ(put(100), ESP_ERR_TIMEOUT);
+    CHECK_EQ(get(&seq), ESP_OK);
+    CHECK_EQ(seq, 101);
+    CHECK_EQ(get(&seq), ESP_ERR_NOT_FOUND);       // Gap for the caller to conceal
+    CHECK_EQ(put(102), ESP_ERR_TIMEOUT);          // Arrived after the gap was played
+    CHECK_EQ(get(&seq), ESP_OK);
+    CHECK_EQ(seq, 103);
+
+    jitter_buffer_get_stats(jb, &st);
+    CHECK_EQ(st.received, 3);
+    CHECK_EQ(st.played, 3);
+    CHECK_EQ(st.missing, 1);
+    CHECK_EQ(st.late, 3);
+    CHECK_EQ(st.duplicates, 1);
+
+    // Wrong frame size is refused without touching the slots
+    audio_frame_t *f = frame_pool_alloc(0);
+    f->len = FRAME_BYTES - 1;
+    CHECK_EQ(jitter_buffer_put(jb, 104, 0, 0, f), ESP_ERR_INVALID_SIZE);
+    frame_pool_unref(f);
+    teardown();
+}
+
+static void test_seq_wrap(void) {
+    int seq = -1;
+    setup(4);
+    for (uint32_t s = 65530; s < 65530 + 12; s++) {
+        CHECK_EQ(put((uint16_t)s), ESP_OK);
+    }
+    CHECK_EQ(jitter_buffer_depth(jb), 12);
+    for (uint32_t s = 65530; s < 65530 + 12; s++) {
+        CHECK_EQ(get(&seq), ESP_OK);
+        CHECK_EQ(seq, (uint16_t)s);
+    }
+    CHECK_EQ(put(65535), ESP_ERR_TIMEOUT);       // Behind the head across the wrap
+    teardown();
+}
+
+static void test_overflow_and_resync(void) {
+    int seq = -1;
+    jitter_buffer_stats_t st;
+    setup(2);
+    CHECK_EQ(put(0), ESP_OK);
+    CHECK_EQ(put(1), ESP_OK);
+    CHECK_EQ(get(&seq), ESP_OK);                  // Playing, head 1
+
+    // 63 ahead (< 4 x 16): the head skips forward, frames in between are dropped
+    CHECK_EQ(put(64), ESP_OK);
+    jitter_buffer_get_stats(jb, &st);
+    CHECK_EQ(st.overflows, 64 - 16 + 1 - 1);
+    CHECK_EQ(jitter_buffer_depth(jb), 16);
+
+    // 4 x capacity from the head: a new stream (TX restart), so the buffer restarts
+    CHECK_EQ(put(49 + 64), ESP_OK);
+    CHECK_EQ(jitter_buffer_depth(jb), 1);
+    CHECK_EQ(get(&seq), ESP_ERR_INVALID_STATE);   // Prefilling again
+    CHECK_EQ(put(49 + 65), ESP_OK);
+    CHECK_EQ(get(&seq), ESP_OK);
+    CHECK_EQ(seq, 49 + 64);
+
+    // Far behind restarts as well
+    CHECK_EQ(put(40000), ESP_OK);
+    CHECK_EQ(jitter_buffer_depth(jb), 1);
+    teardown();
+}
+
+static void test_underrun_restart(void) {
+    int seq = -1;
+    jitter_buffer_stats_t st;
+    setup(1);
+    CHECK_EQ(put(5), ESP_OK);
+    CHECK_EQ(get(&seq), ESP_OK);
+    for (int i = 0; i < 16; i++) {
+        CHECK_EQ(get(&seq), ESP_ERR_NOT_FOUND);
+    }
+    // A full buffer of empty slots gives up on the stream
+    CHECK_EQ(get(&seq), ESP_ERR_INVALID_STATE);
+    jitter_buffer_get_stats(jb, &st);
+    CHECK_EQ(st.underruns, 16);
+    teardown();
+}
+
+static void test_batch_put(void) {
+    jitter_buffer_entry_t entries[4];
+    esp_err_t results[4];
+    setup(2);
+    const uint16_t seqs[4] = {7, 6, 7, 8};
+    for (int i = 0; i < 4; i++) {
+        entries[i].frame = frame_pool_alloc(0);
+        entries[i].frame->len = FRAME_BYTES;
+        entries[i].seq = seqs[i];
+        entries[i].timestamp = seqs[i] * 5;
+        entries[i].arrival_us = 0;
+    }
+    CHECK_EQ(jitter_buffer_put_batch(jb, entries, 4, results), 3);
+    CHECK_EQ(results[0], ESP_OK);
+    CHECK_EQ(results[1], ESP_OK);
+    CHECK_EQ(results[2], ESP_ERR_INVALID_STATE);
+    CHECK_EQ(results[3], ESP_OK);
+    for (int i = 0; i < 4; i++) {
+        frame_pool_unref(entries[i].frame);
+    }
+    CHECK_EQ(jitter_buffer_depth(jb), 3);
+    teardown();
+}
+
+// Feed frames every 5 ms with arrival jitter, play one per 5 ms; returns the target
+static uint32_t run_adaptive(uint16_t *seq, int frames, int jitter_us) {
+    jitter_buffer_stats_t st;
+    int played;
+    for (int i = 0; i < frames; i++) {
+        int64_t now = (int64_t)i * FRAME_US;
+        int64_t delay = jitter_us ? (int64_t)(test_rand() % (uint32_t)jitter_us) : 0;
+        audio_frame_t *f = frame_pool_alloc(0);
+        f->len = FRAME_BYTES;
+        jitter_buffer_put(jb, *seq, (uint32_t)(*seq) * 5, 1000000000LL + now + delay, f);
+        frame_pool_unref(f);
+        (*seq)++;
+        get(&played);
+    }
+    jitter_buffer_get_stats(jb, &st);
+    return st.target_depth;
+}
+
+static void test_adaptive_target(void) {
+    uint16_t seq = 0;
+    setup(4);
+    CHECK_EQ(jitter_buffer_set_adaptive(jb, 2, 12, FRAME_US), ESP_OK);
+    CHECK_EQ(jitter_buffer_set_adaptive(jb, 0, 12, FRAME_US), ESP_ERR_INVALID_ARG);
+
+    // 20 ms of arrival spread: target grows to cover it (4 x J + one frame)
+    uint32_t busy = run_adaptive(&seq, 2000, 20000);
+    CHECK(busy >= 6 && busy <= 12);
+
+    // Quiet link: shrinks back to the floor, one frame per 2 s hold
+    uint32_t quiet = run_adaptive(&seq, 8000, 0);
+    CHECK_EQ(quiet, 2);
+
+    // A late frame grows the target by one right away
+    int played;
+    jitter_buffer_stats_t before, after;
+    jitter_buffer_get_stats(jb, &before);
+    get(&played);
+    get(&played);
+    audio_frame_t *f = frame_pool_alloc(0);
+    f->len = FRAME_BYTES;
+    CHECK_EQ(jitter_buffer_put(jb, (uint16_t)(seq - 8), 0, 0, f), ESP_ERR_TIMEOUT);
+    frame_pool_unref(f);
+    jitter_buffer_get_stats(jb, &after);
+    CHECK_EQ(after.target_depth, before.target_depth + 1);
+    printf("adaptive: target %lu frames at 20 ms jitter, %lu quiet\n",
+           (unsigned long)busy, (unsigned long)quiet);
+    teardown();
+}
+
+int main(void) {
+    frame_pool_init();
+    RUN(test_reorder_and_prefill);
+    RUN(test_late_duplicate_gap);
+    RUN(test_seq_wrap);
+    RUN(test_overflow_and_resync);
+    RUN(test_underrun_restart);
+    RUN(test_batch_put);
+    RUN(test_adaptive_target);
+    return TEST_RESULT();
+}
@@ -0,0 +1,287 @@
+// Mesh relay path: mesh_net.c's receive and delivery tasks run as threads
+// against a scripted radio. esp_mesh_recv hands over one packet at a time and
+// esp_mesh_send records each forward to the child, so the per-hop forward time
+// (recv returning to the child's send) is timed with the delivery queue empty
+// and again while the audio callback is stalled and the queue is full; the
+// local drops that follow are read back from network_get_rx_stats.
+#include "network/mesh_net.h"
+#include "test_util.h"
+
+#include <esp_mesh.h>
+#include <esp_mac.h>
+#include <esp_timer.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#define STREAM              7
+#define PAYLOAD_BYTES       40      // An Opus frame at 64 kbps
+#define FRAME_US            5000    // 200 fps, as a stream arrives
+#define IDLE_FRAMES         200
+#define BACKLOG_FRAMES      200     // Sent while the callback is stalled: 1 s
+#define DELIVER_QUEUE_LEN   8       // MESH_DELIVER_QUEUE_LEN in mesh_net.c
+#define TOTAL_FRAMES        (IDLE_FRAMES + 1 + BACKLOG_FRAMES)
+#define WAIT_MS             2000
+
+static const uint8_t parent_sta[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x10};
+static const uint8_t parent_bssid[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x11};   // softAP = STA + 1
+static const uint8_t self_sta[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x20};
+static const uint8_t child_sta[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x30};
+
+// The radio: one packet waits for esp_mesh_recv at a time
+static pthread_mutex_t radio_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t radio_cond = PTHREAD_COND_INITIALIZER;
+static uint8_t pending[NET_FRAME_HEADER_SIZE + PAYLOAD_BYTES];
+static bool pending_set, rx_waiting;
+static int64_t recv_us[TOTAL_FRAMES + 1];   // By seq: esp_mesh_recv returning it
+static int64_t sent_us[TOTAL_FRAMES + 1];   // By seq: forwarded to the child
+static uint32_t forwarded, subscriptions;
+
+// The audio callback: records what it gets and blocks while stalled
+static pthread_mutex_t sink_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sink_cond = PTHREAD_COND_INITIALIZER;
+static bool stalled;
+static uint32_t delivered, bad_frames;
+static uint16_t delivered_seq[TOTAL_FRAMES];
+
+esp_err_t esp_mesh_recv(mesh_addr_t *from, mesh_data_t *data, int timeout_ms, int *flag,
+                        void *opt, int opt_count) {
+    pthread_mutex_lock(&radio_lock);
+    rx_waiting = true;
+    pthread_cond_broadcast(&radio_cond);
+    while (!pending_set) pthread_cond_wait(&radio_cond, &radio_lock);
+    memcpy(data->data, pending, sizeof(pending));
+    data->size = sizeof(pending);
+    memcpy(from->addr, parent_sta, 6);
+    *flag = MESH_DATA_P2P;
+    pending_set = false;
+    rx_waiting = false;
+    recv_us[ntohs(((const net_frame_header_t *)pending)->seq)] = esp_timer_get_time();
+    pthread_mutex_unlock(&radio_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_mesh_send(const mesh_addr_t *to, const mesh_data_t *data, int flag,
+                        const void *opt, int opt_count) {
+    int64_t now_us = esp_timer_get_time();
+    const net_frame_header_t *hdr = (const net_frame_header_t *)data->data;
+    if (!to) return ESP_OK;     // Heartbeats and the like, towards the root
+
+    pthread_mutex_lock(&radio_lock);
+    if (memcmp(to->addr, child_sta, 6) == 0 && hdr->type == NET_PKT_TYPE_AUDIO_OPUS) {
+        uint16_t seq = ntohs(hdr->seq);
+        if (seq <= TOTAL_FRAMES) sent_us[seq] = now_us;
+        forwarded++;
+    } else if (memcmp(to->addr, parent_sta, 6) == 0 && hdr->type == NET_PKT_TYPE_SUBSCRIBE) {
+        subscriptions++;
+    }
+    pthread_mutex_unlock(&radio_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_mesh_get_parent_bssid(mesh_addr_t *bssid) {
+    memcpy(bssid->addr, parent_bssid, 6);
+    return ESP_OK;
+}
+
+int esp_mesh_get_layer(void) { return 2; }
+int esp_mesh_get_routing_table_size(void) { return 1; }
+bool esp_mesh_is_root(void) { return false; }
+
+// Deadline WAIT_MS from now, for the waits on the tasks under test
+static struct timespec wait_deadline(void) {
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += WAIT_MS / 1000;
+    return until;
+}
+
+// Hand the relay task one audio frame and return once it has dealt with it
+// (it is back in esp_mesh_recv); false if it did not get there in time
+static bool inject(uint16_t seq) {
+    net_frame_header_t hdr = {
+        .magic = NET_FRAME_MAGIC,
+        .version = NET_FRAME_VERSION,
+        .type = NET_PKT_TYPE_AUDIO_OPUS,
+        .stream_id = STREAM,
+        .seq = htons(seq),
+        .timestamp = htonl((uint32_t)seq * 5),
+        .payload_len = htons(PAYLOAD_BYTES),
+        .ttl = 4,
+    };
+    struct timespec until = wait_deadline();
+    int rc = 0;
+    pthread_mutex_lock(&radio_lock);
+    while (!rx_waiting && rc == 0) rc = pthread_cond_timedwait(&radio_cond, &radio_lock, &until);
+    if (rc == 0) {
+        memcpy(pending, &hdr, sizeof(hdr));
+        for (size_t i = 0; i < PAYLOAD_BYTES; i++) pending[NET_FRAME_HEADER_SIZE + i] = (uint8_t)(seq + i);
+        pending_set = true;
+        pthread_cond_broadcast(&radio_cond);
+    }
+    while ((pending_set || !rx_waiting) && rc == 0) rc = pthread_cond_timedwait(&radio_cond, &radio_lock, &until);
+    pthread_mutex_unlock(&radio_lock);
+    return rc == 0;
+}
+
+static void on_batch(const network_rx_frame_t *frames, size_t count) {
+    pthread_mutex_lock(&sink_lock);
+    for (size_t i = 0; i < count; i++) {
+        const network_rx_frame_t *f = &frames[i];
+        bool ok = f->stream_id == STREAM && f->type == NET_PKT_TYPE_AUDIO_OPUS &&
+                  f->frame->len == PAYLOAD_BYTES && f->timestamp == (uint32_t)f->seq * 5;
+        for (size_t b = 0; ok && b < PAYLOAD_BYTES; b++) ok = f->frame->data[b] == (uint8_t)(f->seq + b);
+        if (!ok) bad_frames++;
+        if (delivered < TOTAL_FRAMES) delivered_seq[delivered] = f->seq;
+        delivered++;
+    }
+    pthread_cond_broadcast(&sink_cond);
+    while (stalled) pthread_cond_wait(&sink_cond, &sink_lock);
+    pthread_mutex_unlock(&sink_lock);
+}
+
+static bool wait_delivered(uint32_t n) {
+    struct timespec until = wait_deadline();
+    pthread_mutex_lock(&sink_lock);
+    int rc = 0;
+    while (delivered < n && rc == 0) rc = pthread_cond_timedwait(&sink_cond, &sink_lock, &until);
+    bool done = delivered >= n;
+    pthread_mutex_unlock(&sink_lock);
+    return done;
+}
+
+static void set_stalled(bool stall) {
+    pthread_mutex_lock(&sink_lock);
+    stalled = stall;
+    pthread_cond_broadcast(&sink_cond);
+    pthread_mutex_unlock(&sink_lock);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Forward time of seqs [first, first + n): p50 and max in µs; unforwarded frames count as missing
+static void forward_times(uint16_t first, int n, uint32_t *p50, uint32_t *max, int *missing) {
+    uint32_t lat[BACKLOG_FRAMES + IDLE_FRAMES];
+    int got = 0;
+    pthread_mutex_lock(&radio_lock);
+    for (int i = 0; i < n; i++) {
+        uint16_t seq = (uint16_t)(first + i);
+        if (sent_us[seq] != 0) lat[got++] = (uint32_t)(sent_us[seq] - recv_us[seq]);
+    }
+    pthread_mutex_unlock(&radio_lock);
+    *missing = n - got;
+    *p50 = *max = 0;
+    if (got == 0) return;
+    qsort(lat, got, sizeof(uint32_t), cmp_u32);
+    *p50 = lat[got / 2];
+    *max = lat[got - 1];
+}
+
+static network_rx_stats_t rx_stats(void) {
+    network_rx_stats_t st;
+    network_get_rx_stats(&st);
+    return st;
+}
+
+// Callback keeping up: each frame is delivered before the next arrives
+static void test_forward_idle(void) {
+    uint32_t p50, max;
+    int missing;
+    for (uint16_t seq = 1; seq <= IDLE_FRAMES; seq++) {
+        bool ok = inject(seq) && wait_delivered(seq);
+        CHECK(ok);
+        if (!ok) return;
+    }
+    forward_times(1, IDLE_FRAMES, &p50, &max, &missing);
+    printf("queue empty:   forward p50 %lu us, max %lu us\n", (unsigned long)p50, (unsigned long)max);
+    CHECK_EQ(missing, 0);
+    CHECK_EQ(delivered, IDLE_FRAMES);
+    CHECK_EQ(rx_stats().delivery_drops, 0);
+}
+
+// Callback stalled for the length of BACKLOG_FRAMES: the queue fills and the
+// local copies after it are dropped, but every frame still goes to the child
+// within a frame period of arriving
+static void test_forward_backlog(void) {
+    const uint16_t stall_seq = IDLE_FRAMES + 1;
+    network_rx_stats_t before = rx_stats();
+    uint32_t fill_p50, fill_max, full_p50, full_max;
+    int fill_missing, full_missing;
+
+    set_stalled(true);
+    CHECK(inject(stall_seq));
+    CHECK(wait_delivered(IDLE_FRAMES + 1));         // The callback now holds the delivery task
+    bool relaying = true;
+    for (int i = 1; i <= BACKLOG_FRAMES && relaying; i++) {
+        usleep(FRAME_US);
+        relaying = inject((uint16_t)(stall_seq + i));
+    }
+    CHECK(relaying);
+
+    // Still stalled: forwarding never waited on it
+    forward_times(stall_seq + 1, DELIVER_QUEUE_LEN, &fill_p50, &fill_max, &fill_missing);
+    forward_times(stall_seq + 1 + DELIVER_QUEUE_LEN, BACKLOG_FRAMES - DELIVER_QUEUE_LEN,
+                  &full_p50, &full_max, &full_missing);
+    network_rx_stats_t st = rx_stats();
+    frame_pool_stats_t pool;
+    frame_pool_get_stats(&pool);
+    printf("queue filling: forward p50 %lu us, max %lu us\n", (unsigned long)fill_p50, (unsigned long)fill_max);
+    printf("queue full:    forward p50 %lu us, max %lu us, %lu local copies dropped\n", (unsigned long)full_p50,
+           (unsigned long)full_max, (unsigned long)(st.delivery_drops - before.delivery_drops));
+    CHECK_EQ(fill_missing, 0);
+    CHECK_EQ(full_missing, 0);
+    CHECK(fill_max < FRAME_US);
+    CHECK(full_max < FRAME_US);
+    CHECK_EQ(delivered, IDLE_FRAMES + 1);
+    CHECK_EQ(st.delivery_drops - before.delivery_drops, BACKLOG_FRAMES - DELIVER_QUEUE_LEN);
+    CHECK_EQ(pool.in_use, 1 + DELIVER_QUEUE_LEN + 1);   // Stalled batch, queue, receive buffer
+
+    // Released: the queued frames follow in order, and only the receive buffer stays out
+    set_stalled(false);
+    CHECK(wait_delivered(IDLE_FRAMES + 1 + DELIVER_QUEUE_LEN));
+    for (int i = 0; i < 1000 && (frame_pool_get_stats(&pool), pool.in_use) > 1; i++) usleep(1000);
+    st = rx_stats();
+    CHECK_EQ(delivered, IDLE_FRAMES + 1 + DELIVER_QUEUE_LEN);
+    for (int i = 0; i <= DELIVER_QUEUE_LEN; i++) {
+        CHECK_EQ(delivered_seq[IDLE_FRAMES + i], stall_seq + i);
+    }
+    CHECK_EQ(st.delivered, delivered);
+    CHECK_EQ(st.delivered + st.delivery_drops, TOTAL_FRAMES);
+    CHECK_EQ(pool.in_use, 1);
+    CHECK_EQ(pool.bad_unrefs, 0);
+}
+
+static void test_stats(void) {
+    network_rx_stats_t st = rx_stats();
+    printf("rx stats: %lu relayed, relay avg %lu us, max %lu us\n", (unsigned long)st.relayed,
+           (unsigned long)st.relay_avg_us, (unsigned long)st.relay_max_us);
+    CHECK_EQ(st.relayed, TOTAL_FRAMES);
+    CHECK_EQ(forwarded, TOTAL_FRAMES);
+    CHECK(st.relay_max_us < FRAME_US);
+    CHECK_EQ(bad_frames, 0);
+}
+
+int main(void) {
+    host_time_use_real_clock(true);
+    host_mac_set(self_sta);
+    CHECK_EQ(network_init_mesh(), ESP_OK);
+
+    mesh_event_connected_t parent = {.self_layer = 2};
+    memcpy(parent.connected.addr, parent_bssid, 6);
+    host_event_post(MESH_EVENT, MESH_EVENT_PARENT_CONNECTED, &parent);
+    mesh_event_child_connected_t child = {.aid = 1};
+    memcpy(child.mac, child_sta, 6);
+    host_event_post(MESH_EVENT, MESH_EVENT_CHILD_CONNECTED, &child);
+
+    CHECK_EQ(network_register_audio_batch_callback(on_batch), ESP_OK);
+    CHECK_EQ(network_subscribe_stream(STREAM), ESP_OK);
+    CHECK_EQ(subscriptions, 1);      // Reported to the parent (its STA address)
+
+    RUN(test_forward_idle);
+    RUN(test_forward_backlog);
+    RUN(test_stats);
+    return TEST_RESULT();
+}
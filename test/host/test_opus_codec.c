@@ -0,0 +1,162 @@
+// Opus codec: encode/decode round trip at the stream settings (CBR frame size,
+// SNR), init split between encoder and decoder, per-frame CPU on the host, and
+// SNR against bitrate with the same encoder settings
+#include "audio/opus_codec.h"
+#include "config/build.h"
+#include "test_util.h"
+
+#include <opus.h>
+#include <string.h>
+
+#define TEST_FRAMES 400    // 2 s
+#define SKIP_FRAMES 20     // Encoder start-up
+// Waveform SNR floor at OPUS_BITRATE_BPS: CELT is perceptual, so this is well
+// under what a transparent codec would give, but far above a broken path
+#define MIN_SNR_DB  12.0
+
+static int16_t input[TEST_FRAMES * AUDIO_FRAME_SAMPLES];
+static int16_t output[TEST_FRAMES * AUDIO_FRAME_SAMPLES];
+
+static void fill_multitone(void) {
+    static const double freqs[] = {220.0, 1000.0, 3150.0};
+    for (size_t n = 0; n < TEST_FRAMES * AUDIO_FRAME_SAMPLES; n++) {
+        double t = (double)n / AUDIO_SAMPLE_RATE, v = 0.0;
+        for (size_t k = 0; k < 3; k++) {
+            v += sin(2.0 * M_PI * freqs[k] * t);
+        }
+        input[n] = (int16_t)lrint(v / 3.0 * 16000.0);
+    }
+}
+
+// Best normalized correlation of output against input over the codec delay
+static double best_correlation(size_t skip, int *best_lag) {
+    double best = -1.0;
+    const size_t total = TEST_FRAMES * AUDIO_FRAME_SAMPLES;
+    for (int lag = 0; lag <= 2 * AUDIO_FRAME_SAMPLES; lag++) {
+        double xy = 0.0, xx = 0.0, yy = 0.0;
+        for (size_t n = skip; n + lag < total; n++) {
+            double x = input[n], y = output[n + lag];
+            xy += x * y;
+            xx += x * x;
+            yy += y * y;
+        }
+        double c = xy / sqrt(xx * yy + 1e-9);
+        if (c > best) {
+            best = c;
+            *best_lag = lag;
+        }
+    }
+    return best;
+}
+
+// SNR of output against input delayed by lag, after the encoder start-up
+static double aligned_snr_db(const int16_t *out, int lag) {
+    double sig = 0.0, err = 0.0;
+    const size_t total = TEST_FRAMES * AUDIO_FRAME_SAMPLES;
+    for (size_t n = SKIP_FRAMES * AUDIO_FRAME_SAMPLES; n + lag < total; n++) {
+        double x = input[n], d = (double)out[n + lag] - x;
+        sig += x * x;
+        err += d * d;
+    }
+    return 10.0 * log10(sig / (err + 1e-9));
+}
+
+static void test_uninitialized(void) {
+    uint8_t packet[OPUS_MAX_FRAME_BYTES];
+    int16_t pcm[AUDIO_FRAME_SAMPLES] = {0};
+    int len = 0, samples = 0;
+    CHECK_EQ(opus_codec_encode(pcm, AUDIO_FRAME_SAMPLES, packet, &len), ESP_ERR_INVALID_STATE);
+    CHECK_EQ(opus_codec_decode(packet, 10, pcm, &samples), ESP_ERR_INVALID_STATE);
+
+    // The decoder alone leaves encoding unavailable (RX builds)
+    CHECK_EQ(opus_codec_decoder_init(), ESP_OK);
+    CHECK_EQ(opus_codec_encode(pcm, AUDIO_FRAME_SAMPLES, packet, &len), ESP_ERR_INVALID_STATE);
+    CHECK_EQ(opus_codec_encoder_init(), ESP_OK);
+    CHECK_EQ(opus_codec_encoder_init(), ESP_OK);   // Repeat init is harmless
+}
+
+static void test_round_trip(void) {
+    uint8_t packet[OPUS_MAX_FRAME_BYTES];
+    double enc_s = 0.0, dec_s = 0.0;
+    int min_len = OPUS_MAX_FRAME_BYTES, max_len = 0;
+
+    fill_multitone();
+    for (size_t f = 0; f < TEST_FRAMES; f++) {
+        int len = 0, samples = 0;
+        double t0 = test_now_s();
+        CHECK_EQ(opus_codec_encode(input + f * AUDIO_FRAME_SAMPLES, AUDIO_FRAME_SAMPLES, packet, &len), ESP_OK);
+        double t1 = test_now_s();
+        CHECK_EQ(opus_codec_decode(packet, len, output + f * AUDIO_FRAME_SAMPLES, &samples), ESP_OK);
+        dec_s += test_now_s() - t1;
+        enc_s += t1 - t0;
+        CHECK_EQ(samples, AUDIO_FRAME_SAMPLES);
+        if (len < min_len) min_len = len;
+        if (len > max_len) max_len = len;
+    }
+
+    // CBR: every frame is bitrate x 5 ms (40 bytes at 64 kbps)
+    const int cbr_bytes = OPUS_BITRATE_BPS / 8 * AUDIO_FRAME_MS / 1000;
+    CHECK_EQ(min_len, cbr_bytes);
+    CHECK_EQ(max_len, cbr_bytes);
+
+    int lag = 0;
+    double corr = best_correlation(SKIP_FRAMES * AUDIO_FRAME_SAMPLES, &lag);
+    CHECK(corr > 0.9);
+    CHECK(lag <= AUDIO_FRAME_SAMPLES);   // 2.5 ms algorithmic delay
+    double snr = aligned_snr_db(output, lag);
+    CHECK(snr > MIN_SNR_DB);
+
+    printf("opus: %d-byte frames, correlation %.4f at %d samples delay, SNR %.1f dB\n",
+           max_len, corr, lag, snr);
+    printf("opus: host encode %.1f us/frame, decode %.1f us/frame\n",
+           enc_s * 1e6 / TEST_FRAMES, dec_s * 1e6 / TEST_FRAMES);
+}
+
+// The codec's encoder settings at other bitrates (libopus directly, since
+// opus_codec takes its bitrate from build.h); the delay is the one found above
+static void test_bitrate_quality(void) {
+    static const int rates[] = {32000, 48000, OPUS_BITRATE_BPS, 96000, 128000};
+    static int16_t out[TEST_FRAMES * AUDIO_FRAME_SAMPLES];
+    double snr_lowest = 0.0, snr_highest = 0.0;
+
+    fill_multitone();
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        int err = OPUS_OK;
+        OpusEncoder *enc = opus_encoder_create(AUDIO_SAMPLE_RATE, AUDIO_CHANNELS,
+                                               OPUS_APPLICATION_RESTRICTED_LOWDELAY, &err);
+        OpusDecoder *dec = opus_decoder_create(AUDIO_SAMPLE_RATE, AUDIO_CHANNELS, &err);
+        CHECK(enc && dec);
+        if (!enc || !dec) return;
+        opus_encoder_ctl(enc, OPUS_SET_BITRATE(rates[r]));
+        opus_encoder_ctl(enc, OPUS_SET_COMPLEXITY(OPUS_COMPLEXITY));
+        opus_encoder_ctl(enc, OPUS_SET_SIGNAL(OPUS_SIGNAL_MUSIC));
+        opus_encoder_ctl(enc, OPUS_SET_VBR(0));
+
+        for (size_t f = 0; f < TEST_FRAMES; f++) {
+            uint8_t packet[OPUS_MAX_FRAME_BYTES];
+            opus_int32 len = opus_encode(enc, input + f * AUDIO_FRAME_SAMPLES, AUDIO_FRAME_SAMPLES,
+                                         packet, sizeof(packet));
+            CHECK(len > 0);
+            CHECK_EQ(opus_decode(dec, packet, len, out + f * AUDIO_FRAME_SAMPLES, AUDIO_FRAME_SAMPLES, 0),
+                     AUDIO_FRAME_SAMPLES);
+        }
+        int lag = 0;
+        memcpy(output, out, sizeof(out));
+        best_correlation(SKIP_FRAMES * AUDIO_FRAME_SAMPLES, &lag);
+        double snr = aligned_snr_db(out, lag);
+        printf("opus: %3d kbps (%3d bytes/frame): SNR %.1f dB\n", rates[r] / 1000,
+               rates[r] / 8 * AUDIO_FRAME_MS / 1000, snr);
+        if (r == 0) snr_lowest = snr;
+        snr_highest = snr;
+        opus_encoder_destroy(enc);
+        opus_decoder_destroy(dec);
+    }
+    CHECK(snr_highest > snr_lowest);
+}
+
+int main(void) {
+    RUN(test_uninitialized);
+    RUN(test_round_trip);
+    RUN(test_bitrate_quality);
+    return TEST_RESULT();
+}
@@ -0,0 +1,175 @@
+// Packet loss concealment: single and burst losses of a periodic signal, the
+// fade to silence over a long run, click-free resume, and per-frame cost
+#include "audio/plc.h"
+#include "config/build.h"
+#include "test_util.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define N AUDIO_FRAME_SAMPLES
+
+// Voiced-like test signal: 210 Hz fundamental (non-integer period) plus two harmonics, S24 range
+static void signal_frame(uint32_t frame, int32_t *out) {
+    for (size_t i = 0; i < N; i++) {
+        double t = (double)(frame * N + i) / AUDIO_SAMPLE_RATE;
+        double v = 0.6 * sin(2.0 * M_PI * 210.0 * t) + 0.3 * sin(2.0 * M_PI * 420.0 * t + 0.5) +
+                   0.1 * sin(2.0 * M_PI * 630.0 * t + 1.0);
+        out[i] = (int32_t)lrint(v * 4000000.0);
+    }
+}
+
+static int32_t peak(const int32_t *x) {
+    int32_t p = 0;
+    for (size_t i = 0; i < N; i++) {
+        int32_t a = abs(x[i]);
+        if (a > p) p = a;
+    }
+    return p;
+}
+
+// SNR of the concealed frame against the frame that was lost
+static double snr_db(const int32_t *ref, const int32_t *out) {
+    double s = 0.0, e = 0.0;
+    for (size_t i = 0; i < N; i++) {
+        double d = (double)out[i] - ref[i];
+        s += (double)ref[i] * ref[i];
+        e += d * d;
+    }
+    return 10.0 * log10(s / (e + 1.0));
+}
+
+// Largest sample-to-sample step across a stream of frames
+static int32_t max_step(const int32_t *x, size_t len) {
+    int32_t m = 0;
+    for (size_t i = 1; i < len; i++) {
+        int32_t d = abs(x[i] - x[i - 1]);
+        if (d > m) m = d;
+    }
+    return m;
+}
+
+// Play frames [0, total) with the frames in lost[] concealed; returns the output
+static void play(uint32_t total, const uint8_t *lost, int32_t *out) {
+    int32_t frame[N];
+    plc_reset();
+    for (uint32_t f = 0; f < total; f++) {
+        if (lost[f]) {
+            plc_conceal(frame);
+        } else {
+            signal_frame(f, frame);
+            plc_good_frame(frame);
+        }
+        memcpy(out + f * N, frame, sizeof(frame));
+    }
+}
+
+static int32_t stream[64 * N];
+static int32_t clean[64 * N];
+
+static void test_single_and_burst_loss(void) {
+    static const struct { uint32_t first, count; double min_snr; } cases[] = {
+        {10, 1, 20.0},     // Single 5 ms loss of a steady tone: near-exact pitch repeat
+        {10, 2, 15.0},     // Still within the 10 ms full-level hold
+    };
+    uint8_t lost[64] = {0};
+    int32_t frame[N];
+
+    for (uint32_t f = 0; f < 32; f++) {
+        signal_frame(f, frame);
+        memcpy(clean + f * N, frame, sizeof(frame));
+    }
+    int32_t signal_step = max_step(clean, 32 * N);
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        memset(lost, 0, sizeof(lost));
+        for (uint32_t k = 0; k < cases[c].count; k++) lost[cases[c].first + k] = 1;
+        play(32, lost, stream);
+        for (uint32_t k = 0; k < cases[c].count; k++) {
+            uint32_t f = cases[c].first + k;
+            double snr = snr_db(clean + f * N, stream + f * N);
+            printf("loss %lu x %lu: frame %lu SNR %.1f dB\n", (unsigned long)cases[c].first,
+                   (unsigned long)cases[c].count, (unsigned long)k, snr);
+            CHECK(snr > cases[c].min_snr);
+        }
+        // No clicks anywhere: concealment start, loop points and resume
+        CHECK(max_step(stream, 32 * N) < 2 * signal_step);
+    }
+}
+
+static void test_fade_out(void) {
+    uint8_t lost[64] = {0};
+    for (uint32_t f = 8; f < 30; f++) lost[f] = 1;
+    play(32, lost, stream);
+
+    int32_t level = peak(stream + 7 * N);
+    // Full level through the hold, then monotonically down to silence after 50 ms
+    for (uint32_t f = 8; f < 30; f++) {
+        int32_t p = peak(stream + f * N);
+        if (f <= 9) CHECK(p > level / 2);
+        CHECK(p <= level + level / 8);
+        level = p;
+        if (f >= 8 + 10) CHECK_EQ(p, 0);
+    }
+}
+
+static void test_resume_crossfade(void) {
+    uint8_t lost[64] = {0};
+    int32_t signal_step = max_step(clean, 32 * N);
+
+    // Resume mid-fade and after full silence: the real frame fades in from
+    // the synthetic signal, no step at the boundary
+    static const uint32_t runs[] = {4, 12};
+    for (size_t r = 0; r < 2; r++) {
+        memset(lost, 0, sizeof(lost));
+        for (uint32_t f = 8; f < 8 + runs[r]; f++) lost[f] = 1;
+        play(32, lost, stream);
+        uint32_t resume = 8 + runs[r];
+        CHECK(max_step(stream + (resume - 1) * N, 2 * N) < 2 * signal_step);
+        // Past the 2 ms cross-fade the real audio is untouched
+        for (size_t i = 96; i < N; i++) {
+            if (stream[resume * N + i] != clean[resume * N + i]) {
+                CHECK(stream[resume * N + i] == clean[resume * N + i]);
+                break;
+            }
+        }
+    }
+    plc_stats_t st;
+    plc_get_stats(&st);
+    CHECK(st.resumed > 0);
+}
+
+static void test_random_loss_and_cost(void) {
+    int32_t frame[N];
+    double worst = 0.0, total = 0.0;
+    uint32_t concealed = 0;
+
+    plc_reset();
+    for (uint32_t f = 0; f < 20000; f++) {
+        if (test_rand() % 20 == 0) {            // 5% random loss
+            double t0 = test_now_s();
+            plc_conceal(frame);
+            double dt = test_now_s() - t0;
+            total += dt;
+            if (dt > worst) worst = dt;
+            concealed++;
+        } else {
+            signal_frame(f, frame);
+            plc_good_frame(frame);
+        }
+    }
+    printf("conceal: %lu frames, host %.1f us/frame mean, %.1f us worst\n",
+           (unsigned long)concealed, total * 1e6 / concealed, worst * 1e6);
+    // Bounded work per frame: one pitch search (coarse + refine) and a copy;
+    // generous host bound so this only trips on an algorithmic regression
+    CHECK(total / concealed < 100e-6);
+}
+
+int main(void) {
+    plc_init();
+    RUN(test_single_and_burst_loss);
+    RUN(test_fade_out);
+    RUN(test_resume_crossfade);
+    RUN(test_random_loss_and_cost);
+    return TEST_RESULT();
+}
@@ -0,0 +1,186 @@
+// Resampler: passband ripple and in-band residual (images, aliases,
+// quantization) for every supported USB rate, alias rejection when
+// downsampling, exact input accounting, pass-through, and cost per frame
+#include "audio/resampler.h"
+#include "config/build.h"
+#include "test_util.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define OUT_FRAMES   AUDIO_FRAME_SAMPLES
+#define RUN_FRAMES   100                       // 0.5 s per tone
+#define SKIP_FRAMES  10                        // Filter delay and start-up
+#define AMPLITUDE    16384.0                   // -6 dBFS
+#define MAX_IN       (2 * OUT_FRAMES + 2)
+
+static const uint32_t rates[] = {44100, 32000, 96000};
+
+static double pass_edge(uint32_t in_rate) {
+    double low = in_rate < AUDIO_SAMPLE_RATE ? in_rate : AUDIO_SAMPLE_RATE;
+    return fmin(20000.0, 0.45 * low);
+}
+
+// Stereo tone through a fresh converter: left at freq_hz, right at half level
+// and inverted. Returns the left output; right is checked against it.
+static void run_tone(uint32_t in_rate, double freq_hz, double *left, size_t *count, bool *stereo_ok) {
+    resampler_t *rs = resampler_create(in_rate, AUDIO_SAMPLE_RATE, 2, OUT_FRAMES);
+    static int16_t in[MAX_IN * 2], out[OUT_FRAMES * 2];
+    uint64_t t = 0;
+    *count = 0;
+    *stereo_ok = true;
+    for (int frame = 0; frame < RUN_FRAMES; frame++) {
+        size_t need = resampler_input_needed(rs, OUT_FRAMES);
+        for (size_t i = 0; i < need; i++, t++) {
+            double v = AMPLITUDE * sin(2.0 * M_PI * freq_hz * (double)t / in_rate);
+            in[2 * i] = (int16_t)lrint(v);
+            in[2 * i + 1] = (int16_t)lrint(-v / 2);
+        }
+        CHECK_EQ(resampler_process(rs, in, need, out, OUT_FRAMES), OUT_FRAMES);
+        if (frame < SKIP_FRAMES) continue;
+        for (size_t i = 0; i < OUT_FRAMES; i++) {
+            left[(*count)++] = out[2 * i];
+            if (abs(out[2 * i + 1] * 2 + out[2 * i]) > 3) *stereo_ok = false;
+        }
+    }
+    resampler_destroy(rs);
+}
+
+// Least-squares fit of a*sin + b*cos + c at freq_hz: gain (dB re AMPLITUDE)
+// and the RMS of what is left (dB re the tone)
+static void fit_tone(const double *y, size_t n, double freq_hz, double *gain_db, double *residual_db) {
+    double w = 2.0 * M_PI * freq_hz / AUDIO_SAMPLE_RATE;
+    double m[3][4] = {{0}};
+    for (size_t i = 0; i < n; i++) {
+        double v[3] = {sin(w * i), cos(w * i), 1.0};
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) m[r][c] += v[r] * v[c];
+            m[r][3] += v[r] * y[i];
+        }
+    }
+    // Gaussian elimination on the 3x3 normal equations
+    for (int p = 0; p < 3; p++) {
+        for (int r = p + 1; r < 3; r++) {
+            double f = m[r][p] / m[p][p];
+            for (int c = p; c < 4; c++) m[r][c] -= f * m[p][c];
+        }
+    }
+    double x[3];
+    for (int r = 2; r >= 0; r--) {
+        x[r] = m[r][3];
+        for (int c = r + 1; c < 3; c++) x[r] -= m[r][c] * x[c];
+        x[r] /= m[r][r];
+    }
+    double amp = sqrt(x[0] * x[0] + x[1] * x[1]);
+    double err = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double e = y[i] - (x[0] * sin(w * i) + x[1] * cos(w * i) + x[2]);
+        err += e * e;
+    }
+    *gain_db = 20.0 * log10(amp / AMPLITUDE);
+    *residual_db = 10.0 * log10(err / n / (amp * amp / 2.0));
+}
+
+static double out_buf[RUN_FRAMES * OUT_FRAMES];
+
+static void test_passband(void) {
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        double edge = pass_edge(rates[r]);
+        double lo = 1e9, hi = -1e9, worst_residual = -1e9;
+        bool stereo = true;
+        for (int k = 0; k <= 24; k++) {
+            double f = 50.0 * pow(edge / 50.0, k / 24.0);   // Log-spaced up to the edge
+            size_t n;
+            bool ok;
+            run_tone(rates[r], f, out_buf, &n, &ok);
+            double g, res;
+            fit_tone(out_buf, n, f, &g, &res);
+            if (g < lo) lo = g;
+            if (g > hi) hi = g;
+            if (res > worst_residual) worst_residual = res;
+            stereo = stereo && ok;
+        }
+        printf("%5lu Hz: ripple %.4f dB to %.0f Hz, worst residual %.1f dB\n",
+               (unsigned long)rates[r], hi - lo, edge, worst_residual);
+        CHECK(hi - lo < 0.01);
+        CHECK(fabs(lo) < 0.01 && fabs(hi) < 0.01);
+        CHECK(worst_residual < -75.0);
+        CHECK(stereo);
+    }
+}
+
+// 96 kHz input: content between 24 and 48 kHz must not fold into the output
+static void test_alias_rejection(void) {
+    static const double freqs[] = {28100.0, 31000.0, 37000.0, 45000.0};
+    double worst = -1e9;
+    for (size_t k = 0; k < sizeof(freqs) / sizeof(freqs[0]); k++) {
+        size_t n;
+        bool ok;
+        run_tone(96000, freqs[k], out_buf, &n, &ok);
+        double e = 0.0;
+        for (size_t i = 0; i < n; i++) e += out_buf[i] * out_buf[i];
+        double db = 10.0 * log10(e / n / (AMPLITUDE * AMPLITUDE / 2.0) + 1e-30);
+        if (db > worst) worst = db;
+    }
+    printf("96 kHz, 28-45 kHz tones: worst alias %.1f dB\n", worst);
+    CHECK(worst < -75.0);
+}
+
+// Pulling resampler_input_needed frames per output frame consumes exactly
+// in_rate frames per second, and anything else is refused
+static void test_input_accounting(void) {
+    static int16_t in[MAX_IN * 2], out[OUT_FRAMES * 2];
+    memset(in, 0, sizeof(in));
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        resampler_t *rs = resampler_create(rates[r], AUDIO_SAMPLE_RATE, 2, OUT_FRAMES);
+        CHECK(rs != NULL);
+        CHECK_EQ(resampler_in_rate(rs), rates[r]);
+        uint64_t total = 0;
+        for (int f = 0; f < AUDIO_SAMPLE_RATE / OUT_FRAMES; f++) {
+            size_t need = resampler_input_needed(rs, OUT_FRAMES);
+            CHECK_EQ(resampler_process(rs, in, need + 1, out, OUT_FRAMES), 0);
+            CHECK_EQ(resampler_process(rs, in, need, out, OUT_FRAMES), OUT_FRAMES);
+            total += need;
+        }
+        CHECK_EQ(total, rates[r]);
+        resampler_destroy(rs);
+    }
+    CHECK(resampler_create(44100, 48001, 2, OUT_FRAMES) == NULL);   // 48001 phases
+}
+
+static void test_passthrough(void) {
+    static int16_t in[OUT_FRAMES * 2], out[OUT_FRAMES * 2];
+    for (size_t i = 0; i < OUT_FRAMES * 2; i++) in[i] = (int16_t)test_rand();
+    resampler_t *rs = resampler_create(AUDIO_SAMPLE_RATE, AUDIO_SAMPLE_RATE, 2, OUT_FRAMES);
+    CHECK_EQ(resampler_taps(rs), 0);
+    CHECK_EQ(resampler_input_needed(rs, OUT_FRAMES), OUT_FRAMES);
+    CHECK_EQ(resampler_process(rs, in, OUT_FRAMES, out, OUT_FRAMES), OUT_FRAMES);
+    CHECK(memcmp(in, out, sizeof(in)) == 0);
+    resampler_destroy(rs);
+}
+
+static void test_speed(void) {
+    static int16_t in[MAX_IN * 2], out[OUT_FRAMES * 2];
+    for (size_t i = 0; i < MAX_IN * 2; i++) in[i] = (int16_t)(test_rand() >> 1);
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        resampler_t *rs = resampler_create(rates[r], AUDIO_SAMPLE_RATE, 2, OUT_FRAMES);
+        const int frames = 4000;
+        double t0 = test_now_s();
+        for (int f = 0; f < frames; f++) {
+            resampler_process(rs, in, resampler_input_needed(rs, OUT_FRAMES), out, OUT_FRAMES);
+        }
+        double us = (test_now_s() - t0) * 1e6 / frames;
+        printf("%5lu Hz: %zu taps, %.1f us per stereo 240-frame output on the host\n",
+               (unsigned long)rates[r], resampler_taps(rs), us);
+        resampler_destroy(rs);
+    }
+}
+
+int main(void) {
+    RUN(test_passband);
+    RUN(test_alias_rejection);
+    RUN(test_input_accounting);
+    RUN(test_passthrough);
+    RUN(test_speed);
+    return TEST_RESULT();
+}
@@ -0,0 +1,173 @@
+// SPSC ring buffer: full/empty and return codes, wrap-point splits of
+// reserve/peek, and a two-thread stream mixing the copying and zero-copy APIs
+// on both sides, verified byte for byte, with its throughput
+#include "audio/ring_buffer.h"
+#include "test_util.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#define CAPACITY      (720 * 10)     // RING_BUFFER_SIZE: not a power of two
+#define STREAM_BYTES  (64u * 1024 * 1024)
+
+static ring_buffer_t *rb;
+
+static void test_full_empty(void) {
+    uint8_t buf[CAPACITY + 1];
+    size_t len = 0;
+    rb = ring_buffer_create(CAPACITY);
+    CHECK_EQ(ring_buffer_available(rb), 0);
+    CHECK_EQ(ring_buffer_free(rb), CAPACITY);
+    CHECK(ring_buffer_peek(rb, &len) == NULL);
+    CHECK_EQ(ring_buffer_read(rb, buf, 1), ESP_ERR_NOT_FOUND);
+
+    memset(buf, 0x5A, sizeof(buf));
+    CHECK_EQ(ring_buffer_write(rb, buf, CAPACITY + 1), ESP_ERR_NO_MEM);   // All or nothing
+    CHECK_EQ(ring_buffer_available(rb), 0);
+    CHECK_EQ(ring_buffer_write(rb, buf, CAPACITY), ESP_OK);              // Full without a spare byte
+    CHECK_EQ(ring_buffer_free(rb), 0);
+    CHECK(ring_buffer_reserve(rb, 1, &len) == NULL);
+    CHECK_EQ(len, 0);
+    CHECK_EQ(ring_buffer_write(rb, buf, 1), ESP_ERR_NO_MEM);
+    CHECK_EQ(ring_buffer_read(rb, buf, CAPACITY), ESP_OK);
+    CHECK_EQ(ring_buffer_available(rb), 0);
+    ring_buffer_destroy(rb);
+}
+
+static void test_wrap_split(void) {
+    uint8_t frame[720], out[720];
+    size_t granted = 0, len = 0;
+    rb = ring_buffer_create(CAPACITY);
+
+    // Offset the indices so a 720-byte write straddles the end
+    for (int i = 0; i < 9; i++) ring_buffer_write(rb, frame, 720);
+    ring_buffer_read(rb, out, 720);
+    ring_buffer_write(rb, frame, 360);
+    ring_buffer_read(rb, out, 720);
+
+    // Reserve grants only up to the wrap point; the rest comes from the start
+    uint8_t *p = ring_buffer_reserve(rb, 720, &granted);
+    CHECK(p != NULL);
+    CHECK_EQ(granted, 360);
+    memset(p, 1, granted);
+    ring_buffer_commit(rb, granted);
+    p = ring_buffer_reserve(rb, 360, &granted);
+    CHECK_EQ(granted, 360);
+    memset(p, 2, granted);
+    ring_buffer_commit(rb, granted);
+
+    // Peek likewise stops at the wrap point
+    for (int i = 0; i < 7; i++) ring_buffer_read(rb, out, 720);
+    ring_buffer_read(rb, out, 360);
+    const uint8_t *q = ring_buffer_peek(rb, &len);
+    CHECK_EQ(len, 360);
+    CHECK(q[0] == 1 && q[359] == 1);
+    ring_buffer_release(rb, len);
+    q = ring_buffer_peek(rb, &len);
+    CHECK_EQ(len, 360);
+    CHECK(q[0] == 2 && q[359] == 2);
+    ring_buffer_release(rb, len);
+    CHECK_EQ(ring_buffer_available(rb), 0);
+
+    // Copying read across the wrap reassembles the pieces
+    memset(frame, 3, 360);
+    memset(frame + 360, 4, 360);
+    for (int i = 0; i < 9; i++) ring_buffer_write(rb, out, 720);
+    for (int i = 0; i < 9; i++) ring_buffer_read(rb, out, 720);
+    CHECK_EQ(ring_buffer_write(rb, frame, 720), ESP_OK);
+    CHECK_EQ(ring_buffer_read(rb, out, 720), ESP_OK);
+    CHECK(memcmp(frame, out, 720) == 0);
+    ring_buffer_destroy(rb);
+}
+
+// Byte n of the stream is a hash of n, so a lost, repeated or torn chunk shows
+static inline uint8_t stream_byte(uint32_t n) {
+    return (uint8_t)((n * 2654435761u) >> 24);
+}
+
+static void *producer(void *arg) {
+    uint8_t chunk[1024];
+    uint32_t n = 0, rnd = 12345;
+    while (n < STREAM_BYTES) {
+        rnd = rnd * 1103515245u + 12345u;
+        size_t want = 1 + (rnd >> 16) % sizeof(chunk);
+        if (want > STREAM_BYTES - n) want = STREAM_BYTES - n;
+        if (rnd & 0x80000000u) {
+            size_t granted = 0;
+            uint8_t *dst = ring_buffer_reserve(rb, want, &granted);
+            if (!dst) {
+                sched_yield();
+                continue;
+            }
+            for (size_t i = 0; i < granted; i++) dst[i] = stream_byte(n + i);
+            ring_buffer_commit(rb, granted);
+            n += granted;
+        } else {
+            for (size_t i = 0; i < want; i++) chunk[i] = stream_byte(n + i);
+            if (ring_buffer_write(rb, chunk, want) != ESP_OK) {
+                sched_yield();
+                continue;
+            }
+            n += want;
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    uint8_t chunk[1024];
+    uint32_t n = 0, rnd = 67890, errors = 0;
+    while (n < STREAM_BYTES) {
+        rnd = rnd * 1103515245u + 12345u;
+        size_t got = 0;
+        if (rnd & 0x80000000u) {
+            const uint8_t *src = ring_buffer_peek(rb, &got);
+            if (!src) {
+                sched_yield();
+                continue;
+            }
+            size_t take = 1 + (rnd >> 16) % got;
+            for (size_t i = 0; i < take; i++) errors += src[i] != stream_byte(n + i);
+            ring_buffer_release(rb, take);
+            n += take;
+        } else {
+            size_t want = 1 + (rnd >> 16) % sizeof(chunk);
+            if (want > STREAM_BYTES - n) want = STREAM_BYTES - n;
+            if (ring_buffer_read(rb, chunk, want) != ESP_OK) {
+                sched_yield();
+                continue;
+            }
+            for (size_t i = 0; i < want; i++) errors += chunk[i] != stream_byte(n + i);
+            n += want;
+        }
+    }
+    *(uint32_t *)arg = errors;
+    return NULL;
+}
+
+static void test_two_threads(void) {
+    pthread_t prod, cons;
+    uint32_t errors = 1;
+    rb = ring_buffer_create(CAPACITY);
+
+    double t0 = test_now_s();
+    pthread_create(&cons, NULL, consumer, &errors);
+    pthread_create(&prod, NULL, producer, NULL);
+    pthread_join(prod, NULL);
+    pthread_join(cons, NULL);
+    double dt = test_now_s() - t0;
+
+    CHECK_EQ(errors, 0);
+    CHECK_EQ(ring_buffer_available(rb), 0);
+    printf("spsc: %u MiB through a %u-byte ring in %.2f s (%.0f MiB/s, producer and consumer verifying)\n",
+           STREAM_BYTES >> 20, CAPACITY, dt, (STREAM_BYTES >> 20) / dt);
+    ring_buffer_destroy(rb);
+}
+
+int main(void) {
+    RUN(test_full_empty);
+    RUN(test_wrap_split);
+    RUN(test_two_threads);
+    return TEST_RESULT();
+}
@@ -0,0 +1,215 @@
+// Tone generator: NCO sine accuracy against an exact reference, phase
+// continuity across buffers and retunes, the measurement modes, and cost per
+// frame against the double sin() it replaced. The generator is a singleton,
+// so the sine checks run first while the test can mirror its phase exactly.
+#include "audio/tone_gen.h"
+#include "config/build.h"
+#include "test_util.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define N          AUDIO_FRAME_SAMPLES
+#define AMPLITUDE  16000.0   // TONE_AMPLITUDE in tone_gen.c
+
+static uint32_t model_phase;   // Mirrors tone_gen's sine phase
+
+static uint32_t inc_for(uint32_t freq_hz) {
+    return (uint32_t)(((uint64_t)freq_hz << 32) / AUDIO_SAMPLE_RATE);
+}
+
+// One second of sine at freq_hz against the exact sine at the same phases
+static void test_sine_accuracy(void) {
+    static const uint32_t freqs[] = {1000, 997, 20, 10007, 19999};
+    tone_gen_init(freqs[0]);
+    for (size_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); f++) {
+        tone_gen_set_frequency(freqs[f]);
+        uint32_t inc = inc_for(freqs[f]);
+        int16_t buf[N];
+        double sig = 0.0, err = 0.0, max_err = 0.0;
+        for (int frame = 0; frame < AUDIO_SAMPLE_RATE / N; frame++) {
+            tone_gen_fill_buffer(buf, N);
+            for (size_t i = 0; i < N; i++) {
+                double ideal = AMPLITUDE * sin(2.0 * M_PI * model_phase / 4294967296.0);
+                double e = buf[i] - ideal;
+                sig += ideal * ideal;
+                err += e * e;
+                if (fabs(e) > max_err) max_err = fabs(e);
+                model_phase += inc;
+            }
+        }
+        double snr = 10.0 * log10(sig / err);
+        printf("%5lu Hz: SNR %.1f dB, max error %.2f LSB\n", (unsigned long)freqs[f], snr, max_err);
+        CHECK(snr > 80.0);
+        CHECK(max_err < 1.5);
+    }
+}
+
+// Retunes at random points (mid-buffer sizes vary) never step the waveform
+// more than the fastest of the two tones' slope allows
+static void test_phase_continuity(void) {
+    int16_t buf[N];
+    int16_t prev = 0;
+    bool have_prev = false;
+    uint32_t freq = 1000;
+    double worst = 0.0;
+    for (int retune = 0; retune < 200; retune++) {
+        uint32_t next = 20 + test_rand() % 15000;
+        double max_step = 2.0 * M_PI * (freq > next ? freq : next) / AUDIO_SAMPLE_RATE * AMPLITUDE + 2.0;
+        tone_gen_set_frequency(next);
+        size_t len = 1 + test_rand() % N;
+        tone_gen_fill_buffer(buf, len);
+        for (size_t i = 0; i < len; i++) {
+            if (have_prev) {
+                double step = fabs((double)buf[i] - prev);
+                if (step / max_step > worst) worst = step / max_step;
+            }
+            prev = buf[i];
+            have_prev = true;
+        }
+        freq = next;
+    }
+    printf("largest step over the allowed slope: %.2f\n", worst);
+    CHECK(worst <= 1.0);
+}
+
+// Goertzel power at freq_hz
+static double tone_power(const int16_t *x, size_t n, double freq_hz) {
+    double w = 2.0 * M_PI * freq_hz / AUDIO_SAMPLE_RATE, c = 2.0 * cos(w);
+    double s1 = 0.0, s2 = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double s0 = x[i] + c * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    return s1 * s1 + s2 * s2 - c * s1 * s2;
+}
+
+static void test_multitone(void) {
+    static const uint32_t freqs[6] = {1000, 2000, 3000, 4000, 5000, 6000};   // Harmonic, as Schroeder assumes
+    static int16_t buf[AUDIO_SAMPLE_RATE];
+    CHECK_EQ(tone_gen_set_multitone(freqs, 6), ESP_OK);
+    CHECK_EQ(tone_gen_get_mode(), TONE_GEN_MULTITONE);
+    for (size_t off = 0; off < AUDIO_SAMPLE_RATE; off += N) tone_gen_fill_buffer(buf + off, N);
+
+    int32_t peak = 0;
+    double rms = 0.0;
+    for (size_t i = 0; i < AUDIO_SAMPLE_RATE; i++) {
+        if (abs(buf[i]) > peak) peak = abs(buf[i]);
+        rms += (double)buf[i] * buf[i];
+    }
+    rms = sqrt(rms / AUDIO_SAMPLE_RATE);
+    double p0 = tone_power(buf, AUDIO_SAMPLE_RATE, freqs[0]);
+    double spread = 0.0;
+    for (int k = 1; k < 6; k++) {
+        double d = fabs(10.0 * log10(tone_power(buf, AUDIO_SAMPLE_RATE, freqs[k]) / p0));
+        if (d > spread) spread = d;
+    }
+    printf("multitone: peak %ld, crest factor %.2f, tone level spread %.3f dB\n",
+           (long)peak, peak / rms, spread);
+    CHECK(peak <= (int32_t)AMPLITUDE);
+    CHECK(peak / rms < 2.0);          // Schroeder phases; 6 aligned tones would reach 3.46
+    CHECK(spread < 0.05);
+
+    const uint32_t bad[2] = {1000, AUDIO_SAMPLE_RATE / 2};
+    CHECK_EQ(tone_gen_set_multitone(bad, 2), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(tone_gen_set_multitone(freqs, TONE_GEN_MAX_TONES + 1), ESP_ERR_INVALID_ARG);
+}
+
+// Instantaneous frequency from the zero-crossing spacing near a given sample
+static double freq_near(const int16_t *x, size_t n, size_t at, size_t window) {
+    size_t first = 0, last = 0, crossings = 0;
+    for (size_t i = at + 1; i < at + window && i < n; i++) {
+        if (x[i - 1] < 0 && x[i] >= 0) {
+            if (crossings == 0) first = i;
+            last = i;
+            crossings++;
+        }
+    }
+    return crossings > 1 ? (crossings - 1) * (double)AUDIO_SAMPLE_RATE / (last - first) : 0.0;
+}
+
+static void test_sweep(void) {
+    static int16_t buf[2 * AUDIO_SAMPLE_RATE];
+    CHECK_EQ(tone_gen_set_sweep(100, 10000, 1000), ESP_OK);
+    for (size_t off = 0; off < 2 * AUDIO_SAMPLE_RATE; off += N) tone_gen_fill_buffer(buf + off, N);
+
+    double start = freq_near(buf, AUDIO_SAMPLE_RATE, 0, 2400);
+    double mid = freq_near(buf, AUDIO_SAMPLE_RATE, AUDIO_SAMPLE_RATE / 2 - 48, 96);
+    double end = freq_near(buf, AUDIO_SAMPLE_RATE, AUDIO_SAMPLE_RATE - 48, 48);
+    printf("sweep 100 -> 10000 Hz: %.0f / %.0f / %.0f Hz at start / middle / end\n", start, mid, end);
+    CHECK(fabs(start - 112) < 5);                  // Mean over the first 50 ms
+    CHECK(fabs(mid / 1000.0 - 1.0) < 0.05);        // Geometric midpoint
+    CHECK(fabs(end / 10000.0 - 1.0) < 0.1);
+    // The second period repeats the first
+    CHECK(memcmp(buf, buf + AUDIO_SAMPLE_RATE, AUDIO_SAMPLE_RATE * sizeof(int16_t)) == 0);
+}
+
+static void test_impulse(void) {
+    static int16_t buf[AUDIO_SAMPLE_RATE / 10];
+    CHECK_EQ(tone_gen_set_impulse(20), ESP_OK);
+    for (size_t off = 0; off < sizeof(buf) / sizeof(buf[0]); off += N) tone_gen_fill_buffer(buf + off, N);
+    size_t count = 0;
+    for (size_t i = 0; i < sizeof(buf) / sizeof(buf[0]); i++) {
+        if (buf[i] != 0) {
+            CHECK_EQ(buf[i], INT16_MAX);
+            CHECK_EQ(i % 960, 0);
+            count++;
+        }
+    }
+    CHECK_EQ(count, 5);
+
+    // Modes switch back without being reconfigured
+    CHECK_EQ(tone_gen_set_mode(TONE_GEN_SINE), ESP_OK);
+    CHECK_EQ(tone_gen_set_mode(TONE_GEN_MULTITONE), ESP_OK);
+    CHECK_EQ(tone_gen_get_mode(), TONE_GEN_MULTITONE);
+}
+
+// What tone_gen did before the NCO
+static void old_fill(int16_t *buffer, size_t n, double freq) {
+    static double ph;
+    for (size_t i = 0; i < n; i++) {
+        buffer[i] = (int16_t)(sin(ph) * AMPLITUDE);
+        ph += 2.0 * M_PI * freq / AUDIO_SAMPLE_RATE;
+        if (ph >= 2.0 * M_PI) ph -= 2.0 * M_PI;
+    }
+}
+
+static volatile int16_t sink;
+
+static double ns_per_frame(void (*fill)(int16_t *, size_t)) {
+    int16_t buf[N];
+    const int frames = 20000;
+    double t0 = test_now_s();
+    for (int f = 0; f < frames; f++) {
+        fill(buf, N);
+        sink = buf[f % N];
+    }
+    return (test_now_s() - t0) * 1e9 / frames;
+}
+
+static void old_fill_1k(int16_t *buffer, size_t n) { old_fill(buffer, n, 1000.0); }
+
+static void test_speed(void) {
+    const uint32_t six[6] = {100, 300, 1000, 3000, 6000, 12000};
+    double old_ns = ns_per_frame(old_fill_1k);
+    tone_gen_set_mode(TONE_GEN_SINE);
+    double sine_ns = ns_per_frame(tone_gen_fill_buffer);
+    tone_gen_set_multitone(six, 6);
+    double multi_ns = ns_per_frame(tone_gen_fill_buffer);
+    tone_gen_set_sweep(20, 20000, 1000);
+    double sweep_ns = ns_per_frame(tone_gen_fill_buffer);
+    printf("host ns per 240-sample frame: double sin() %.0f, NCO sine %.0f, 6 tones %.0f, sweep %.0f\n",
+           old_ns, sine_ns, multi_ns, sweep_ns);
+    CHECK(sine_ns < old_ns);
+}
+
+int main(void) {
+    RUN(test_sine_accuracy);
+    RUN(test_phase_continuity);
+    RUN(test_multitone);
+    RUN(test_sweep);
+    RUN(test_impulse);
+    RUN(test_speed);
+    return TEST_RESULT();
+}
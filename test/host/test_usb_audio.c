@@ -0,0 +1,164 @@
+// USB audio sink against a simulated UAC2 host: the host sends one packet per
+// 1 ms USB frame, sized from the last feedback value it polled, while the
+// device reads a 5 ms frame on its own clock, which runs skew_ppm off the
+// host's. Packets reach the output callback up to jitter_ms late (USB task
+// scheduling). The stream must never overrun or underrun once primed, must
+// arrive gap-free (48 kHz build), and the rate estimate must find the skew.
+//   test_usb_audio [skew_ppm (200)] [seconds (300)] [jitter_ms (2)]
+#include "audio/usb_audio.h"
+#include "audio/usb_device_uac.h"
+#include "config/build.h"
+#include "test_util.h"
+
+#include <esp_timer.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef CONFIG_UAC_SAMPLE_RATE
+#define HOST_RATE       CONFIG_UAC_SAMPLE_RATE
+#else
+#define HOST_RATE       AUDIO_SAMPLE_RATE
+#endif
+#define FB_NOMINAL      ((uint32_t)(((uint64_t)HOST_RATE << 16) / 1000))
+#define FB_POLL_MS      8           // Host reads the feedback endpoint every 8 USB frames
+#define MAX_PACKET      (HOST_RATE / 1000 + 2)
+#define MAX_HELD        8           // Packets waiting for the USB task
+#define SETTLE_S        20          // Rate estimate checked after this
+
+// Device side of the stubs: the UAC component and the feedback endpoint
+static uac_output_cb_t output_cb;
+static void *output_ctx;
+static uint32_t fb_latest = FB_NOMINAL;
+static uint32_t fb_updates;
+
+esp_err_t uac_device_init(uac_device_config_t *config) {
+    output_cb = config->output_cb;
+    output_ctx = config->cb_ctx;
+    return ESP_OK;
+}
+
+bool tud_audio_fb_set(uint32_t feedback) {
+    fb_latest = feedback;
+    fb_updates++;
+    return true;
+}
+
+typedef struct {
+    int16_t data[MAX_PACKET * 2];
+    size_t frames;
+    int64_t due_us;
+} packet_t;
+
+static packet_t held[MAX_HELD];
+static size_t held_count;
+
+static void deliver_due(int64_t now_us) {
+    size_t n = 0;
+    while (n < held_count && held[n].due_us <= now_us) {
+        output_cb((uint8_t *)held[n].data, held[n].frames * 2 * sizeof(int16_t), output_ctx);
+        n++;
+    }
+    memmove(held, held + n, (held_count - n) * sizeof(packet_t));
+    held_count -= n;
+}
+
+int main(int argc, char **argv) {
+    double skew_ppm = argc > 1 ? atof(argv[1]) : 200.0;
+    double seconds = argc > 2 ? atof(argv[2]) : 300.0;
+    int jitter_ms = argc > 3 ? atoi(argv[3]) : 2;
+
+    CHECK_EQ(usb_audio_init(), ESP_OK);
+    CHECK(output_cb != NULL);
+
+    const double read_period_us = AUDIO_FRAME_MS * 1000.0 / (1.0 + skew_ppm * 1e-6);
+    const int64_t end_us = (int64_t)(seconds * 1e6);
+    int64_t sof_us = 0;
+    double read_us = read_period_us;
+    uint32_t host_fb = FB_NOMINAL;
+    uint32_t fb_accum = 0;
+    uint16_t next_sent = 0;           // Sample counter the host puts in the left channel
+#if HOST_RATE == AUDIO_SAMPLE_RATE
+    uint16_t next_expected = 0;
+    bool streaming = false;
+#endif
+    uint32_t reads = 0, silent_reads = 0, gaps = 0;
+    uint32_t fill_min = UINT32_MAX, fill_max = 0;
+    double ppm_sum = 0.0;
+    uint32_t ppm_samples = 0;
+    static int16_t frame[AUDIO_FRAME_SAMPLES * 2];
+
+    while (sof_us < end_us) {
+        if (sof_us <= (int64_t)read_us) {
+            // USB frame: poll feedback, then queue this frame's packet
+            host_time_set_us(sof_us);
+            if ((sof_us / 1000) % FB_POLL_MS == 0) host_fb = fb_latest;
+            fb_accum += host_fb;
+            packet_t *p = &held[held_count < MAX_HELD ? held_count++ : MAX_HELD - 1];
+            p->frames = fb_accum >> 16;
+            fb_accum &= 0xFFFF;
+            for (size_t i = 0; i < p->frames; i++) {
+                p->data[2 * i] = (int16_t)next_sent;
+                p->data[2 * i + 1] = (int16_t)~next_sent;
+                next_sent++;
+            }
+            int64_t delay = jitter_ms > 0 ? (int64_t)(test_rand() % (jitter_ms * 1000 + 1)) : 0;
+            p->due_us = sof_us + delay;
+            if (held_count > 1 && p->due_us < held[held_count - 2].due_us) {
+                p->due_us = held[held_count - 2].due_us;   // USB delivers in order
+            }
+            deliver_due(sof_us);
+            sof_us += 1000;
+            continue;
+        }
+
+        // Device frame: the audio task reads 5 ms on the device clock
+        host_time_set_us((int64_t)read_us);
+        deliver_due((int64_t)read_us);
+        size_t got = 0;
+        CHECK_EQ(usb_audio_read_frames(frame, AUDIO_FRAME_SAMPLES, &got), ESP_OK);
+        reads++;
+        if (got == AUDIO_FRAME_SAMPLES) {
+#if HOST_RATE == AUDIO_SAMPLE_RATE
+            for (size_t i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
+                uint16_t v = (uint16_t)frame[2 * i];
+                if (streaming && v != next_expected) gaps++;
+                if (frame[2 * i + 1] != (int16_t)~frame[2 * i]) gaps++;
+                next_expected = v + 1;
+                streaming = true;
+            }
+#endif
+            usb_audio_stats_t st;
+            usb_audio_get_stats(&st);
+            if (st.fill_frames < fill_min) fill_min = st.fill_frames;
+            if (st.fill_frames > fill_max) fill_max = st.fill_frames;
+            if (read_us > SETTLE_S * 1e6) {
+                ppm_sum += st.rate_ppm;
+                ppm_samples++;
+            }
+        } else {
+            silent_reads++;
+        }
+        read_us += read_period_us;
+    }
+
+    usb_audio_stats_t st;
+    usb_audio_get_stats(&st);
+    double mean_ppm = ppm_samples ? ppm_sum / ppm_samples : 0.0;
+    printf("%d Hz host, skew %+.0f ppm, jitter %d ms, %.0f s: %lu packets, %lu overruns, "
+           "%lu underruns, %lu priming reads, %lu gaps, fill %lu..%lu frames, rate estimate %+.1f ppm "
+           "(last %+ld), feedback 0x%08lx\n",
+           HOST_RATE, skew_ppm, jitter_ms, seconds, (unsigned long)st.packets, (unsigned long)st.overruns,
+           (unsigned long)st.underruns, (unsigned long)silent_reads, (unsigned long)gaps,
+           (unsigned long)fill_min, (unsigned long)fill_max, mean_ppm, (long)st.rate_ppm,
+           (unsigned long)st.feedback);
+
+    CHECK(usb_audio_is_active());
+    CHECK(fb_updates > 0);
+    CHECK_EQ(st.fb_errors, 0);
+    CHECK_EQ(st.overruns, 0);
+    CHECK_EQ(st.underruns, 0);
+    CHECK_EQ(gaps, 0);
+    CHECK(silent_reads < 10);                              // Priming only
+    CHECK(fabs(mean_ppm - skew_ppm) < 5.0 + fabs(skew_ppm) * 0.02);
+    return TEST_RESULT();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Minimal host test harness: CHECK records a failure and carries on, and
+// TEST_RESULT() is main's return value (ctest fails on non-zero)
+static int test_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) do { \
+        long long va_ = (long long)(a), vb_ = (long long)(b); \
+        if (va_ != vb_) { \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s = %lld, %s = %lld\n", \
+                    __FILE__, __LINE__, #a, va_, #b, vb_); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define RUN(test) do { \
+        int before_ = test_failures; \
+        test(); \
+        printf("%s %s\n", test_failures == before_ ? "PASS" : "FAIL", #test); \
+    } while (0)
+
+#define TEST_RESULT() (test_failures ? 1 : 0)
+
+// Deterministic PRNG so failures reproduce
+static inline uint32_t test_rand(void) {
+    static uint32_t x = 2463534242u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static inline double test_now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}